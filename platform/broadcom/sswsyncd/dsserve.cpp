@@ -5,6 +5,10 @@
  *
  *   dsclient <domain_socket_filename> <cmd>
  *
+ * Several clients may be connected at once. Each line a client sends is
+ * queued as a command, commands are sent to the program one at a time and
+ * the output up to the next prompt is returned to the client that sent it.
+ *
  */
 
  #include <stdlib.h>
@@ -21,11 +25,20 @@
  #include <sys/wait.h>
 
  #include <errno.h>
+ #include <ctype.h>
  #include <unistd.h>
  #include <signal.h>
  #include <pthread.h>
  #include <pty.h>
+ #include <poll.h>
+ #include <time.h>
  #include <arpa/inet.h>
+
+ #include <algorithm>
+ #include <deque>
+ #include <map>
+ #include <string>
+ #include <vector>
  #include "dsserve.h"
 
  static inline void syslog_printf(int priority, const char *format, ...)
@@ -44,9 +57,68 @@
  // Quickly replace all syslog() with syslog_printf()
  #define syslog syslog_printf
 
+ /* Prompts of the Broadcom diag shell, same as bcmcmd waits for */
+ static const char *const DEFAULT_PROMPT = "drivshell>";
+ static const char *const DEFAULT_ENTER_PROMPT = "Hit enter to get drivshell prompt..\r\n";
+ /* Default number of commands queued from all clients */
+ static const size_t DEFAULT_QUEUE_DEPTH = 64;
+ /* Default time a command may run before the next one is sent */
+ static const int DEFAULT_CMD_TIMEOUT_SEC = 30;
+ /* Until a prompt is seen, a command is done after this long without output */
+ static const int64_t PROMPT_PROBE_IDLE_MS = 2000;
+ /* Client input without a line end is sent as a command at this size */
+ static const size_t MAX_LINE_LEN = 4096;
+ /* Clients not reading their output are dropped beyond this */
+ static const size_t MAX_CLIENT_PENDING_OUTPUT = 4 * 1024 * 1024;
+ static const size_t MAX_CLIENTS = 64;
+
+ struct ds_client
+ {
+     int fd;
+     bool eof;               /* client closed its write side */
+     std::string inbuf;      /* partial line */
+     std::string outbuf;     /* output not written yet */
+ };
+
+ struct ds_request
+ {
+     uint64_t id;
+     uint64_t client_id;
+     std::string line;
+     int64_t queued_ms;
+ };
+
  /* Network server */
- static volatile int _dsfd = -1;
  static int _server_socket;
+ static std::map<uint64_t, ds_client> _clients;
+ static uint64_t _next_client_id = 1;
+
+ /* Commands are sent to the program one at a time, the output up to the
+  * next prompt goes to the client of the command */
+ static std::vector<std::string> _prompts;
+ static size_t _queue_depth = DEFAULT_QUEUE_DEPTH;
+ static int64_t _cmd_timeout_ms = DEFAULT_CMD_TIMEOUT_SEC * 1000;
+ static bool _verbose = false;
+ static std::deque<ds_request> _queue;
+ static uint64_t _next_request_id = 1;
+ static bool _busy = false;
+ static ds_request _current;
+ static int64_t _current_start_ms;
+ static int64_t _current_output_ms;
+ static size_t _current_bytes;
+ static bool _prompt_seen = false;
+ /* The running command timed out, the program is still busy with it */
+ static bool _timed_out = false;
+ static std::string _tty_tail;
+ static size_t _tty_tail_max;
+
+ static int64_t
+ _now_ms()
+ {
+     struct timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+ }
 
  static int
  _setup_domain_socket(const char *sun_path)
@@ -73,84 +145,363 @@
          exit(EXIT_FAILURE);
      }
 
-     /* Only process one connection at a time */
-     listen(sockfd, 1);
+     /* Clients beyond MAX_CLIENTS wait in the backlog */
+     listen(sockfd, SOMAXCONN);
 
      return sockfd;
  }
 
- static void *
- _ds2tty(void *arg)
+ static bool
+ _client_idle(uint64_t client_id)
+ {
+     if (_busy && _current.client_id == client_id) {
+         return false;
+     }
+     for (auto &req : _queue) {
+         if (req.client_id == client_id) {
+             return false;
+         }
+     }
+     return true;
+ }
+
+ static void
+ _close_client(uint64_t client_id)
+ {
+     auto it = _clients.find(client_id);
+     if (it == _clients.end()) {
+         return;
+     }
+     close(it->second.fd);
+     _clients.erase(it);
+
+     /* Drop its queued commands, output of a running one becomes orphaned */
+     _queue.erase(std::remove_if(_queue.begin(), _queue.end(),
+                                 [=](const ds_request &req) { return req.client_id == client_id; }),
+                  _queue.end());
+ }
+
+ /* Close a client that closed its side once all its output is written */
+ static void
+ _close_client_if_done(uint64_t client_id)
+ {
+     auto it = _clients.find(client_id);
+     if (it != _clients.end() && it->second.eof && it->second.outbuf.empty() && _client_idle(client_id)) {
+         _close_client(client_id);
+     }
+ }
+
+ static void
+ _accept_client()
+ {
+     int fd = accept(_server_socket, NULL, NULL);
+     if (fd < 0) {
+         if (errno == EINTR || errno == EAGAIN || errno == ECONNABORTED) {
+             return;
+         }
+         syslog(LOG_ERR, "server: can't accept socket: %s", strerror(errno));
+         exit(EXIT_FAILURE);
+     }
+
+     ds_client client;
+     client.fd = fd;
+     client.eof = false;
+     _clients[_next_client_id++] = client;
+ }
+
+ static void
+ _queue_line(uint64_t client_id, const std::string &line)
+ {
+     ds_request req;
+     req.id = _next_request_id++;
+     req.client_id = client_id;
+     req.line = line;
+     req.queued_ms = _now_ms();
+     _queue.push_back(req);
+ }
+
+ static void
+ _read_client(uint64_t client_id)
  {
-     int fd = *((int *)arg);
      const size_t DATA_SIZE = 1024;
-     unsigned char data[DATA_SIZE];
-     ssize_t rc;
-     struct sockaddr_in addr;
-     socklen_t len;
+     char data[DATA_SIZE];
+     ds_client &client = _clients[client_id];
 
-     while (1) {
-         if (_dsfd < 0)
-         {
-             len = sizeof(addr);
-             if ((_dsfd = accept(_server_socket, (struct sockaddr *) &addr, &len)) < 0) {
-                 syslog(LOG_ERR, "server: can't accept socket: %s", strerror(errno));
-                 exit(EXIT_FAILURE);
+     ssize_t rc = read(client.fd, data, DATA_SIZE);
+     if (rc < 0 && (errno == EINTR || errno == EAGAIN)) {
+         return;
+     }
+     if (rc < 0) {
+         /* Broken pipe -- client quit */
+         syslog(LOG_ERR, "client %lu broken pipe\n", (unsigned long)client_id);
+         _close_client(client_id);
+         return;
+     }
+     if (rc == 0) {
+         /* Ending connection, still answer what it sent */
+         client.eof = true;
+         if (!client.inbuf.empty()) {
+             _queue_line(client_id, client.inbuf);
+             client.inbuf.clear();
+         }
+         _close_client_if_done(client_id);
+         return;
+     }
+
+     /* Queue each complete line, a line ends with \n, \r or \r\n */
+     client.inbuf.append(data, (size_t)rc);
+     size_t begin = 0;
+     for (size_t i = 0; i < client.inbuf.size(); i++) {
+         char c = client.inbuf[i];
+         if (c != '\n' && c != '\r') {
+             continue;
+         }
+         if (c == '\r' && i + 1 < client.inbuf.size() && client.inbuf[i + 1] == '\n') {
+             i++;
+         }
+         _queue_line(client_id, client.inbuf.substr(begin, i + 1 - begin));
+         begin = i + 1;
+     }
+     client.inbuf.erase(0, begin);
+     if (client.inbuf.size() >= MAX_LINE_LEN) {
+         _queue_line(client_id, client.inbuf);
+         client.inbuf.clear();
+     }
+ }
+
+ static void
+ _flush_client(uint64_t client_id)
+ {
+     ds_client &client = _clients[client_id];
+
+     while (!client.outbuf.empty()) {
+         ssize_t written = send(client.fd, client.outbuf.data(), client.outbuf.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+         if (written < 0) {
+             if (errno == EINTR) {
+                 continue;
+             }
+             if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                 // Handle the client exit problem
+                 _close_client(client_id);
+                 return;
              }
+             break;
          }
+         client.outbuf.erase(0, (size_t)written);
+     }
+     _close_client_if_done(client_id);
+ }
 
-         rc = read(_dsfd, data, DATA_SIZE);
-         if (rc <= 0) {
-             if (rc < 0) {
-                 /* Broken pipe -- client quit */
-                 syslog(LOG_ERR, "_ds2tty broken pipe");
+ static void
+ _finish_request(const char *reason)
+ {
+     int64_t now = _now_ms();
+
+     if (_verbose || strcmp(reason, "prompt")) {
+         syslog(strcmp(reason, "prompt") ? LOG_WARNING : LOG_DEBUG,
+                "request %lu client %lu: %s, queued %ld ms, ran %ld ms, %zu bytes\n",
+                (unsigned long)_current.id, (unsigned long)_current.client_id, reason,
+                (long)(_current_start_ms - _current.queued_ms), (long)(now - _current_start_ms),
+                _current_bytes);
+     }
+     _busy = false;
+     _close_client_if_done(_current.client_id);
+ }
+
+ static void
+ _dispatch(int ttyfd)
+ {
+     if (_busy || _queue.empty()) {
+         return;
+     }
+
+     _current = _queue.front();
+     _queue.pop_front();
+     _busy = true;
+     _timed_out = false;
+     _current_start_ms = _current_output_ms = _now_ms();
+     _current_bytes = 0;
+
+     const char *p = _current.line.data();
+     size_t left = _current.line.size();
+     while (left > 0) {
+         ssize_t written = write(ttyfd, p, left);
+         if (written < 0) {
+             if (errno == EINTR) {
+                 continue;
              }
-             else {
-                 /* Ending connection */
+             syslog(LOG_ERR, "write to program: %s", strerror(errno));
+             break;
+         }
+         p += written;
+         left -= (size_t)written;
+     }
+ }
+
+ static void
+ _read_tty(int ttyfd)
+ {
+     const size_t DATA_SIZE = 1024;
+     char data[DATA_SIZE];
+
+     ssize_t rc = read(ttyfd, data, DATA_SIZE);
+     if (rc < 0 && errno == EINTR) {
+         return;
+     }
+     if (rc <= 0) {
+         /* Broken pipe -- app quit */
+         syslog(LOG_ERR, "_read_tty broken pipe");
+         close(ttyfd);
+         exit(0);
+     }
+
+     auto it = _busy ? _clients.find(_current.client_id) : _clients.end();
+     if (it != _clients.end()) {
+         it->second.outbuf.append(data, (size_t)rc);
+         _current_bytes += (size_t)rc;
+         _current_output_ms = _now_ms();
+         if (it->second.outbuf.size() > MAX_CLIENT_PENDING_OUTPUT) {
+             syslog(LOG_WARNING, "client %lu not reading output, dropped\n", (unsigned long)it->first);
+             _close_client(it->first);
+         }
+     }
+     else
+     {
+         /* print orphaned message to the stdout */
+         printf("%.*s", (int)rc, data);
+         fflush(stdout);
+         if (_busy) {
+             _current_bytes += (size_t)rc;
+             _current_output_ms = _now_ms();
+         }
+     }
+
+     /* Keep the tail for a prompt split over reads */
+     _tty_tail.append(data, (size_t)rc);
+     if (_tty_tail.size() > _tty_tail_max) {
+         _tty_tail.erase(0, _tty_tail.size() - _tty_tail_max);
+     }
+     for (auto &prompt : _prompts) {
+         if (_tty_tail.size() >= prompt.size() &&
+             _tty_tail.compare(_tty_tail.size() - prompt.size(), prompt.size(), prompt) == 0) {
+             _prompt_seen = true;
+             if (_busy) {
+                 _finish_request(_timed_out ? "prompt after timeout" : "prompt");
              }
-             close(_dsfd);
-             _dsfd = -1;
-         } else {
-             write(fd, data, rc);
-             fsync(fd);
+             break;
          }
      }
 
-     return NULL;
+ }
+
+ /* Returns the poll timeout for the running command */
+ static int
+ _check_request_timeout()
+ {
+     if (!_busy || _timed_out) {
+         return -1;
+     }
+
+     int64_t now = _now_ms();
+     int64_t left = _current_start_ms + _cmd_timeout_ms - now;
+     if (left <= 0) {
+         if (!_prompt_seen) {
+             _finish_request("timeout");
+             return 0;
+         }
+         /* The program would take the next command as input of this one and
+          * its output would go to the wrong client, so hold the queue until
+          * the prompt. Output meanwhile still goes to this command's client. */
+         syslog(LOG_WARNING, "request %lu client %lu: timeout after %ld ms, waiting for the prompt\n",
+                (unsigned long)_current.id, (unsigned long)_current.client_id, (long)(now - _current_start_ms));
+         _timed_out = true;
+         return -1;
+     }
+
+     /* The program may not print any of the prompts, then a quiet period ends a command */
+     if (!_prompt_seen && _current_bytes > 0) {
+         int64_t idle_left = _current_output_ms + PROMPT_PROBE_IDLE_MS - now;
+         if (idle_left <= 0) {
+             _finish_request("idle");
+             return 0;
+         }
+         left = std::min(left, idle_left);
+     }
+
+     return (int)left;
  }
 
  static void *
- _tty2ds(void *arg)
+ _serve(void *arg)
  {
-     int fd = *((int *)arg);
-     const size_t DATA_SIZE = 1024;
-     unsigned char data[DATA_SIZE];
-     ssize_t rc;
+     int ttyfd = *((int *)arg);
+     std::vector<struct pollfd> fds;
+     std::vector<uint64_t> fd_clients;
+
+     for (auto &prompt : _prompts) {
+         _tty_tail_max = std::max(_tty_tail_max, prompt.size());
+     }
 
      while (1) {
-         rc = read(fd, data, DATA_SIZE);
-         if (rc <= 0) {
-             /* Broken pipe -- app quit */
-             syslog(LOG_ERR, "_tty2ds broken pipe");
-             close(fd);
-             exit(0);
+         _dispatch(ttyfd);
+         int timeout = _check_request_timeout();
+         if (timeout == 0) {
+             continue;
          }
-         if (_dsfd >= 0) {
-             ssize_t written = write(_dsfd, data, rc);
-             // Handle the client exit problem
-             if (written < 0) {
-                 close(_dsfd);
-                 _dsfd = -1;
+
+         fds.clear();
+         fd_clients.clear();
+         struct pollfd pfd;
+         pfd.fd = _server_socket;
+         pfd.events = _clients.size() < MAX_CLIENTS ? POLLIN : 0;
+         pfd.revents = 0;
+         fds.push_back(pfd);
+         pfd.fd = ttyfd;
+         pfd.events = POLLIN;
+         fds.push_back(pfd);
+         for (auto &it : _clients) {
+             pfd.fd = it.second.fd;
+             pfd.events = 0;
+             /* A full queue stops reading from clients until it drains */
+             if (!it.second.eof && _queue.size() < _queue_depth) {
+                 pfd.events |= POLLIN;
              }
-             fsync(_dsfd);
+             if (!it.second.outbuf.empty()) {
+                 pfd.events |= POLLOUT;
+             }
+             fds.push_back(pfd);
+             fd_clients.push_back(it.first);
          }
-         else
-         {
-             /* print orphaned message to the stdout */
-             printf("%.*s", (int)rc, data);
-             fflush(stdout);
+
+         if (poll(fds.data(), fds.size(), timeout) < 0) {
+             if (errno == EINTR) {
+                 continue;
+             }
+             syslog(LOG_ERR, "poll: %s", strerror(errno));
+             exit(EXIT_FAILURE);
+         }
+
+         if (fds[1].revents) {
+             _read_tty(ttyfd);
+         }
+         for (size_t i = 0; i < fd_clients.size(); i++) {
+             short revents = fds[i + 2].revents;
+             if (revents & POLLOUT) {
+                 if (_clients.count(fd_clients[i])) {
+                     _flush_client(fd_clients[i]);
+                 }
+             }
+             if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                 if (_clients.count(fd_clients[i])) {
+                     _read_client(fd_clients[i]);
+                 }
+             }
+         }
+         if (fds[0].revents & POLLIN) {
+             _accept_client();
          }
      }
+
      return NULL;
  }
 
@@ -186,10 +537,15 @@
 
      auto usage = [=]() {
          const char* prog = argv[0];
-         printf("Usage: %s [-d] [-f <sun_path>] <program> [args]\n", prog);
+         printf("Usage: %s [-d] [-v] [-f <sun_path>] [-q <depth>] [-t <seconds>] [-p <prompt>]... <program> [args]\n", prog);
          printf("    -d     Daemon mode\n");
+         printf("    -v     Log every command with its queue and run time\n");
          printf("    -f     Specify the path of unix socket\n");
+         printf("    -q     Commands queued from all clients, default %zu\n", DEFAULT_QUEUE_DEPTH);
+         printf("    -t     Time a command may run before it is reported as stuck, default %d\n", DEFAULT_CMD_TIMEOUT_SEC);
+         printf("    -p     Prompt that ends a command output, may be repeated\n");
          printf("Default sun_path: %s\n", DEFAULT_SUN_PATH);
+         printf("Default prompts: \"%s\", \"Hit enter to get drivshell prompt..\\r\\n\"\n", DEFAULT_PROMPT);
          printf("\n");
          printf("Exit status:\n");
          printf("    0      Both %s and program exit normally in non daemon mode, or %s exits normally in daemon mode\n", prog, prog);
@@ -221,9 +577,47 @@
              }
              syslog(LOG_INFO, "domain socket filename: %s\n", sun_path);
          }
+         else if (!strcmp(*argv, "-v")) {
+             _verbose = true;
+         }
+         else if (!strcmp(*argv, "-q")) {
+             argc--, argv++;
+             if (argc > 1 && *argv && isdigit(argv[0][0]) && atoi(*argv) > 0) {
+                 _queue_depth = (size_t)atoi(*argv);
+             }
+             else {
+                 fprintf(stderr, "[ERROR] bad queue depth\n");
+                 return usage();
+             }
+         }
+         else if (!strcmp(*argv, "-t")) {
+             argc--, argv++;
+             if (argc > 1 && *argv && isdigit(argv[0][0]) && atoi(*argv) > 0) {
+                 _cmd_timeout_ms = (int64_t)atoi(*argv) * 1000;
+             }
+             else {
+                 fprintf(stderr, "[ERROR] bad timeout\n");
+                 return usage();
+             }
+         }
+         else if (!strcmp(*argv, "-p")) {
+             argc--, argv++;
+             if (argc > 1 && *argv && **argv) {
+                 _prompts.push_back(*argv);
+             }
+             else {
+                 fprintf(stderr, "[ERROR] bad prompt\n");
+                 return usage();
+             }
+         }
          else break;
      }
 
+     if (_prompts.empty()) {
+         _prompts.push_back(DEFAULT_PROMPT);
+         _prompts.push_back(DEFAULT_ENTER_PROMPT);
+     }
+
      if (do_fork) {
          /* Daemonize */
          if (daemon(1, 1) < 0) {
@@ -253,14 +647,8 @@
      /* Setup server */
      _server_socket = _setup_domain_socket(sun_path);
 
-     /* Start proxy for input */
-     if ((rc = pthread_create(&id, NULL, _ds2tty, (void *)&ttyfd)) < 0) {
-         syslog(LOG_ERR, "pthread_create: %s", strerror(rc));
-         exit(EXIT_FAILURE);
-     }
-
-     /* Start proxy for output */
-     if ((rc = pthread_create(&id, NULL, _tty2ds, (void *)&ttyfd)) < 0) {
+     /* Start proxy between clients and program */
+     if ((rc = pthread_create(&id, NULL, _serve, (void *)&ttyfd)) != 0) {
          syslog(LOG_ERR, "pthread_create: %s", strerror(rc));
          exit(EXIT_FAILURE);
      }
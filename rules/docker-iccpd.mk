@@ -24,6 +24,7 @@ $(DOCKER_ICCPD)_CONTAINER_NAME = iccpd
 $(DOCKER_ICCPD)_RUN_OPT += -t --cap-add=NET_ADMIN
 $(DOCKER_ICCPD)_RUN_OPT += -v /etc/sonic:/etc/sonic:ro
 $(DOCKER_ICCPD)_RUN_OPT += -v /etc/localtime:/etc/localtime:ro 
+$(DOCKER_ICCPD)_RUN_OPT += -v /host/warmboot:/var/warmboot
 
 $(DOCKER_ICCPD)_BASE_IMAGE_FILES += mclagdctl:/usr/bin/mclagdctl
 
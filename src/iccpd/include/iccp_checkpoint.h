@@ -0,0 +1,95 @@
+/*
+ * iccp_checkpoint.h
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * The full GNU General Public License is included in this distribution in
+ * the file called "COPYING".
+ *
+ */
+
+#ifndef _ICCP_CHECKPOINT_H
+#define _ICCP_CHECKPOINT_H
+
+#include <stdint.h>
+
+#include "../include/port.h"
+
+struct System;
+struct CSM;
+
+/* Warm reboot checkpoint, kept across the reboot by the warmboot mount */
+#define ICCP_CHECKPOINT_DIR     "/var/warmboot/iccpd"
+#define ICCP_CHECKPOINT_FILE    ICCP_CHECKPOINT_DIR "/iccpd_checkpoint.bin"
+
+#define ICCP_CHECKPOINT_MAGIC   0x49434b50  /* "ICKP" */
+#define ICCP_CHECKPOINT_VERSION 1
+/* Time restored MACs have to be reported again before they are aged */
+#define ICCP_CHECKPOINT_AGE_TIMEOUT 90
+
+/* File layout: one header, then per MCLAG domain a domain record followed
+ * by its MAC, ARP and ND records. Fields are stored explicitly so a change
+ * of the in-memory structs does not silently change the file format. */
+struct iccp_ckpt_hdr
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t num_domains;
+    uint32_t len;           /* whole file, header included */
+} __attribute__ ((packed));
+
+struct iccp_ckpt_domain
+{
+    uint16_t mlag_id;
+    uint16_t reserved;
+    uint32_t num_mac;
+    uint32_t num_arp;
+    uint32_t num_ndisc;
+} __attribute__ ((packed));
+
+struct iccp_ckpt_mac
+{
+    uint16_t vid;
+    uint8_t mac_addr[ETHER_ADDR_LEN];
+    uint8_t fdb_type;
+    uint8_t age_flag;
+    uint8_t add_to_syncd;
+    char ifname[MAX_L_PORT_NAME];
+    char origin_ifname[MAX_L_PORT_NAME];
+} __attribute__ ((packed));
+
+struct iccp_ckpt_arp
+{
+    uint8_t flag;
+    uint8_t learn_flag;
+    char ifname[MAX_L_PORT_NAME];
+    uint32_t ipv4_addr;
+    uint8_t mac_addr[ETHER_ADDR_LEN];
+} __attribute__ ((packed));
+
+struct iccp_ckpt_ndisc
+{
+    uint8_t flag;
+    uint8_t learn_flag;
+    char ifname[MAX_L_PORT_NAME];
+    uint32_t ipv6_addr[4];
+    uint8_t mac_addr[ETHER_ADDR_LEN];
+} __attribute__ ((packed));
+
+int iccp_checkpoint_save(struct System* sys);
+int iccp_checkpoint_load(struct System* sys);
+void iccp_checkpoint_restore(struct CSM* csm);
+void iccp_checkpoint_age(struct CSM* csm);
+void iccp_checkpoint_age_timer(struct CSM* csm);
+
+#endif /* _ICCP_CHECKPOINT_H */
@@ -28,10 +28,10 @@
 #define ICCP_MAX_IP_STR_LEN 16
 
 extern int iccp_mclag_config_dump(char * *buf, int *num, int mclag_id);
-extern int iccp_arp_dump(char * *buf, int *num, int mclag_id);
-extern int iccp_ndisc_dump(char * *buf, int *num, int mclag_id);
-extern int iccp_mac_dump(char * *buf, int *num, int mclag_id);
-extern int iccp_local_if_dump(char * *buf, int *num, int mclag_id);
+extern int iccp_arp_dump(char * *buf, int *num, int mclag_id, const char *ifname);
+extern int iccp_ndisc_dump(char * *buf, int *num, int mclag_id, const char *ifname);
+extern int iccp_mac_dump(char * *buf, int *num, int mclag_id, int vid, const char *ifname);
+extern int iccp_local_if_dump(char * *buf, int *num, int mclag_id, const char *ifname);
 extern int iccp_peer_if_dump(char * *buf, int *num, int mclag_id);
 extern int iccp_cmd_dbg_counter_dump(char * *buf, int *data_len, int mclag_id);
 extern int iccp_unique_ip_if_dump(char * *buf, int *num, int mclag_id);
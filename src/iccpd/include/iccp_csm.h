@@ -38,6 +38,8 @@
 #include "../include/port.h"
 
 #define CSM_BUFFER_SIZE 65536
+/* Room for at least one maximum sized ICCP message plus a partial one */
+#define CSM_RX_BUFFER_SIZE (2 * CSM_BUFFER_SIZE)
 
 #ifndef IFNAMSIZ
 #define IFNAMSIZ 16
@@ -77,6 +79,7 @@ struct Msg
     char* buf;
     size_t len;
     TAILQ_ENTRY(Msg) tail;
+    struct Msg* hash_next; /* ARP/ND index chain, see mlacp_arp_find() */
 };
 
 /* Connection state */
@@ -118,6 +121,14 @@ struct CSM
     char sender_ip[INET_ADDRSTRLEN];
     void* sock_read_event_ptr;
 
+    /* Bytes received from the peer but not yet parsed into messages */
+    char rx_buf[CSM_RX_BUFFER_SIZE];
+    size_t rx_len;
+
+    /* Messages queued for the peer, written out once per scheduler pass */
+    char tx_buf[CSM_BUFFER_SIZE];
+    size_t tx_len;
+
     int keepalive_time;
     int session_timeout;
     int peer_link_learning_enable;
@@ -147,7 +158,9 @@ struct CSM
     LIST_HEAD(csm_if_list, If_info) if_bind_list;
 };
 int iccp_csm_send(struct CSM*, char*, int);
+int iccp_csm_tx_flush(struct CSM*);
 int iccp_csm_init_msg(struct Msg**, char*, int);
+void iccp_csm_free_msg(struct Msg*);
 int iccp_csm_prepare_nak_msg(struct CSM*, char*, size_t);
 int iccp_csm_prepare_iccp_msg(struct CSM*, char*, size_t);
 int iccp_csm_prepare_capability_msg(struct CSM*, char*, size_t);
@@ -170,4 +183,7 @@ void iccp_csm_correspond_from_rg_disconnect_msg(struct CSM*, struct Msg*);
 
 int mlacp_bind_port_channel_to_csm(struct CSM* csm, const char *ifname);
 int iccp_csm_init_mac_msg(struct MACMsg **mac_msg, char* data, int len);
+void iccp_csm_free_mac_msg(struct MACMsg* mac_msg);
+struct system_dbg_counter_info;
+void iccp_csm_pool_dbg_counters(struct system_dbg_counter_info* counters);
 #endif /* ICCP_CSM_H_ */
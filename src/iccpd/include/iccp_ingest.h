@@ -0,0 +1,73 @@
+/*
+ * iccp_ingest.h
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * The full GNU General Public License is included in this distribution in
+ * the file called "COPYING".
+ *
+ */
+
+#ifndef _ICCP_INGEST_H
+#define _ICCP_INGEST_H
+
+#include <stdint.h>
+
+#include "../include/port.h"
+
+struct System;
+struct system_dbg_counter_info;
+struct nl_msg;
+
+/* Ring between the ingest thread and the main loop, power of 2 */
+#define ICCP_INGEST_RING_SIZE   4096
+/* Events handled per main loop pass, the rest waits for the next one */
+#define ICCP_INGEST_BUDGET      256
+
+enum ICCP_INGEST_TYPE
+{
+    ICCP_INGEST_NETLINK = 1,    /* route netlink message */
+    ICCP_INGEST_ARP,            /* ARP reply packet */
+    ICCP_INGEST_NDISC,          /* neighbor advertisement packet */
+    ICCP_INGEST_RESYNC,         /* netlink events lost, resync */
+};
+
+/* Identifies the object an event is about, an event supersedes an earlier
+ * one with the same key unless an event it depends on lies between them.
+ * Compared as a whole, keep it zero filled. */
+struct iccp_ingest_key
+{
+    uint8_t type;
+    uint8_t family;
+    uint16_t msg_type;
+    uint32_t ifindex;
+    uint8_t addr[16];
+};
+
+struct iccp_ingest_event
+{
+    struct iccp_ingest_key key;
+    uint8_t coalesce;               /* key is set, a later event may replace this one */
+    uint8_t mac_addr[ETHER_ADDR_LEN];
+    struct nl_msg* msg;             /* ICCP_INGEST_NETLINK, freed by the consumer */
+};
+
+int iccp_ingest_init(struct System* sys);
+void iccp_ingest_finalize();
+int iccp_ingest_running();
+int iccp_ingest_get_fd(struct System* sys);
+int iccp_ingest_event_handler(struct System* sys);
+void iccp_ingest_neigh_dump_request();
+void iccp_ingest_dbg_counters(struct system_dbg_counter_info* counters);
+
+#endif /* _ICCP_INGEST_H */
@@ -60,7 +60,13 @@ int iccp_handle_events(struct System *sys);
 void update_if_ipmac_on_standby(struct LocalInterface *lif_po, int dir);
 int iccp_sys_local_if_list_get_addr();
 int iccp_netlink_neighbor_request(int family, uint8_t *addr, int add, uint8_t *mac, char *portname, int permanent, int dir);
+int iccp_netlink_peer_neighbor_add(int family, uint8_t *addr, uint8_t *mac, char *portname, int permanent, int dir, int peer_ack);
+int iccp_netlink_neighbor_flush();
 int iccp_check_if_addr_from_netlink(int family, uint8_t *addr, struct LocalInterface *lif);
+int iccp_receive_arp_packet(int fd, unsigned int *ifindex, unsigned int *addr, uint8_t *mac_addr);
+int iccp_receive_ndisc_packet(int fd, unsigned int *ifindex, struct in6_addr *target, uint8_t *mac_addr);
+int iccp_netlink_route_msg_handler(struct nl_msg *msg);
+void iccp_netlink_route_sock_error();
 
 void recover_if_ipmac_on_standby(struct LocalInterface* lif_po, int dir);
 void update_vlan_if_mac_on_standby(struct LocalInterface* lif_vlan, int dir);
@@ -43,12 +43,34 @@ typedef enum _iccpd_log_level_t
 #define LOGBUF_SIZE 1024
 #define ICCPD_UTILS_SYSLOG    (syslog)
 
-#define ICCPD_LOG_CRITICAL(tag, format, args ...) write_log(CRITICAL_LOG_LEVEL, tag, format, ## args)
-#define ICCPD_LOG_ERR(tag, format, args ...) write_log(ERR_LOG_LEVEL, tag, format, ## args)
-#define ICCPD_LOG_WARN(tag, format, args ...) write_log(WARN_LOG_LEVEL, tag, format, ## args)
-#define ICCPD_LOG_NOTICE(tag, format, args ...) write_log(NOTICE_LOG_LEVEL, tag, format, ## args)
-#define ICCPD_LOG_INFO(tag, format, args ...) write_log(INFO_LOG_LEVEL, tag, format, ## args)
-#define ICCPD_LOG_DEBUG(tag, format, args ...) write_log(DEBUG_LOG_LEVEL, tag, format, ## args)
+/* Messages queued for the log thread, a power of 2 */
+#define LOG_RING_SIZE 1024
+/* NOTICE and lower messages per tag and second before the tag is suppressed */
+#define LOG_RATELIMIT_BURST 100
+#define LOG_RATELIMIT_SLOTS 256
+
+/* Highest level built in, define lower to drop the debug logs at compile time */
+#ifndef ICCPD_LOG_LEVEL_MAX
+#define ICCPD_LOG_LEVEL_MAX DEBUG_LOG_LEVEL
+#endif
+
+/* Checked before the arguments are evaluated, a disabled debug log costs
+ * one compare and no mac_addr_to_str() or show_ip_str() calls */
+#define ICCPD_LOG_ENABLED(level) \
+    ((level) <= ICCPD_LOG_LEVEL_MAX && (level) <= g_iccpd_log_config.log_level)
+
+#define ICCPD_LOG(level, tag, format, args ...) \
+do { \
+    if (ICCPD_LOG_ENABLED(level)) \
+        write_log(level, tag, format, ## args); \
+} while (0)
+
+#define ICCPD_LOG_CRITICAL(tag, format, args ...) ICCPD_LOG(CRITICAL_LOG_LEVEL, tag, format, ## args)
+#define ICCPD_LOG_ERR(tag, format, args ...) ICCPD_LOG(ERR_LOG_LEVEL, tag, format, ## args)
+#define ICCPD_LOG_WARN(tag, format, args ...) ICCPD_LOG(WARN_LOG_LEVEL, tag, format, ## args)
+#define ICCPD_LOG_NOTICE(tag, format, args ...) ICCPD_LOG(NOTICE_LOG_LEVEL, tag, format, ## args)
+#define ICCPD_LOG_INFO(tag, format, args ...) ICCPD_LOG(INFO_LOG_LEVEL, tag, format, ## args)
+#define ICCPD_LOG_DEBUG(tag, format, args ...) ICCPD_LOG(DEBUG_LOG_LEVEL, tag, format, ## args)
 
 struct LoggerConfig
 {
@@ -63,7 +85,9 @@ char* log_level_to_string(int level);
 void log_setup(char* progname, char* path);
 void log_finalize();
 void log_init(struct CmdOptionParser* parser);
-void write_log(const int level, const char* tag, const char *format, ...);
+void write_log(const int level, const char* tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+extern struct LoggerConfig g_iccpd_log_config;
 
 #endif /* LOGGER_H_ */
 
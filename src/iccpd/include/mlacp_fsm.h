@@ -32,6 +32,17 @@
 
 #define MLACP_LOCAL_IF_DOWN_TIMER 600  // 600 seconds.
 
+#define MLACP_NEIGH_HASH_SIZE     4096 /* ARP/ND index buckets, power of 2 */
+
+#define MLACP_MAC_DIGEST_TIMEOUT  5    /* seconds to wait for the peer MAC digest */
+
+#define MCLAG_MEMBER_NAME_STR_LEN 2048 /* port isolation member list */
+
+/* mac_digest_state bits */
+#define MLACP_MAC_DIGEST_LOCAL    0x1  /* local digest taken and sent */
+#define MLACP_MAC_DIGEST_PEER     0x2  /* peer digest received */
+#define MLACP_MAC_DIGEST_DONE     0x4  /* MAC table reconciled */
+
 #define MLACP(csm_ptr)  (csm_ptr->app_csm.mlacp)
 
 struct CSM;
@@ -146,6 +157,11 @@ do{\
 typedef struct mlacp_dbg_counter_info
 {
     uint64_t iccp_counters[ICCP_DBG_CNTR_MSG_MAX][ICCP_DBG_CNTR_DIR_MAX][ICCP_DBG_CNTR_STS_MAX];
+    uint64_t tx_queue_msgs;     /* messages queued for the peer */
+    uint64_t tx_writes;         /* socket writes flushing the queue */
+    uint64_t tx_write_bytes;    /* bytes written by those writes */
+    uint64_t tx_write_err;      /* flushes that failed to write */
+    uint32_t tx_queue_max_len;  /* deepest queue flushed, in bytes */
 }mlacp_dbg_counter_info_t;
 
 struct mLACP
@@ -170,13 +186,30 @@ struct mLACP
     TAILQ_HEAD(arp_info_list, Msg) arp_list;
     TAILQ_HEAD(ndisc_msg_list, Msg) ndisc_msg_list;
     TAILQ_HEAD(ndisc_info_list, Msg) ndisc_list;
+    /* arp_list/ndisc_list indexed by IP, the lists keep dump order */
+    struct Msg* arp_hash[MLACP_NEIGH_HASH_SIZE];
+    struct Msg* ndisc_hash[MLACP_NEIGH_HASH_SIZE];
     TAILQ_HEAD(mac_msg_list, MACMsg) mac_msg_list;
 
     struct mac_rb_tree mac_rb;
+    /* MAC digest exchanged on connect, see mlacp_sync_mac() */
+    uint32_t mac_digest[MLACP_MAC_DIGEST_BUCKETS];
+    uint32_t peer_mac_digest[MLACP_MAC_DIGEST_BUCKETS];
+    uint8_t mac_digest_state;
+    time_t mac_digest_time;
+    /* checkpoint restore time, 0 once unconfirmed entries are aged */
+    time_t warm_restore_time;
+    /* peer link isolation group, sent to mclagsyncd once per pass when
+     * changed, see iccp_peerlink_isolate_flush() */
+    uint8_t isolate_dirty;
+    uint8_t isolate_sent_valid;
+    char isolate_sent_src[MAX_L_PORT_NAME];
+    char isolate_sent_dst[MCLAG_MEMBER_NAME_STR_LEN];
 
     LIST_HEAD(lif_list, LocalInterface) lif_list;
     LIST_HEAD(lif_purge_list, LocalInterface) lif_purge_list;
     LIST_HEAD(pif_list, PeerInterface) pif_list;
+    struct PeerInterface* pif_name_hash[IF_HASH_SIZE];
 
     /* ICCP message tx/rx debug counters */
     mlacp_dbg_counter_info_t  dbg_counters;
@@ -185,6 +218,7 @@ struct mLACP
 void mlacp_init(struct CSM* csm, int all);
 void mlacp_finalize(struct CSM* csm);
 void mlacp_fsm_transit(struct CSM* csm);
+void mlacp_fsm_send_heartbeat(struct CSM* csm);
 void mlacp_enqueue_msg(struct CSM*, struct Msg*);
 struct Msg* mlacp_dequeue_msg(struct CSM*);
 char* mlacp_state(struct CSM* csm);
@@ -28,7 +28,6 @@
 #include "../include/mlacp_tlv.h"
 
 #define MCLAG_MAX_MSG_LEN 4096
-#define MCLAG_MEMBER_NAME_STR_LEN 2048
 
 #define ICCP_MLAGSYNCD_SEND_MSG_BUFFER_SIZE MCLAG_MAX_MSG_LEN
 #define ICCP_MLAGSYNCD_RECV_MSG_BUFFER_SIZE (MCLAG_MAX_MSG_LEN * 256)
@@ -53,6 +52,10 @@ void peerlink_port_isolate_cleanup(struct CSM* csm);
 void update_peerlink_isolate_from_all_csm_lif(struct CSM* csm);
 
 ssize_t iccp_send_to_mclagsyncd(uint8_t msg_type, char *send_buff, uint16_t send_len);
+void iccp_mclagsyncd_fdb_flush();
+void iccp_mac_coalesce_flush(int flush_all);
+void iccp_peerlink_isolate_flush();
+int iccp_mclagsyncd_sendq_drain(struct System *sys);
 
 void del_mac_from_chip(struct MACMsg* mac_msg);
 void add_mac_to_chip(struct MACMsg* mac_msg, uint8_t mac_type);
@@ -61,6 +64,9 @@ uint8_t set_mac_local_age_flag(struct CSM *csm, struct MACMsg* mac_msg, uint8_t
 extern int mclagd_ctl_sock_create();
 extern int mclagd_ctl_sock_accept(int fd);
 extern int mclagd_ctl_interactive_process(int client_fd);
+extern int mclagd_ctl_reply_handler(int fd);
+extern void mclagd_ctl_sock_release(int fd);
+extern void mclagd_ctl_reply_expire();
 extern int parseMacString(const char *str_mac, uint8_t *bin_mac);
 
 char *show_ip_str(uint32_t ipv4_addr);
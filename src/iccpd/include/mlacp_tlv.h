@@ -469,6 +469,24 @@ struct mLACPIfUpAckTLV {
     uint16_t        if_id;                   /* LAG: agg_id */
 }__attribute__ ((packed));
 
+/*
+ * NOS: MAC digest
+ * Sent once per connection before the MAC table is synced. Each bucket
+ * sums the hashes of the MACs learned on MCLAG interfaces that fall in
+ * it; only buckets whose digest differs on the two nodes are resent.
+ * Power of 2. At 10^5 MACs a bucket holds about 12 of them, and the
+ * 32KB TLV still fits in one ICC message.
+ */
+#define MLACP_MAC_DIGEST_BUCKETS    8192
+
+struct mLACPMACDigestTLV
+{
+    ICCParameter    icc_parameter;
+    uint16_t        num_buckets;
+    uint16_t        reserved;
+    uint32_t        digest[MLACP_MAC_DIGEST_BUCKETS];
+} __attribute__ ((packed));
+
 enum NEIGH_OP_TYPE
 {
     NEIGH_SYNC_LIF = 0,
@@ -525,6 +543,8 @@ struct MACMsg
     uint8_t age_flag;/*local or peer is age?*/
     uint8_t pending_local_del;
     uint8_t add_to_syncd;
+    /*restored from the warm reboot checkpoint, not yet confirmed*/
+    uint8_t warm_restored;
 
     TAILQ_ENTRY(MACMsg) tail;     // entry into mac_msg_list
 };
@@ -45,6 +45,8 @@
  */
 #define MAX_L_PORT_NAME 20
 
+#define IF_HASH_SIZE    1024 /* interface index buckets, power of 2 */
+
 /* defined in RFC 7275 - 7.2.7 (p.59) */
 #define PORT_STATE_UP               0x00
 #define PORT_STATE_DOWN             0x01
@@ -121,6 +123,7 @@ struct PeerInterface
     struct CSM* csm;
 
     LIST_ENTRY(PeerInterface) mlacp_next;
+    struct PeerInterface* name_hash_next;
     struct vlan_rb_tree vlan_tree;
 };
 
@@ -167,12 +170,18 @@ struct LocalInterface
     LIST_ENTRY(LocalInterface) system_purge_next;
     LIST_ENTRY(LocalInterface) mlacp_next;
     LIST_ENTRY(LocalInterface) mlacp_purge_next;
+
+    /* Chains of the lif_list indexes in struct System */
+    struct LocalInterface* name_hash_next;
+    struct LocalInterface* ifindex_hash_next;
+    struct LocalInterface* po_hash_next;
 };
 
 struct LocalInterface* local_if_create(int ifindex, char* ifname, int type, uint8_t state);
 struct LocalInterface* local_if_find_by_name(const char* ifname);
 struct LocalInterface* local_if_find_by_ifindex(int ifindex);
 struct LocalInterface* local_if_find_by_po_id(int po_id);
+void local_if_set_ifindex(struct LocalInterface* lif, int ifindex);
 
 void local_if_destroy(char *ifname);
 void local_if_change_flag_clear(void);
@@ -184,6 +193,7 @@ void local_if_finalize(struct LocalInterface*);
 
 struct PeerInterface* peer_if_create(struct CSM* csm, int peer_if_number, int type);
 struct PeerInterface* peer_if_find_by_name(struct CSM* csm, char* name);
+void peer_if_set_name(struct PeerInterface* pif, const char* name, size_t len);
 
 void peer_if_destroy(struct PeerInterface* pif);
 int peer_if_add_vlan(struct PeerInterface* peer_if, uint16_t vlan_id);
@@ -27,6 +27,7 @@
 #include <errno.h>
 
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 #include <sys/queue.h>
 
@@ -42,6 +43,8 @@ struct System;
 #define HEARTBEAT_TIMEOUT_SEC       15
 #define TRANSIT_INTERVAL_SEC        1
 #define EPOLL_TIMEOUT_MSEC          100
+/* mLACP messages handled per CSM in one scheduler pass */
+#define MLACP_MSG_BUDGET            256
 
 int scheduler_prepare_session(struct CSM*);
 int scheduler_check_csm_config(struct CSM*);
@@ -57,5 +60,7 @@ int iccp_get_server_sock_fd();
 int scheduler_server_accept();
 int iccp_receive_signal_handler(struct System* sys);
 void scheduler_csm_socket_cleanup(struct CSM* csm, int location);
+uint64_t scheduler_time_usec();
+void scheduler_account(struct System* sys, int src, uint64_t start);
 
 #endif /* SCHEDULER_H_ */
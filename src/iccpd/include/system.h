@@ -247,6 +247,43 @@ do {\
         ++sys->dbg_counters.rx_error_count;\
 }while(0)
 
+/* Object pools, see iccp_csm_init_msg() */
+enum ICCP_POOL_TYPE
+{
+    ICCP_POOL_MSG = 0,      /* struct Msg with a small inline buffer */
+    ICCP_POOL_MAC_MSG = 1,  /* struct MACMsg */
+    ICCP_POOL_MAX
+};
+
+typedef struct iccp_pool_dbg_counter_info
+{
+    uint32_t in_use;        /* objects handed out */
+    uint32_t free;          /* objects cached on the free list */
+    uint32_t slabs;         /* slabs allocated, never released */
+    uint32_t alloc_fail;    /* slab allocation failures */
+    uint64_t allocs;
+    uint64_t frees;
+}iccp_pool_dbg_counter_info_t;
+
+/* Event sources timed by the scheduler, see scheduler_account() */
+enum ICCP_SCHED_SRC
+{
+    ICCP_SCHED_SRC_PEER = 0,    /* ICCP peer sockets and heartbeats */
+    ICCP_SCHED_SRC_NETLINK = 1, /* kernel route and genl netlink */
+    ICCP_SCHED_SRC_SYNCD = 2,   /* mclagsyncd socket */
+    ICCP_SCHED_SRC_PKT = 3,     /* ARP and ND packet sockets */
+    ICCP_SCHED_SRC_FSM = 4,     /* state machine transit */
+    ICCP_SCHED_SRC_OTHER = 5,   /* accept, mclagdctl and signals */
+    ICCP_SCHED_SRC_MAX
+};
+
+typedef struct iccp_sched_dbg_counter_info
+{
+    uint64_t runs;
+    uint64_t total_usec;
+    uint32_t max_usec;
+}iccp_sched_dbg_counter_info_t;
+
 typedef struct system_dbg_counter_info
 {
     /* Netlink message counters */
@@ -290,6 +327,23 @@ typedef struct system_dbg_counter_info
 
     uint64_t syncd_tx_counters[SYNCD_TX_DBG_CNTR_MSG_MAX][SYNCD_DBG_CNTR_STS_MAX];
     uint64_t syncd_rx_counters[SYNCD_RX_DBG_CNTR_MSG_MAX][SYNCD_DBG_CNTR_STS_MAX];
+
+    iccp_pool_dbg_counter_info_t pool_counters[ICCP_POOL_MAX];
+    uint64_t msg_large_buf_counter; /* Msg buffers too large for the pool */
+
+    iccp_sched_dbg_counter_info_t sched_counters[ICCP_SCHED_SRC_MAX];
+    uint64_t sched_budget_exceeded_counter; /* mLACP queue left for next pass */
+
+    uint64_t ingest_event_counter;      /* events handed over by the ingest thread */
+    uint64_t ingest_coalesced_counter;  /* superseded by a later event, not processed */
+    uint64_t ingest_ring_full_counter;  /* ingest thread waited for ring space */
+
+    uint64_t mac_coalesce_held_counter;       /* syncd MAC updates held within the coalescing window */
+    uint64_t mac_coalesce_suppressed_counter; /* held MAC updates replaced by a later one */
+    uint64_t fdb_batch_coalesced_counter;     /* FDB entries to syncd replaced in the same batch */
+
+    uint64_t isolate_update_sent_counter;     /* port isolation groups sent to syncd */
+    uint64_t isolate_update_skipped_counter;  /* recomputed groups equal to the last one sent */
 }system_dbg_counter_info_t;
 
 struct System
@@ -317,6 +371,9 @@ struct System
     /* Info List*/
     LIST_HEAD(csm_list, CSM) csm_list;
     LIST_HEAD(lif_all_list, LocalInterface) lif_list;
+    struct LocalInterface* lif_name_hash[IF_HASH_SIZE];
+    struct LocalInterface* lif_ifindex_hash[IF_HASH_SIZE];
+    struct LocalInterface* lif_po_hash[IF_HASH_SIZE];
     LIST_HEAD(lif_purge_all_list, LocalInterface) lif_purge_list;
     LIST_HEAD(unq_ip_all_if_list, Unq_ip_If_info) unq_ip_if_list;
     LIST_HEAD(pending_vlan_mbr_if_list, PendingVlanMbrIf) pending_vlan_mbr_if_list;
@@ -333,6 +390,7 @@ struct System
     time_t csm_trans_time;
     int need_sync_team_again;
     int need_sync_netlink_again;
+    int sched_work_pending; /* work left over, do not block in epoll_wait */
 
     /* ICCDd/MclagSyncd debug counters */
     system_dbg_counter_info_t dbg_counters;
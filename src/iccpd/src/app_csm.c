@@ -40,8 +40,7 @@
         while (!TAILQ_EMPTY(&(list))) { \
             msg = TAILQ_FIRST(&(list)); \
             TAILQ_REMOVE(&(list), msg, tail); \
-            free(msg->buf); \
-            free(msg); \
+            iccp_csm_free_msg(msg); \
         } \
         TAILQ_INIT(&(list)); \
     }
@@ -109,7 +108,7 @@ void app_csm_enqueue_msg(struct CSM* csm, struct Msg* msg)
     if (csm == NULL )
     {
         if (msg != NULL )
-            free(msg);
+            iccp_csm_free_msg(msg);
         return;
     }
     if (msg == NULL )
@@ -173,7 +172,7 @@ int app_csm_prepare_nak_msg(struct CSM* csm, char* buf, size_t max_buf_size)
     size_t msg_len = sizeof(ICCHdr) + sizeof(NAKTLV);
 
     ICCPD_LOG_DEBUG(__FUNCTION__, " Response NAK");
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
     icc_hdr->ldp_hdr.u_bit = 0x0;
     icc_hdr->ldp_hdr.msg_type = htons(MSG_T_NOTIFICATION);
     icc_hdr->ldp_hdr.msg_len = htons(msg_len - MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS);
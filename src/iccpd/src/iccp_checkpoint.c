@@ -0,0 +1,475 @@
+/*
+ * iccp_checkpoint.c
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * The full GNU General Public License is included in this distribution in
+ * the file called "COPYING".
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/queue.h>
+
+#include "../include/iccp_checkpoint.h"
+#include "../include/system.h"
+#include "../include/logger.h"
+#include "../include/iccp_csm.h"
+#include "../include/mlacp_tlv.h"
+#include "../include/mlacp_sync_update.h"
+#include "../include/mlacp_link_handler.h"
+
+/* Checkpoint read at warm start, released once every domain in it has
+ * been restored */
+static char* g_ckpt_buf = NULL;
+static size_t g_ckpt_len = 0;
+static int g_ckpt_pending = 0;
+
+static int iccp_checkpoint_write(FILE* fp, const void* data, size_t len, uint32_t* total)
+{
+    if (fwrite(data, len, 1, fp) != 1)
+        return MCLAG_ERROR;
+
+    *total += len;
+
+    return 0;
+}
+
+static int iccp_checkpoint_save_domain(FILE* fp, struct CSM* csm, uint32_t* total)
+{
+    struct iccp_ckpt_domain domain;
+    struct iccp_ckpt_mac ckpt_mac;
+    struct iccp_ckpt_arp ckpt_arp;
+    struct iccp_ckpt_ndisc ckpt_ndisc;
+    struct MACMsg* mac_msg = NULL;
+    struct ARPMsg* arp_msg = NULL;
+    struct NDISCMsg* ndisc_msg = NULL;
+    struct Msg* msg = NULL;
+
+    memset(&domain, 0, sizeof(domain));
+    domain.mlag_id = csm->mlag_id;
+
+    RB_FOREACH (mac_msg, mac_rb_tree, &MLACP(csm).mac_rb)
+    {
+        if (mac_msg->pending_local_del)
+            continue;
+        domain.num_mac++;
+    }
+    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+        domain.num_arp++;
+    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+        domain.num_ndisc++;
+
+    if (iccp_checkpoint_write(fp, &domain, sizeof(domain), total) < 0)
+        return MCLAG_ERROR;
+
+    RB_FOREACH (mac_msg, mac_rb_tree, &MLACP(csm).mac_rb)
+    {
+        if (mac_msg->pending_local_del)
+            continue;
+
+        memset(&ckpt_mac, 0, sizeof(ckpt_mac));
+        ckpt_mac.vid = mac_msg->vid;
+        memcpy(ckpt_mac.mac_addr, mac_msg->mac_addr, ETHER_ADDR_LEN);
+        ckpt_mac.fdb_type = mac_msg->fdb_type;
+        ckpt_mac.age_flag = mac_msg->age_flag;
+        ckpt_mac.add_to_syncd = mac_msg->add_to_syncd;
+        memcpy(ckpt_mac.ifname, mac_msg->ifname, MAX_L_PORT_NAME);
+        memcpy(ckpt_mac.origin_ifname, mac_msg->origin_ifname, MAX_L_PORT_NAME);
+
+        if (iccp_checkpoint_write(fp, &ckpt_mac, sizeof(ckpt_mac), total) < 0)
+            return MCLAG_ERROR;
+    }
+
+    TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
+    {
+        arp_msg = (struct ARPMsg*)msg->buf;
+
+        memset(&ckpt_arp, 0, sizeof(ckpt_arp));
+        ckpt_arp.flag = arp_msg->flag;
+        ckpt_arp.learn_flag = arp_msg->learn_flag;
+        memcpy(ckpt_arp.ifname, arp_msg->ifname, MAX_L_PORT_NAME);
+        ckpt_arp.ipv4_addr = arp_msg->ipv4_addr;
+        memcpy(ckpt_arp.mac_addr, arp_msg->mac_addr, ETHER_ADDR_LEN);
+
+        if (iccp_checkpoint_write(fp, &ckpt_arp, sizeof(ckpt_arp), total) < 0)
+            return MCLAG_ERROR;
+    }
+
+    TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
+    {
+        ndisc_msg = (struct NDISCMsg*)msg->buf;
+
+        memset(&ckpt_ndisc, 0, sizeof(ckpt_ndisc));
+        ckpt_ndisc.flag = ndisc_msg->flag;
+        ckpt_ndisc.learn_flag = ndisc_msg->learn_flag;
+        memcpy(ckpt_ndisc.ifname, ndisc_msg->ifname, MAX_L_PORT_NAME);
+        memcpy(ckpt_ndisc.ipv6_addr, ndisc_msg->ipv6_addr, sizeof(ckpt_ndisc.ipv6_addr));
+        memcpy(ckpt_ndisc.mac_addr, ndisc_msg->mac_addr, ETHER_ADDR_LEN);
+
+        if (iccp_checkpoint_write(fp, &ckpt_ndisc, sizeof(ckpt_ndisc), total) < 0)
+            return MCLAG_ERROR;
+    }
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "mlag %d checkpoint: %u MACs, %u ARP, %u ND entries",
+        domain.mlag_id, domain.num_mac, domain.num_arp, domain.num_ndisc);
+
+    return 0;
+}
+
+/*****************************************
+* Tool : Write the MAC, ARP and ND tables of
+*        every domain to the checkpoint file
+*        before a warm reboot exit
+*
+* ***************************************/
+int iccp_checkpoint_save(struct System* sys)
+{
+    struct iccp_ckpt_hdr hdr;
+    struct CSM* csm = NULL;
+    FILE* fp = NULL;
+    char tmp_file[] = ICCP_CHECKPOINT_FILE ".tmp";
+    uint32_t total = 0;
+    int ret = 0;
+
+    if (sys == NULL)
+        return MCLAG_ERROR;
+
+    if (mkdir(ICCP_CHECKPOINT_DIR, 0755) < 0 && errno != EEXIST)
+    {
+        ICCPD_LOG_WARN(__FUNCTION__, "Failed to create %s: %s", ICCP_CHECKPOINT_DIR, strerror(errno));
+        return MCLAG_ERROR;
+    }
+
+    fp = fopen(tmp_file, "w");
+    if (!fp)
+    {
+        ICCPD_LOG_WARN(__FUNCTION__, "Failed to open %s: %s", tmp_file, strerror(errno));
+        return MCLAG_ERROR;
+    }
+    setvbuf(fp, NULL, _IOFBF, 64 * 1024);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = ICCP_CHECKPOINT_MAGIC;
+    hdr.version = ICCP_CHECKPOINT_VERSION;
+    LIST_FOREACH(csm, &(sys->csm_list), next)
+        hdr.num_domains++;
+
+    /* length is patched in once everything is written */
+    ret = iccp_checkpoint_write(fp, &hdr, sizeof(hdr), &total);
+
+    LIST_FOREACH(csm, &(sys->csm_list), next)
+    {
+        if (ret < 0)
+            break;
+        ret = iccp_checkpoint_save_domain(fp, csm, &total);
+    }
+
+    if (ret == 0)
+    {
+        hdr.len = total;
+        if (fseek(fp, 0, SEEK_SET) < 0 || fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+            ret = MCLAG_ERROR;
+    }
+
+    if (fclose(fp) != 0)
+        ret = MCLAG_ERROR;
+
+    if (ret == 0 && rename(tmp_file, ICCP_CHECKPOINT_FILE) < 0)
+        ret = MCLAG_ERROR;
+
+    if (ret < 0)
+    {
+        ICCPD_LOG_WARN(__FUNCTION__, "Failed to write checkpoint %s", ICCP_CHECKPOINT_FILE);
+        unlink(tmp_file);
+        return MCLAG_ERROR;
+    }
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "Warm reboot checkpoint written, %u bytes", total);
+
+    return 0;
+}
+
+/*****************************************
+* Tool : Read the checkpoint at warm start.
+*        The file is removed right away so a
+*        later cold start never uses it.
+*
+* ***************************************/
+int iccp_checkpoint_load(struct System* sys)
+{
+    struct iccp_ckpt_hdr* hdr = NULL;
+    struct stat st;
+    FILE* fp = NULL;
+
+    if (sys == NULL || sys->warmboot_start != WARM_REBOOT)
+    {
+        unlink(ICCP_CHECKPOINT_FILE);
+        return 0;
+    }
+
+    fp = fopen(ICCP_CHECKPOINT_FILE, "r");
+    if (!fp)
+    {
+        ICCPD_LOG_NOTICE(__FUNCTION__, "No warm reboot checkpoint, full relearn");
+        return 0;
+    }
+
+    if (fstat(fileno(fp), &st) < 0 || st.st_size < (off_t)sizeof(struct iccp_ckpt_hdr))
+        goto invalid;
+
+    g_ckpt_buf = (char*)malloc(st.st_size);
+    if (!g_ckpt_buf)
+        goto invalid;
+
+    if (fread(g_ckpt_buf, st.st_size, 1, fp) != 1)
+        goto invalid;
+
+    hdr = (struct iccp_ckpt_hdr*)g_ckpt_buf;
+    if (hdr->magic != ICCP_CHECKPOINT_MAGIC || hdr->version != ICCP_CHECKPOINT_VERSION
+        || hdr->len != st.st_size)
+        goto invalid;
+
+    g_ckpt_len = st.st_size;
+    g_ckpt_pending = hdr->num_domains;
+    fclose(fp);
+    unlink(ICCP_CHECKPOINT_FILE);
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "Warm reboot checkpoint loaded, %u domains, %zu bytes",
+        g_ckpt_pending, g_ckpt_len);
+
+    return 0;
+
+invalid:
+    ICCPD_LOG_WARN(__FUNCTION__, "Invalid warm reboot checkpoint %s, ignored", ICCP_CHECKPOINT_FILE);
+    fclose(fp);
+    unlink(ICCP_CHECKPOINT_FILE);
+    free(g_ckpt_buf);
+    g_ckpt_buf = NULL;
+    g_ckpt_len = 0;
+    g_ckpt_pending = 0;
+
+    return MCLAG_ERROR;
+}
+
+static void iccp_checkpoint_restore_domain(struct CSM* csm, const char* data,
+                                           struct iccp_ckpt_domain* domain)
+{
+    const struct iccp_ckpt_mac* ckpt_mac = NULL;
+    const struct iccp_ckpt_arp* ckpt_arp = NULL;
+    const struct iccp_ckpt_ndisc* ckpt_ndisc = NULL;
+    struct MACMsg mac_data;
+    struct MACMsg* mac_msg = NULL;
+    struct ARPMsg arp_msg;
+    struct NDISCMsg ndisc_msg;
+    struct ARPMsg* arp_entry = NULL;
+    struct NDISCMsg* ndisc_entry = NULL;
+    struct Msg* msg = NULL;
+    uint32_t i;
+    uint32_t num_mac = 0;
+
+    ckpt_mac = (const struct iccp_ckpt_mac*)data;
+    for (i = 0; i < domain->num_mac; i++, ckpt_mac++)
+    {
+        memset(&mac_data, 0, sizeof(mac_data));
+        mac_data.op_type = MAC_SYNC_ADD;
+        mac_data.vid = ckpt_mac->vid;
+        memcpy(mac_data.mac_addr, ckpt_mac->mac_addr, ETHER_ADDR_LEN);
+        mac_data.fdb_type = ckpt_mac->fdb_type;
+        mac_data.age_flag = ckpt_mac->age_flag;
+        mac_data.add_to_syncd = ckpt_mac->add_to_syncd;
+        memcpy(mac_data.ifname, ckpt_mac->ifname, MAX_L_PORT_NAME - 1);
+        memcpy(mac_data.origin_ifname, ckpt_mac->origin_ifname, MAX_L_PORT_NAME - 1);
+        mac_data.warm_restored = 1;
+
+        if (RB_FIND(mac_rb_tree, &MLACP(csm).mac_rb, &mac_data))
+            continue;
+
+        /* The entries are still programmed, only iccpd's view is rebuilt */
+        if (iccp_csm_init_mac_msg(&mac_msg, (char*)&mac_data, sizeof(struct MACMsg)) == 0)
+        {
+            RB_INSERT(mac_rb_tree, &MLACP(csm).mac_rb, mac_msg);
+            num_mac++;
+        }
+    }
+
+    ckpt_arp = (const struct iccp_ckpt_arp*)ckpt_mac;
+    for (i = 0; i < domain->num_arp; i++, ckpt_arp++)
+    {
+        memset(&arp_msg, 0, sizeof(arp_msg));
+        arp_msg.op_type = NEIGH_SYNC_ADD;
+        arp_msg.flag = ckpt_arp->flag;
+        arp_msg.learn_flag = ckpt_arp->learn_flag;
+        memcpy(arp_msg.ifname, ckpt_arp->ifname, MAX_L_PORT_NAME - 1);
+        arp_msg.ipv4_addr = ckpt_arp->ipv4_addr;
+        memcpy(arp_msg.mac_addr, ckpt_arp->mac_addr, ETHER_ADDR_LEN);
+
+        /* already learned since the restart, update it in place */
+        msg = mlacp_arp_find(csm, arp_msg.ipv4_addr);
+        if (msg)
+        {
+            arp_entry = (struct ARPMsg*)msg->buf;
+            sprintf(arp_entry->ifname, "%s", arp_msg.ifname);
+            memcpy(arp_entry->mac_addr, arp_msg.mac_addr, ETHER_ADDR_LEN);
+            continue;
+        }
+
+        if (iccp_csm_init_msg(&msg, (char*)&arp_msg, sizeof(struct ARPMsg)) == 0)
+            mlacp_enqueue_arp(csm, msg);
+    }
+
+    ckpt_ndisc = (const struct iccp_ckpt_ndisc*)ckpt_arp;
+    for (i = 0; i < domain->num_ndisc; i++, ckpt_ndisc++)
+    {
+        memset(&ndisc_msg, 0, sizeof(ndisc_msg));
+        ndisc_msg.op_type = NEIGH_SYNC_ADD;
+        ndisc_msg.flag = ckpt_ndisc->flag;
+        ndisc_msg.learn_flag = ckpt_ndisc->learn_flag;
+        memcpy(ndisc_msg.ifname, ckpt_ndisc->ifname, MAX_L_PORT_NAME - 1);
+        memcpy(ndisc_msg.ipv6_addr, ckpt_ndisc->ipv6_addr, sizeof(ndisc_msg.ipv6_addr));
+        memcpy(ndisc_msg.mac_addr, ckpt_ndisc->mac_addr, ETHER_ADDR_LEN);
+
+        msg = mlacp_ndisc_find(csm, ndisc_msg.ipv6_addr);
+        if (msg)
+        {
+            ndisc_entry = (struct NDISCMsg*)msg->buf;
+            sprintf(ndisc_entry->ifname, "%s", ndisc_msg.ifname);
+            memcpy(ndisc_entry->mac_addr, ndisc_msg.mac_addr, ETHER_ADDR_LEN);
+            continue;
+        }
+
+        if (iccp_csm_init_msg(&msg, (char*)&ndisc_msg, sizeof(struct NDISCMsg)) == 0)
+            mlacp_enqueue_ndisc(csm, msg);
+    }
+
+    time(&MLACP(csm).warm_restore_time);
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "mlag %d restored: %u MACs, %u ARP, %u ND entries",
+        csm->mlag_id, num_mac, domain->num_arp, domain->num_ndisc);
+
+    return;
+}
+
+/*****************************************
+* Tool : Restore the tables of a domain from
+*        the checkpoint once its mlag id is
+*        configured, before the peer connects
+*
+* ***************************************/
+void iccp_checkpoint_restore(struct CSM* csm)
+{
+    struct iccp_ckpt_hdr* hdr = NULL;
+    struct iccp_ckpt_domain* domain = NULL;
+    size_t pos = sizeof(struct iccp_ckpt_hdr);
+    size_t len;
+    uint16_t i;
+
+    if (csm == NULL || g_ckpt_buf == NULL)
+        return;
+
+    hdr = (struct iccp_ckpt_hdr*)g_ckpt_buf;
+    for (i = 0; i < hdr->num_domains; i++)
+    {
+        if (pos + sizeof(struct iccp_ckpt_domain) > g_ckpt_len)
+            break;
+
+        domain = (struct iccp_ckpt_domain*)(g_ckpt_buf + pos);
+        pos += sizeof(struct iccp_ckpt_domain);
+
+        len = (size_t)domain->num_mac * sizeof(struct iccp_ckpt_mac)
+              + (size_t)domain->num_arp * sizeof(struct iccp_ckpt_arp)
+              + (size_t)domain->num_ndisc * sizeof(struct iccp_ckpt_ndisc);
+        if (pos + len > g_ckpt_len)
+            break;
+
+        /* mlag id 0 marks a domain already restored */
+        if (domain->mlag_id != 0 && domain->mlag_id == csm->mlag_id)
+        {
+            iccp_checkpoint_restore_domain(csm, g_ckpt_buf + pos, domain);
+            domain->mlag_id = 0;
+            g_ckpt_pending--;
+        }
+
+        pos += len;
+    }
+
+    if (i < hdr->num_domains)
+    {
+        ICCPD_LOG_WARN(__FUNCTION__, "Truncated warm reboot checkpoint, dropped");
+        g_ckpt_pending = 0;
+    }
+
+    if (g_ckpt_pending <= 0)
+    {
+        free(g_ckpt_buf);
+        g_ckpt_buf = NULL;
+        g_ckpt_len = 0;
+    }
+
+    return;
+}
+
+/* Restored MACs that neither mclagsyncd nor the peer reported again are
+ * dropped. Only MACs iccpd programmed for the peer are removed from the
+ * chip, locally learned entries are left to the hardware aging. */
+void iccp_checkpoint_age(struct CSM* csm)
+{
+    struct MACMsg* mac_msg = NULL;
+    struct MACMsg* mac_temp = NULL;
+    int num_aged = 0;
+
+    if (csm == NULL)
+        return;
+
+    RB_FOREACH_SAFE (mac_msg, mac_rb_tree, &MLACP(csm).mac_rb, mac_temp)
+    {
+        if (!mac_msg->warm_restored)
+            continue;
+
+        if ((mac_msg->age_flag & MAC_AGE_LOCAL) && mac_msg->add_to_syncd)
+            del_mac_from_chip(mac_msg);
+
+        MAC_RB_REMOVE(mac_rb_tree, &MLACP(csm).mac_rb, mac_msg);
+
+        /* a queued entry goes out to the peer as a delete and is freed there */
+        mac_msg->op_type = MAC_SYNC_DEL;
+        if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_msg, tail))
+            iccp_csm_free_mac_msg(mac_msg);
+
+        num_aged++;
+    }
+
+    MLACP(csm).warm_restore_time = 0;
+
+    ICCPD_LOG_NOTICE(__FUNCTION__, "mlag %d: %d restored MACs not confirmed, removed",
+        csm->mlag_id, num_aged);
+
+    return;
+}
+
+/* Called every scheduler pass, the peer may never come back */
+void iccp_checkpoint_age_timer(struct CSM* csm)
+{
+    if (csm == NULL || MLACP(csm).warm_restore_time == 0)
+        return;
+
+    if ((time(NULL) - MLACP(csm).warm_restore_time) >= ICCP_CHECKPOINT_AGE_TIMEOUT)
+        iccp_checkpoint_age(csm);
+
+    return;
+}
@@ -29,6 +29,7 @@
 #include "../include/iccp_csm.h"
 #include "../include/mlacp_link_handler.h"
 #include "../include/iccp_netlink.h"
+#include "../include/iccp_checkpoint.h"
 /*
  * 'id <1-65535>' command
  */
@@ -44,6 +45,9 @@ int set_mc_lag_id( struct CSM *csm, uint16_t id)
     csm->mlag_id = id;
     csm->iccp_info.icc_rg_id = id;
     csm->app_csm.mlacp.id = id;
+
+    /*warm start, bring back the tables saved for this domain */
+    iccp_checkpoint_restore(csm);
     return 0;
 }
 
@@ -85,7 +89,7 @@ int set_peer_link(int mid, const char* ifname)
 
     if (len > MAX_L_PORT_NAME)
     {
-        ICCPD_LOG_ERR(__FUNCTION__, "Peer-link %s, Strlen %d greater than MAX:%d ", ifname, len, MAX_L_PORT_NAME);
+        ICCPD_LOG_ERR(__FUNCTION__, "Peer-link %s, Strlen %zu greater than MAX:%d ", ifname, len, MAX_L_PORT_NAME);
         return MCLAG_ERROR;
     }
 
@@ -120,7 +124,7 @@ int set_peer_link(int mid, const char* ifname)
     memset(csm->peer_itf_name, 0, IFNAMSIZ);
     if (len > IFNAMSIZ)
     {
-        ICCPD_LOG_ERR(__FUNCTION__, "len=%d greater than IFNAMESIZ=%d", len, IFNAMSIZ);
+        ICCPD_LOG_ERR(__FUNCTION__, "len=%zu greater than IFNAMESIZ=%d", len, IFNAMSIZ);
         return MCLAG_ERROR;
     }
     memcpy(csm->peer_itf_name, ifname, len);
@@ -215,14 +219,14 @@ int set_local_address(int mid, const char* addr)
     memset(csm->sender_ip, 0, INET_ADDRSTRLEN);
     if (len > INET_ADDRSTRLEN)
     {
-        ICCPD_LOG_ERR(__FUNCTION__, "len=%d greater than INET_ADDRSTRLEN=%d ", len, INET_ADDRSTRLEN);
+        ICCPD_LOG_ERR(__FUNCTION__, "len=%zu greater than INET_ADDRSTRLEN=%d ", len, INET_ADDRSTRLEN);
         return MCLAG_ERROR;
     }
     memcpy(csm->sender_ip, addr, len);
     memset(csm->iccp_info.sender_name, 0, INET_ADDRSTRLEN);
     if (len > INET_ADDRSTRLEN)
     {
-        ICCPD_LOG_ERR(__FUNCTION__, "len=%d greater than INET_ADDRSTRLEN=%d ", len, INET_ADDRSTRLEN);
+        ICCPD_LOG_ERR(__FUNCTION__, "len=%zu greater than INET_ADDRSTRLEN=%d ", len, INET_ADDRSTRLEN);
         return MCLAG_ERROR;
     }
     memcpy(csm->iccp_info.sender_name, addr, len);
@@ -285,7 +289,7 @@ int set_peer_address(int mid, const char* addr)
     memset(csm->peer_ip, 0, INET_ADDRSTRLEN);
     if (len > INET_ADDRSTRLEN)
     {
-        ICCPD_LOG_ERR(__FUNCTION__, "len=%d greater than INET_ADDRSTRLEN=%d ", len, INET_ADDRSTRLEN);
+        ICCPD_LOG_ERR(__FUNCTION__, "len=%zu greater than INET_ADDRSTRLEN=%d ", len, INET_ADDRSTRLEN);
         return MCLAG_ERROR;
     }
     memcpy(csm->peer_ip, addr, len);
@@ -33,9 +33,38 @@
 #include "mclagdctl/mclagdctl.h"
 #include "../include/iccp_cmd_show.h"
 #include "../include/mlacp_link_handler.h"
+#include "../include/iccp_ingest.h"
 
 extern int local_if_l3_proto_enabled(const char* ifname);
 
+/* Make room for data_len bytes behind the reply header. The size is
+ * doubled so a large table is copied O(log n) times while it is dumped,
+ * not once per MCLAGDCTL_CMD_SIZE of entries. Frees the buffer on failure. */
+static int iccp_cmd_buf_grow(char **buf, int *buf_size, size_t data_len)
+{
+    char *new_buf = NULL;
+    size_t size = *buf_size;
+
+    if (data_len <= size - MCLAGD_REPLY_INFO_HDR)
+        return 0;
+
+    while (data_len > size - MCLAGD_REPLY_INFO_HDR)
+        size *= 2;
+
+    new_buf = (char*)realloc(*buf, size);
+    if (!new_buf)
+    {
+        free(*buf);
+        *buf = NULL;
+        return MCLAG_ERROR;
+    }
+
+    *buf = new_buf;
+    *buf_size = size;
+
+    return 0;
+}
+
 int iccp_mclag_config_dump(char * *buf,  int *num, int mclag_id)
 {
     struct mclagd_state state_info;
@@ -132,13 +161,8 @@ int iccp_mclag_config_dump(char * *buf,  int *num, int mclag_id)
                &state_info, sizeof(struct mclagd_state));
         mclag_num++;
 
-        if ((mclag_num + 1) * sizeof(struct mclagd_state) > (state_buf_size - MCLAGD_REPLY_INFO_HDR))
-        {
-            state_buf_size += MCLAGDCTL_CMD_SIZE;
-            state_buf = (char*)realloc(state_buf, state_buf_size);
-            if (!state_buf)
-                return EXEC_TYPE_FAILED;
-        }
+        if (iccp_cmd_buf_grow(&state_buf, &state_buf_size, (mclag_num + 1) * sizeof(struct mclagd_state)) < 0)
+            return EXEC_TYPE_FAILED;
     }
 
     *buf = state_buf;
@@ -150,7 +174,7 @@ int iccp_mclag_config_dump(char * *buf,  int *num, int mclag_id)
     return EXEC_TYPE_SUCCESS;
 }
 
-int iccp_arp_dump(char * *buf, int *num, int mclag_id)
+int iccp_arp_dump(char * *buf, int *num, int mclag_id, const char *ifname)
 {
     struct System *sys = NULL;
     struct CSM *csm = NULL;
@@ -183,8 +207,11 @@ int iccp_arp_dump(char * *buf, int *num, int mclag_id)
 
         TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
         {
-            memset(&mclagd_arp, 0, sizeof(struct mclagd_arp_msg));
             iccpd_arp = (struct ARPMsg*)msg->buf;
+            if (ifname && ifname[0] && strcmp(iccpd_arp->ifname, ifname) != 0)
+                continue;
+
+            memset(&mclagd_arp, 0, sizeof(struct mclagd_arp_msg));
 
             mclagd_arp.op_type = iccpd_arp->op_type;
             mclagd_arp.learn_flag = iccpd_arp->learn_flag;
@@ -197,13 +224,8 @@ int iccp_arp_dump(char * *buf, int *num, int mclag_id)
 
             arp_num++;
 
-            if ((arp_num + 1) * sizeof(struct mclagd_arp_msg) > (arp_buf_size - MCLAGD_REPLY_INFO_HDR))
-            {
-                arp_buf_size += MCLAGDCTL_CMD_SIZE;
-                arp_buf = (char*)realloc(arp_buf, arp_buf_size);
-                if (!arp_buf)
-                    return EXEC_TYPE_FAILED;
-            }
+            if (iccp_cmd_buf_grow(&arp_buf, &arp_buf_size, (arp_num + 1) * sizeof(struct mclagd_arp_msg)) < 0)
+                return EXEC_TYPE_FAILED;
         }
     }
 
@@ -216,7 +238,7 @@ int iccp_arp_dump(char * *buf, int *num, int mclag_id)
     return EXEC_TYPE_SUCCESS;
 }
 
-int iccp_ndisc_dump(char * *buf, int *num, int mclag_id)
+int iccp_ndisc_dump(char * *buf, int *num, int mclag_id, const char *ifname)
 {
     struct System *sys = NULL;
     struct CSM *csm = NULL;
@@ -249,8 +271,11 @@ int iccp_ndisc_dump(char * *buf, int *num, int mclag_id)
 
         TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
         {
-            memset(&mclagd_ndisc, 0, sizeof(struct mclagd_ndisc_msg));
             iccpd_ndisc = (struct NDISCMsg *)msg->buf;
+            if (ifname && ifname[0] && strcmp(iccpd_ndisc->ifname, ifname) != 0)
+                continue;
+
+            memset(&mclagd_ndisc, 0, sizeof(struct mclagd_ndisc_msg));
 
             mclagd_ndisc.op_type = iccpd_ndisc->op_type;
             mclagd_ndisc.learn_flag = iccpd_ndisc->learn_flag;
@@ -262,13 +287,8 @@ int iccp_ndisc_dump(char * *buf, int *num, int mclag_id)
 
             ndisc_num++;
 
-            if ((ndisc_num + 1) * sizeof(struct mclagd_ndisc_msg) > (ndisc_buf_size - MCLAGD_REPLY_INFO_HDR))
-            {
-                ndisc_buf_size += MCLAGDCTL_CMD_SIZE;
-                ndisc_buf = (char *)realloc(ndisc_buf, ndisc_buf_size);
-                if (!ndisc_buf)
-                    return EXEC_TYPE_FAILED;
-            }
+            if (iccp_cmd_buf_grow(&ndisc_buf, &ndisc_buf_size, (ndisc_num + 1) * sizeof(struct mclagd_ndisc_msg)) < 0)
+                return EXEC_TYPE_FAILED;
         }
     }
 
@@ -281,7 +301,7 @@ int iccp_ndisc_dump(char * *buf, int *num, int mclag_id)
     return EXEC_TYPE_SUCCESS;
 }
 
-int iccp_mac_dump(char * *buf, int *num, int mclag_id)
+int iccp_mac_dump(char * *buf, int *num, int mclag_id, int vid, const char *ifname)
 {
     struct System *sys = NULL;
     struct CSM *csm = NULL;
@@ -314,6 +334,13 @@ int iccp_mac_dump(char * *buf, int *num, int mclag_id)
 
         RB_FOREACH (iccpd_mac, mac_rb_tree, &MLACP(csm).mac_rb)
         {
+            /* Filter here, a filtered dump of a large table stays small */
+            if (vid > 0 && iccpd_mac->vid != vid)
+                continue;
+            if (ifname && ifname[0] && strcmp(iccpd_mac->ifname, ifname) != 0
+                && strcmp(iccpd_mac->origin_ifname, ifname) != 0)
+                continue;
+
             memset(&mclagd_mac, 0, sizeof(struct mclagd_mac_msg));
 
             mclagd_mac.op_type = iccpd_mac->op_type;
@@ -329,13 +356,8 @@ int iccp_mac_dump(char * *buf, int *num, int mclag_id)
 
             mac_num++;
 
-            if ((mac_num + 1) * sizeof(struct mclagd_mac_msg) > (mac_buf_size - MCLAGD_REPLY_INFO_HDR))
-            {
-                mac_buf_size += MCLAGDCTL_CMD_SIZE;
-                mac_buf = (char*)realloc(mac_buf, mac_buf_size);
-                if (!mac_buf)
-                    return EXEC_TYPE_FAILED;
-            }
+            if (iccp_cmd_buf_grow(&mac_buf, &mac_buf_size, (mac_num + 1) * sizeof(struct mclagd_mac_msg)) < 0)
+                return EXEC_TYPE_FAILED;
         }
         }
 
@@ -348,7 +370,7 @@ int iccp_mac_dump(char * *buf, int *num, int mclag_id)
     return EXEC_TYPE_SUCCESS;
 }
 
-int iccp_local_if_dump(char * *buf,  int *num, int mclag_id)
+int iccp_local_if_dump(char * *buf,  int *num, int mclag_id, const char *ifname)
 {
     struct System *sys = NULL;
     struct CSM *csm = NULL;
@@ -385,6 +407,9 @@ int iccp_local_if_dump(char * *buf,  int *num, int mclag_id)
 
         LIST_FOREACH(lif_po, &(MLACP(csm).lif_list), mlacp_next)
         {
+            if (ifname && ifname[0] && strcmp(lif_po->name, ifname) != 0)
+                continue;
+
             memset(&mclagd_lif, 0, sizeof(struct mclagd_local_if));
 
             mclagd_lif.ifindex = lif_po->ifindex;
@@ -481,16 +506,12 @@ int iccp_local_if_dump(char * *buf,  int *num, int mclag_id)
 
             lif_num++;
 
-            if ((lif_num + 1) * sizeof(struct mclagd_local_if) > (lif_buf_size - MCLAGD_REPLY_INFO_HDR))
-            {
-                lif_buf_size += MCLAGDCTL_CMD_SIZE;
-                lif_buf = (char*)realloc(lif_buf, lif_buf_size);
-                if (!lif_buf)
-                    return EXEC_TYPE_FAILED;
-            }
+            if (iccp_cmd_buf_grow(&lif_buf, &lif_buf_size, (lif_num + 1) * sizeof(struct mclagd_local_if)) < 0)
+                return EXEC_TYPE_FAILED;
         }
 
-        if (csm->peer_link_if) {
+        if (csm->peer_link_if
+            && !(ifname && ifname[0] && strcmp(csm->peer_link_if->name, ifname) != 0)) {
 
             lif_peer = csm->peer_link_if;
 
@@ -590,13 +611,8 @@ int iccp_local_if_dump(char * *buf,  int *num, int mclag_id)
 
             lif_num++;
 
-            if ((lif_num + 1) * sizeof(struct mclagd_local_if) > (lif_buf_size - MCLAGD_REPLY_INFO_HDR))
-            {
-                lif_buf_size += MCLAGDCTL_CMD_SIZE;
-                lif_buf = (char*)realloc(lif_buf, lif_buf_size);
-                if (!lif_buf)
-                    return EXEC_TYPE_FAILED;
-            }
+            if (iccp_cmd_buf_grow(&lif_buf, &lif_buf_size, (lif_num + 1) * sizeof(struct mclagd_local_if)) < 0)
+                return EXEC_TYPE_FAILED;
 
         }
     }
@@ -674,13 +690,8 @@ int iccp_peer_if_dump(char * *buf, int *num, int mclag_id)
 
             pif_num++;
 
-            if ((pif_num + 1) * sizeof(struct mclagd_peer_if) > (pif_buf_size - MCLAGD_REPLY_INFO_HDR))
-            {
-                pif_buf_size += MCLAGDCTL_CMD_SIZE;
-                pif_buf = (char*)realloc(pif_buf, pif_buf_size);
-                if (!pif_buf)
-                    return EXEC_TYPE_FAILED;
-            }
+            if (iccp_cmd_buf_grow(&pif_buf, &pif_buf_size, (pif_num + 1) * sizeof(struct mclagd_peer_if)) < 0)
+                return EXEC_TYPE_FAILED;
         }
     }
 
@@ -732,6 +743,8 @@ int iccp_cmd_dbg_counter_dump(char **buf, int *data_len, int mclag_id)
     counter_ptr =
         (mclagd_dbg_counter_info_t *)(counter_buf + MCLAGD_REPLY_INFO_HDR);
     memcpy(&counter_ptr->system_dbg, &sys->dbg_counters, sizeof(sys->dbg_counters));
+    iccp_csm_pool_dbg_counters(&counter_ptr->system_dbg);
+    iccp_ingest_dbg_counters(&counter_ptr->system_dbg);
     counter_ptr->num_iccp_counter_blocks = num_csm;
     temp_ptr = counter_ptr->iccp_dbg_counters;
     is_first_csm = true;
@@ -798,13 +811,8 @@ int iccp_unique_ip_if_dump(char **buf, int *num, int mclag_id)
 
         lif_num++;
 
-        if ((lif_num + 1) * sizeof(struct mclagd_unique_ip_if) > (lif_buf_size - MCLAGD_REPLY_INFO_HDR))
-        {
-            lif_buf_size += MCLAGDCTL_CMD_SIZE;
-            lif_buf = (char*)realloc(lif_buf, lif_buf_size);
-            if (!lif_buf)
-                return EXEC_TYPE_FAILED;
-        }
+        if (iccp_cmd_buf_grow(&lif_buf, &lif_buf_size, (lif_num + 1) * sizeof(struct mclagd_unique_ip_if)) < 0)
+            return EXEC_TYPE_FAILED;
     }
 
     *buf = lif_buf;
@@ -41,8 +41,7 @@
         while (!TAILQ_EMPTY(&(list))) { \
             msg = TAILQ_FIRST(&(list)); \
             TAILQ_REMOVE(&(list), msg, tail); \
-            free(msg->buf); \
-            free(msg); \
+            iccp_csm_free_msg(msg); \
         } \
         TAILQ_INIT(&(list)); \
     }
@@ -148,6 +147,8 @@ void iccp_csm_status_reset(struct CSM* csm, int all)
     csm->peer_link_learning_enable = 0;
     csm->role_type = STP_ROLE_NONE;
     csm->sock_read_event_ptr = NULL;
+    csm->rx_len = 0;
+    csm->tx_len = 0;
     csm->peer_link_if = NULL;
     csm->u_msg_in_count = 0x0;
     csm->i_msg_in_count = 0x0;
@@ -237,7 +238,7 @@ void iccp_csm_msg_list_finalize(struct CSM* csm)
     {
         msg = TAILQ_FIRST(&(csm->msg_list));
         TAILQ_REMOVE(&(csm->msg_list), msg, tail);
-        free(msg);
+        iccp_csm_free_msg(msg);
     }
 }
 
@@ -246,10 +247,9 @@ int iccp_csm_send(struct CSM* csm, char* buf, int msg_len)
 {
     LDPHdr* ldp_hdr = (LDPHdr*)buf;
     ICCParameter* param = NULL;
-    ssize_t rc;
     uint16_t tlv_type;
 
-    if (csm == NULL || buf == NULL || csm->sock_fd <= 0 || msg_len <= 0)
+    if (csm == NULL || buf == NULL || csm->sock_fd <= 0 || msg_len <= 0 || msg_len > CSM_BUFFER_SIZE)
         return MCLAG_ERROR;
 
     if (ntohs(ldp_hdr->msg_type) == MSG_T_CAPABILITY)
@@ -266,19 +266,72 @@ int iccp_csm_send(struct CSM* csm, char* buf, int msg_len)
         csm->msg_log.end_index = 0;
 
     tlv_type = ntohs(param->type);
-    rc = write(csm->sock_fd, buf, msg_len);
-    if ((rc <= 0) || (rc != msg_len))
+
+    /* Queue the message, the scheduler writes the queue out at the end
+     * of its pass so a sync burst goes out in a few large writes */
+    if (csm->tx_len + msg_len > CSM_BUFFER_SIZE && iccp_csm_tx_flush(csm) < 0)
     {
         MLACP_SET_ICCP_TX_DBG_COUNTER(
             csm, tlv_type, ICCP_DBG_CNTR_STS_ERR);
-        ICCPD_LOG_ERR("ICCP_FSM", "Failed to write msg %s/0x%x, msg_len:%d, rc %d Error:%s ", get_tlv_type_string(tlv_type), tlv_type, msg_len, rc, strerror(errno));
+        ICCPD_LOG_ERR("ICCP_FSM", "Failed to write msg %s/0x%x, msg_len:%d", get_tlv_type_string(tlv_type), tlv_type, msg_len);
+        return MCLAG_ERROR;
     }
-    else
+
+    memcpy(&csm->tx_buf[csm->tx_len], buf, msg_len);
+    csm->tx_len += msg_len;
+    ++MLACP(csm).dbg_counters.tx_queue_msgs;
+
+    MLACP_SET_ICCP_TX_DBG_COUNTER(
+        csm, tlv_type, ICCP_DBG_CNTR_STS_OK);
+
+    return msg_len;
+}
+
+/* Write out the messages queued for the peer. iccp_csm_send() callers
+ * took a queued message as sent, so a failed write resets the session:
+ * the socket is shut down, the read callback sees the disconnect at a safe
+ * point of the scheduler pass and the peers resync everything. */
+int iccp_csm_tx_flush(struct CSM* csm)
+{
+    size_t pos = 0;
+    ssize_t rc;
+
+    if (csm == NULL || csm->tx_len == 0)
+        return 0;
+
+    if (csm->sock_fd <= 0)
     {
-        MLACP_SET_ICCP_TX_DBG_COUNTER(
-            csm, tlv_type, ICCP_DBG_CNTR_STS_OK);
+        csm->tx_len = 0;
+        return MCLAG_ERROR;
     }
-    return (rc);
+
+    if (csm->tx_len > MLACP(csm).dbg_counters.tx_queue_max_len)
+        MLACP(csm).dbg_counters.tx_queue_max_len = csm->tx_len;
+
+    while (pos < csm->tx_len)
+    {
+        rc = send(csm->sock_fd, &csm->tx_buf[pos], csm->tx_len - pos, MSG_NOSIGNAL);
+        if (rc < 0 && errno == EINTR)
+            continue;
+
+        if (rc <= 0)
+        {
+            ICCPD_LOG_ERR("ICCP_FSM", "Failed to write queued msgs, len:%zu, rc %zd Error:%s, reset session",
+                          csm->tx_len - pos, rc, strerror(errno));
+            ++MLACP(csm).dbg_counters.tx_write_err;
+            csm->tx_len = 0;
+            shutdown(csm->sock_fd, SHUT_RDWR);
+            return MCLAG_ERROR;
+        }
+
+        ++MLACP(csm).dbg_counters.tx_writes;
+        MLACP(csm).dbg_counters.tx_write_bytes += rc;
+        pos += rc;
+    }
+
+    csm->tx_len = 0;
+
+    return pos;
 }
 
 /* Connection State Machine Transition */
@@ -334,7 +387,6 @@ void iccp_csm_transit(struct CSM* csm)
         case ICCP_CAPREC:
             if (msg)
                 iccp_csm_correspond_from_msg(csm, msg);
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
             len = iccp_csm_prepare_iccp_msg(csm, g_csm_buf, CSM_BUFFER_SIZE);
             iccp_csm_send(csm, g_csm_buf, len);
             if (csm->iccp_info.peer_rg_connect_flag == 0x0 && csm->iccp_info.status_code == 0x0)
@@ -346,7 +398,6 @@ void iccp_csm_transit(struct CSM* csm)
         case ICCP_CONNECTING:
             if (msg)
                 iccp_csm_correspond_from_msg(csm, msg);
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
             len = iccp_csm_prepare_iccp_msg(csm, g_csm_buf, CSM_BUFFER_SIZE);
             iccp_csm_send(csm, g_csm_buf, len);
             if (csm->iccp_info.status_code > 0x0)
@@ -360,7 +411,6 @@ void iccp_csm_transit(struct CSM* csm)
                 iccp_csm_correspond_from_msg(csm, msg);
             if (csm->iccp_info.sender_rg_connect_flag == 0x0 || csm->iccp_info.peer_rg_connect_flag == 0x0)
             {
-                memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
                 len = iccp_csm_prepare_iccp_msg(csm, g_csm_buf, CSM_BUFFER_SIZE);
                 iccp_csm_send(csm, g_csm_buf, len);
                 csm->current_state = ICCP_CAPREC;
@@ -466,7 +516,7 @@ int iccp_csm_prepare_capability_msg(struct CSM* csm, char* buf, size_t max_buf_s
     LDPICCPCapabilityTLV* cap = (LDPICCPCapabilityTLV*)&buf[sizeof(LDPHdr)];
     size_t msg_len = sizeof(LDPHdr) + sizeof(LDPICCPCapabilityTLV);
 
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     /* LDP header */
     ldp_hdr->u_bit = 0x0;
@@ -508,7 +558,7 @@ int iccp_csm_prepare_nak_msg(struct CSM* csm, char* buf, size_t max_buf_size)
     NAKTLV* nak = (NAKTLV*)&buf[sizeof(ICCHdr)];
     size_t msg_len = sizeof(ICCHdr) + sizeof(NAKTLV);
 
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     /* ICC header */
     icc_hdr->ldp_hdr.u_bit = 0x0;
@@ -553,7 +603,7 @@ int iccp_csm_prepare_rg_connect_msg(struct CSM* csm, char* buf, size_t max_buf_s
     size_t name_len = strlen(csm->iccp_info.sender_name);
     size_t msg_len = sizeof(ICCHdr) + sizeof(ICCParameter) + name_len;
 
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     /* ICC header */
     icc_hdr->ldp_hdr.u_bit = 0x0;
@@ -579,7 +629,7 @@ int iccp_csm_prepare_rg_disconnect_msg(struct CSM* csm, char* buf, size_t max_bu
     DisconnectCodeTLV* disconn_code = (DisconnectCodeTLV*)&buf[sizeof(ICCHdr)];
     size_t msg_len = sizeof(ICCHdr) + sizeof(DisconnectCodeTLV);
 
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     /* ICC header */
     icc_hdr->ldp_hdr.u_bit = 0x0;
@@ -660,8 +710,7 @@ void iccp_csm_correspond_from_msg(struct CSM* csm, struct Msg* msg)
         ++csm->u_msg_in_count;
     }
 
-    free(msg->buf);
-    free(msg);
+    iccp_csm_free_msg(msg);
 }
 
 /* Receive capability message correspond function */
@@ -728,7 +777,7 @@ void iccp_csm_enqueue_msg(struct CSM* csm, struct Msg* msg)
     if (csm == NULL)
     {
         if (msg != NULL)
-            free(msg);
+            iccp_csm_free_msg(msg);
         return;
     }
 
@@ -782,9 +831,100 @@ struct Msg* iccp_csm_dequeue_msg(struct CSM* csm)
     return msg;
 }
 
+/*****************************************
+* Object pools
+*
+* Msg and MACMsg objects are carved out of slabs and recycled through a
+* free list instead of going back to libc. Slabs are never released, the
+* pools stay at the high water mark.
+* ***************************************/
+#define ICCP_POOL_SLAB_OBJS       256
+#define ICCP_MSG_POOL_BUF_SIZE    128   /* fits ARPMsg, NDISCMsg and small TLVs */
+
+struct iccp_pool_obj
+{
+    struct iccp_pool_obj* next;
+};
+
+struct iccp_pool
+{
+    size_t obj_size;
+    struct iccp_pool_obj* free_list;
+    iccp_pool_dbg_counter_info_t counters;
+};
+
+/* Pooled Msg, buf points to data unless the message is too large */
+struct iccp_msg_obj
+{
+    struct Msg msg;
+    char data[ICCP_MSG_POOL_BUF_SIZE];
+};
+
+static struct iccp_pool g_iccp_pools[ICCP_POOL_MAX] = {
+    [ICCP_POOL_MSG] = { .obj_size = sizeof(struct iccp_msg_obj) },
+    [ICCP_POOL_MAC_MSG] = { .obj_size = sizeof(struct MACMsg) },
+};
+static uint64_t g_iccp_msg_large_buf_count = 0;
+
+static void *iccp_pool_alloc(struct iccp_pool* pool)
+{
+    struct iccp_pool_obj* obj = NULL;
+    char* slab = NULL;
+    int i;
+
+    if (pool->free_list == NULL)
+    {
+        slab = (char*)malloc(pool->obj_size * ICCP_POOL_SLAB_OBJS);
+        if (slab == NULL)
+        {
+            ++pool->counters.alloc_fail;
+            return NULL;
+        }
+
+        for (i = ICCP_POOL_SLAB_OBJS - 1; i >= 0; i--)
+        {
+            obj = (struct iccp_pool_obj*)(slab + i * pool->obj_size);
+            obj->next = pool->free_list;
+            pool->free_list = obj;
+        }
+        ++pool->counters.slabs;
+        pool->counters.free += ICCP_POOL_SLAB_OBJS;
+    }
+
+    obj = pool->free_list;
+    pool->free_list = obj->next;
+    --pool->counters.free;
+    ++pool->counters.in_use;
+    ++pool->counters.allocs;
+
+    return obj;
+}
+
+static void iccp_pool_free(struct iccp_pool* pool, void* ptr)
+{
+    struct iccp_pool_obj* obj = (struct iccp_pool_obj*)ptr;
+
+    obj->next = pool->free_list;
+    pool->free_list = obj;
+    ++pool->counters.free;
+    --pool->counters.in_use;
+    ++pool->counters.frees;
+}
+
+/* Copy pool usage into the debug counters reported to mclagdctl */
+void iccp_csm_pool_dbg_counters(struct system_dbg_counter_info* counters)
+{
+    int i;
+
+    for (i = 0; i < ICCP_POOL_MAX; i++)
+        counters->pool_counters[i] = g_iccp_pools[i].counters;
+    counters->msg_large_buf_counter = g_iccp_msg_large_buf_count;
+}
+
 /* Message initialization */
 int iccp_csm_init_msg(struct Msg** msg, char* data, int len)
 {
+    struct iccp_msg_obj* obj = NULL;
     struct Msg* iccp_msg = NULL;
 
     if (msg == NULL)
@@ -793,29 +933,47 @@ int iccp_csm_init_msg(struct Msg** msg, char* data, int len)
     if (data == NULL || len <= 0)
         return MCLAG_ERROR;
 
-    iccp_msg = (struct Msg*)malloc(sizeof(struct Msg));
-    if (iccp_msg == NULL)
-        goto err_ret;
+    obj = (struct iccp_msg_obj*)iccp_pool_alloc(&g_iccp_pools[ICCP_POOL_MSG]);
+    if (obj == NULL)
+        return MCLAG_ERROR;
 
-    iccp_msg->buf = (char*)malloc(len);
-    if (iccp_msg->buf == NULL)
-        goto err_ret;
+    iccp_msg = &obj->msg;
+    memset(iccp_msg, 0, sizeof(struct Msg));
+
+    if (len <= ICCP_MSG_POOL_BUF_SIZE)
+    {
+        iccp_msg->buf = obj->data;
+    }
+    else
+    {
+        iccp_msg->buf = (char*)malloc(len);
+        if (iccp_msg->buf == NULL)
+        {
+            iccp_pool_free(&g_iccp_pools[ICCP_POOL_MSG], obj);
+            return MCLAG_ERROR;
+        }
+        ++g_iccp_msg_large_buf_count;
+    }
 
     memcpy(iccp_msg->buf, data, len);
     iccp_msg->len = len;
     *msg = iccp_msg;
 
     return 0;
+}
 
- err_ret:
-    if (iccp_msg)
-    {
-        if (iccp_msg->buf)
-            free(iccp_msg->buf);
-        free(iccp_msg);
-    }
+/* Release a message from iccp_csm_init_msg() */
+void iccp_csm_free_msg(struct Msg* msg)
+{
+    struct iccp_msg_obj* obj = (struct iccp_msg_obj*)msg;
+
+    if (msg == NULL)
+        return;
+
+    if (msg->buf != obj->data)
+        free(msg->buf);
 
-    return MCLAG_ERROR;
+    iccp_pool_free(&g_iccp_pools[ICCP_POOL_MSG], obj);
 }
 
 /* MAC Message initialization */
@@ -826,21 +984,32 @@ int iccp_csm_init_mac_msg(struct MACMsg **mac_msg, char* data, int len)
     if (mac_msg == NULL)
         return -2;
 
-    if (data == NULL || len <= 0)
+    if (data == NULL || len <= 0 || len > sizeof(struct MACMsg))
         return MCLAG_ERROR;
 
-    iccp_mac_msg = (struct MACMsg*)malloc(sizeof(struct MACMsg));
+    iccp_mac_msg = (struct MACMsg*)iccp_pool_alloc(&g_iccp_pools[ICCP_POOL_MAC_MSG]);
     if (iccp_mac_msg == NULL)
        return -3;
 
     memset(iccp_mac_msg, 0, sizeof(struct MACMsg));
     memcpy(iccp_mac_msg, data, len);
+    SYSTEM_INCR_MAC_ENTRY_ALLOC_COUNTER(system_get_instance());
 
     *mac_msg = iccp_mac_msg;
 
     return 0;
 }
 
+/* Release a MAC entry from iccp_csm_init_mac_msg() */
+void iccp_csm_free_mac_msg(struct MACMsg* mac_msg)
+{
+    if (mac_msg == NULL)
+        return;
+
+    SYSTEM_INCR_MAC_ENTRY_FREE_COUNTER(system_get_instance());
+    iccp_pool_free(&g_iccp_pools[ICCP_POOL_MAC_MSG], mac_msg);
+}
+
 
 void iccp_csm_stp_role_count(struct CSM *csm)
 {
@@ -0,0 +1,666 @@
+/*
+ * iccp_ingest.c
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * The full GNU General Public License is included in this distribution in
+ * the file called "COPYING".
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#include <netlink/netlink.h>
+#include <netlink/msg.h>
+#include <netlink/attr.h>
+#include <linux/rtnetlink.h>
+#include <linux/neighbour.h>
+
+#include "../include/system.h"
+#include "../include/logger.h"
+#include "../include/iccp_ifm.h"
+#include "../include/iccp_netlink.h"
+#include "../include/iccp_ingest.h"
+
+/* Route netlink events and ARP/ND packets are read and decoded by the
+ * ingest thread, the main loop only applies them. The ring is a bounded
+ * MPSC queue like the log ring: producers reserve a slot by moving the
+ * head, each slot sequence number tells whose turn it is. */
+struct iccp_ingest_slot
+{
+    uint32_t seq;
+    struct iccp_ingest_event ev;
+};
+
+#define ICCP_INGEST_HASH_SIZE   (ICCP_INGEST_BUDGET * 2)
+
+static struct iccp_ingest_slot g_ingest_ring[ICCP_INGEST_RING_SIZE];
+static uint32_t g_ingest_ring_head = 0;
+static uint32_t g_ingest_ring_tail = 0;
+
+static pthread_t g_ingest_thread;
+static int g_ingest_running = 0;
+static volatile int g_ingest_stop = 0;
+static int g_ingest_event_fd = -1;  /* main loop wakeup */
+static int g_ingest_ctl_fd = -1;    /* ingest thread wakeup */
+static int g_ingest_wakeup = 0;     /* event fd already signalled */
+static int g_ingest_dump_request = 0;
+
+static uint64_t g_ingest_event_count = 0;
+static uint64_t g_ingest_coalesced_count = 0;
+static uint64_t g_ingest_ring_full_count = 0;
+
+static void iccp_ingest_ring_init()
+{
+    uint32_t i;
+
+    for (i = 0; i < ICCP_INGEST_RING_SIZE; i++)
+        g_ingest_ring[i].seq = i;
+
+    g_ingest_ring_head = 0;
+    g_ingest_ring_tail = 0;
+
+    return;
+}
+
+/* Reserve the next free slot, NULL if the ring is full */
+static struct iccp_ingest_slot* iccp_ingest_ring_reserve(uint32_t* pos)
+{
+    struct iccp_ingest_slot* slot;
+    uint32_t head;
+    uint32_t seq;
+    int32_t dif;
+
+    head = __atomic_load_n(&g_ingest_ring_head, __ATOMIC_RELAXED);
+    while (1)
+    {
+        slot = &g_ingest_ring[head & (ICCP_INGEST_RING_SIZE - 1)];
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        dif = (int32_t)(seq - head);
+
+        if (dif == 0)
+        {
+            if (__atomic_compare_exchange_n(&g_ingest_ring_head, &head, head + 1, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                *pos = head;
+                return slot;
+            }
+        }
+        else if (dif < 0)
+        {
+            return NULL;
+        }
+        else
+        {
+            head = __atomic_load_n(&g_ingest_ring_head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/* Take the oldest published event, main loop only */
+static int iccp_ingest_ring_pop(struct iccp_ingest_event* ev)
+{
+    struct iccp_ingest_slot* slot;
+
+    slot = &g_ingest_ring[g_ingest_ring_tail & (ICCP_INGEST_RING_SIZE - 1)];
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != g_ingest_ring_tail + 1)
+        return 0;
+
+    *ev = slot->ev;
+    __atomic_store_n(&slot->seq, g_ingest_ring_tail + ICCP_INGEST_RING_SIZE, __ATOMIC_RELEASE);
+    g_ingest_ring_tail++;
+
+    return 1;
+}
+
+static void iccp_ingest_wakeup()
+{
+    uint64_t val = 1;
+
+    if (__atomic_exchange_n(&g_ingest_wakeup, 1, __ATOMIC_SEQ_CST) == 0)
+    {
+        if (write(g_ingest_event_fd, &val, sizeof(val)) < 0)
+            __atomic_store_n(&g_ingest_wakeup, 0, __ATOMIC_SEQ_CST);
+    }
+
+    return;
+}
+
+/* Queue an event for the main loop. A full ring is not dropped, the
+ * thread waits and the kernel socket buffers absorb the burst. */
+static void iccp_ingest_push(struct iccp_ingest_event* ev)
+{
+    struct iccp_ingest_slot* slot;
+    uint32_t pos;
+    int waited = 0;
+
+    while ((slot = iccp_ingest_ring_reserve(&pos)) == NULL)
+    {
+        if (g_ingest_stop)
+        {
+            if (ev->msg)
+                nlmsg_free(ev->msg);
+            return;
+        }
+
+        if (!waited)
+        {
+            __atomic_add_fetch(&g_ingest_ring_full_count, 1, __ATOMIC_RELAXED);
+            waited = 1;
+        }
+
+        iccp_ingest_wakeup();
+        usleep(1000);
+    }
+
+    slot->ev = *ev;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    iccp_ingest_wakeup();
+
+    return;
+}
+
+static void iccp_ingest_push_resync()
+{
+    struct iccp_ingest_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.key.type = ICCP_INGEST_RESYNC;
+    iccp_ingest_push(&ev);
+
+    return;
+}
+
+/* Route event socket callback, ingest thread. The message is copied as
+ * is and keyed by the link or neighbor it is about. */
+static int iccp_ingest_route_msg(struct nl_msg* msg, void* arg)
+{
+    struct nlmsghdr* nlh = nlmsg_hdr(msg);
+    struct iccp_ingest_event ev;
+    struct ifinfomsg* ifi = NULL;
+    struct ndmsg* ndm = NULL;
+    struct nlattr* dst = NULL;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.key.type = ICCP_INGEST_NETLINK;
+    ev.key.msg_type = nlh->nlmsg_type;
+
+    switch (nlh->nlmsg_type)
+    {
+        case RTM_NEWLINK:
+        case RTM_DELLINK:
+            if (nlmsg_datalen(nlh) < (int)sizeof(struct ifinfomsg))
+                break;
+            ifi = nlmsg_data(nlh);
+            ev.key.family = ifi->ifi_family;
+            ev.key.ifindex = ifi->ifi_index;
+            ev.coalesce = 1;
+            break;
+
+        case RTM_NEWNEIGH:
+        case RTM_DELNEIGH:
+            if (nlmsg_datalen(nlh) < (int)sizeof(struct ndmsg))
+                break;
+            ndm = nlmsg_data(nlh);
+            dst = nlmsg_find_attr(nlh, sizeof(struct ndmsg), NDA_DST);
+            if (!dst || nla_len(dst) > (int)sizeof(ev.key.addr))
+                break;
+            ev.key.family = ndm->ndm_family;
+            ev.key.ifindex = ndm->ndm_ifindex;
+            memcpy(ev.key.addr, nla_data(dst), nla_len(dst));
+            ev.coalesce = 1;
+            break;
+
+        default:
+            break;
+    }
+
+    ev.msg = nlmsg_convert(nlh);
+    if (!ev.msg)
+    {
+        ICCPD_LOG_WARN(__FUNCTION__, "Failed to copy netlink message type %d", nlh->nlmsg_type);
+        iccp_ingest_push_resync();
+        return NL_OK;
+    }
+    /* nl_msg_parse() looks the cache ops up by protocol */
+    nlmsg_set_proto(ev.msg, NETLINK_ROUTE);
+
+    iccp_ingest_push(&ev);
+
+    return NL_OK;
+}
+
+static void iccp_ingest_route_recv(struct System* sys)
+{
+    int ret;
+
+    ret = nl_recvmsgs_default(sys->route_event_sock);
+    if (ret < 0)
+    {
+        ICCPD_LOG_NOTICE(__FUNCTION__, "fd %d recvmsg error ret = %d  errno = %d ",
+            nl_socket_get_fd(sys->route_event_sock), ret, errno);
+        iccp_ingest_push_resync();
+    }
+
+    return;
+}
+
+/* Kernel neighbor dump on the event socket, the replies go through the
+ * same callback as the neighbor events */
+static void iccp_ingest_neigh_dump(struct System* sys)
+{
+    struct rtgenmsg rt_hdr = {
+        .rtgen_family   = AF_UNSPEC,
+    };
+    int ret;
+    int retry = 1;
+
+    while (retry && !g_ingest_stop)
+    {
+        retry = 0;
+        ret = nl_send_simple(sys->route_event_sock, RTM_GETNEIGH, NLM_F_DUMP,
+                             &rt_hdr, sizeof(rt_hdr));
+        if (ret < 0)
+        {
+            ICCPD_LOG_ERR(__FUNCTION__, "Send netlink msg error.");
+            return;
+        }
+
+        ret = nl_recvmsgs_default(sys->route_event_sock);
+        if (ret == -NLE_DUMP_INTR)
+        {
+            retry = 1;
+        }
+        else if (ret < 0)
+        {
+            ICCPD_LOG_ERR(__FUNCTION__, "Receive netlink msg error %d.", ret);
+            iccp_ingest_push_resync();
+        }
+    }
+
+    return;
+}
+
+static void iccp_ingest_arp_recv(struct System* sys)
+{
+    struct iccp_ingest_event ev;
+    unsigned int ifindex;
+    unsigned int addr;
+
+    memset(&ev, 0, sizeof(ev));
+    if (iccp_receive_arp_packet(sys->arp_receive_fd, &ifindex, &addr, ev.mac_addr) <= 0)
+        return;
+
+    ev.key.type = ICCP_INGEST_ARP;
+    ev.key.family = AF_INET;
+    ev.key.ifindex = ifindex;
+    memcpy(ev.key.addr, &addr, 4);
+    ev.coalesce = 1;
+    iccp_ingest_push(&ev);
+
+    return;
+}
+
+static void iccp_ingest_ndisc_recv(struct System* sys)
+{
+    struct iccp_ingest_event ev;
+    unsigned int ifindex = 0;
+    struct in6_addr target;
+
+    memset(&ev, 0, sizeof(ev));
+    if (iccp_receive_ndisc_packet(sys->ndisc_receive_fd, &ifindex, &target, ev.mac_addr) <= 0)
+        return;
+
+    ev.key.type = ICCP_INGEST_NDISC;
+    ev.key.family = AF_INET6;
+    ev.key.ifindex = ifindex;
+    memcpy(ev.key.addr, &target, sizeof(target));
+    ev.coalesce = 1;
+    iccp_ingest_push(&ev);
+
+    return;
+}
+
+static void* iccp_ingest_thread_main(void* arg)
+{
+    struct System* sys = (struct System*)arg;
+    struct pollfd fds[4];
+    sigset_t mask;
+    uint64_t val;
+
+    /* signals are for the main loop */
+    sigfillset(&mask);
+    pthread_sigmask(SIG_BLOCK, &mask, NULL);
+
+    nl_socket_modify_cb(sys->route_event_sock, NL_CB_VALID, NL_CB_CUSTOM,
+                        iccp_ingest_route_msg, sys);
+
+    memset(fds, 0, sizeof(fds));
+    fds[0].fd = g_ingest_ctl_fd;
+    fds[1].fd = nl_socket_get_fd(sys->route_event_sock);
+    fds[2].fd = sys->arp_receive_fd;
+    fds[3].fd = sys->ndisc_receive_fd;
+    fds[0].events = fds[1].events = fds[2].events = fds[3].events = POLLIN;
+
+    while (!g_ingest_stop)
+    {
+        if (__atomic_exchange_n(&g_ingest_dump_request, 0, __ATOMIC_ACQ_REL))
+            iccp_ingest_neigh_dump(sys);
+
+        if (poll(fds, 4, -1) < 0)
+        {
+            if (errno != EINTR)
+            {
+                ICCPD_LOG_ERR(__FUNCTION__, "poll error: %s", strerror(errno));
+                usleep(100000);
+            }
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            if (read(g_ingest_ctl_fd, &val, sizeof(val)) < 0)
+                val = 0;
+        }
+        if (fds[1].revents & (POLLIN | POLLERR))
+            iccp_ingest_route_recv(sys);
+        if (fds[2].revents & POLLIN)
+            iccp_ingest_arp_recv(sys);
+        if (fds[3].revents & POLLIN)
+            iccp_ingest_ndisc_recv(sys);
+    }
+
+    return NULL;
+}
+
+/*****************************************
+* Tool : Start the ingest thread. If it can
+*        not run, the sockets stay in the
+*        main loop as before.
+*
+* ***************************************/
+int iccp_ingest_init(struct System* sys)
+{
+    if (g_ingest_running)
+        return 0;
+
+    if (sys == NULL || sys->route_event_sock == NULL)
+        return MCLAG_ERROR;
+
+    iccp_ingest_ring_init();
+
+    g_ingest_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    g_ingest_ctl_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (g_ingest_event_fd < 0 || g_ingest_ctl_fd < 0)
+        goto err;
+
+    g_ingest_stop = 0;
+    if (pthread_create(&g_ingest_thread, NULL, iccp_ingest_thread_main, sys) != 0)
+        goto err;
+
+    g_ingest_running = 1;
+    ICCPD_LOG_INFO(__FUNCTION__, "Netlink ingest thread started");
+
+    return 0;
+
+err:
+    ICCPD_LOG_WARN(__FUNCTION__, "Failed to start the netlink ingest thread, events handled in the main loop");
+    if (g_ingest_event_fd >= 0)
+        close(g_ingest_event_fd);
+    if (g_ingest_ctl_fd >= 0)
+        close(g_ingest_ctl_fd);
+    g_ingest_event_fd = -1;
+    g_ingest_ctl_fd = -1;
+
+    return MCLAG_ERROR;
+}
+
+/* Stop the thread before its sockets are closed */
+void iccp_ingest_finalize()
+{
+    struct iccp_ingest_event ev;
+    uint64_t val = 1;
+
+    if (!g_ingest_running)
+        return;
+
+    g_ingest_stop = 1;
+    if (write(g_ingest_ctl_fd, &val, sizeof(val)) < 0)
+        ICCPD_LOG_WARN(__FUNCTION__, "Failed to wake the ingest thread");
+    pthread_join(g_ingest_thread, NULL);
+    g_ingest_running = 0;
+
+    while (iccp_ingest_ring_pop(&ev))
+    {
+        if (ev.msg)
+            nlmsg_free(ev.msg);
+    }
+
+    close(g_ingest_event_fd);
+    close(g_ingest_ctl_fd);
+    g_ingest_event_fd = -1;
+    g_ingest_ctl_fd = -1;
+
+    return;
+}
+
+int iccp_ingest_running()
+{
+    return g_ingest_running;
+}
+
+int iccp_ingest_get_fd(struct System* sys)
+{
+    return g_ingest_running ? g_ingest_event_fd : -1;
+}
+
+/* Ask the ingest thread for a kernel neighbor dump */
+void iccp_ingest_neigh_dump_request()
+{
+    uint64_t val = 1;
+
+    __atomic_store_n(&g_ingest_dump_request, 1, __ATOMIC_RELEASE);
+    if (write(g_ingest_ctl_fd, &val, sizeof(val)) < 0)
+        ICCPD_LOG_WARN(__FUNCTION__, "Failed to wake the ingest thread");
+
+    return;
+}
+
+static uint32_t iccp_ingest_key_hash(const struct iccp_ingest_key* key)
+{
+    const uint8_t* p = (const uint8_t*)key;
+    uint32_t hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < sizeof(*key); i++)
+        hash = (hash ^ p[i]) * 16777619u;
+
+    return hash;
+}
+
+static int iccp_ingest_is_link(const struct iccp_ingest_key* key)
+{
+    return key->type == ICCP_INGEST_NETLINK
+           && (key->msg_type == RTM_NEWLINK || key->msg_type == RTM_DELLINK);
+}
+
+/* Per interface, the next link event and the next event of any kind */
+struct iccp_ingest_if_next
+{
+    uint32_t ifindex;
+    int16_t link;
+    int16_t any;
+};
+
+/* Mark the events of the batch superseded by a later event with the same
+ * key. Neighbors depend on their link, so a neighbor event is not dropped
+ * across a link event of its interface and a link event is not dropped
+ * across any event of its interface. Events without a key are not
+ * coalesced across. The order of the events kept does not change. */
+static void iccp_ingest_coalesce(struct iccp_ingest_event* batch, uint8_t* dropped, int count)
+{
+    /* index + 1 of the next event with the key */
+    static int16_t table[ICCP_INGEST_HASH_SIZE];
+    static struct iccp_ingest_if_next if_table[ICCP_INGEST_HASH_SIZE];
+    struct iccp_ingest_if_next* ifn;
+    uint32_t ifindex;
+    uint32_t h;
+    int barrier = count;
+    int next;
+    int i;
+
+    memset(table, 0, sizeof(table));
+    memset(if_table, 0, sizeof(if_table));
+
+    for (i = count - 1; i >= 0; i--)
+    {
+        dropped[i] = 0;
+        if (!batch[i].coalesce)
+        {
+            barrier = i;
+            continue;
+        }
+
+        h = iccp_ingest_key_hash(&batch[i].key) & (ICCP_INGEST_HASH_SIZE - 1);
+        while (table[h] && memcmp(&batch[table[h] - 1].key, &batch[i].key, sizeof(batch[i].key)) != 0)
+            h = (h + 1) & (ICCP_INGEST_HASH_SIZE - 1);
+        next = table[h] - 1;
+        table[h] = i + 1;
+
+        ifindex = batch[i].key.ifindex;
+        ifn = &if_table[(ifindex * 2654435761u) & (ICCP_INGEST_HASH_SIZE - 1)];
+        while (ifn->any && ifn->ifindex != ifindex)
+        {
+            if (++ifn == &if_table[ICCP_INGEST_HASH_SIZE])
+                ifn = if_table;
+        }
+
+        if (next >= 0 && next < barrier)
+        {
+            if (iccp_ingest_is_link(&batch[i].key))
+                dropped[i] = (ifn->any - 1 == next);
+            else
+                dropped[i] = (!ifn->link || ifn->link - 1 > next);
+        }
+
+        ifn->ifindex = ifindex;
+        ifn->any = i + 1;
+        if (iccp_ingest_is_link(&batch[i].key))
+            ifn->link = i + 1;
+    }
+
+    return;
+}
+
+static void iccp_ingest_dispatch(struct iccp_ingest_event* ev, int dropped)
+{
+    struct nlmsghdr* nlh = NULL;
+    unsigned int addr;
+
+    switch (ev->key.type)
+    {
+        case ICCP_INGEST_NETLINK:
+            if (dropped)
+            {
+                /* counted as received all the same */
+                nlh = nlmsg_hdr(ev->msg);
+                system_update_netlink_counters(nlh->nlmsg_type, nlh);
+            }
+            else
+            {
+                iccp_netlink_route_msg_handler(ev->msg);
+            }
+            nlmsg_free(ev->msg);
+            break;
+
+        case ICCP_INGEST_ARP:
+            if (dropped || !system_get_first_csm())
+                break;
+            memcpy(&addr, ev->key.addr, 4);
+            do_arp_update_from_reply_packet(ev->key.ifindex, addr, ev->mac_addr);
+            break;
+
+        case ICCP_INGEST_NDISC:
+            if (dropped || !system_get_first_csm())
+                break;
+            do_ndisc_update_from_reply_packet(ev->key.ifindex, (char *)ev->key.addr, ev->mac_addr);
+            break;
+
+        case ICCP_INGEST_RESYNC:
+            iccp_netlink_route_sock_error();
+            break;
+
+        default:
+            break;
+    }
+
+    return;
+}
+
+/*****************************************
+* Tool : Apply the events queued by the
+*        ingest thread, main loop. At most
+*        ICCP_INGEST_BUDGET per pass.
+*
+* ***************************************/
+int iccp_ingest_event_handler(struct System* sys)
+{
+    static struct iccp_ingest_event batch[ICCP_INGEST_BUDGET];
+    static uint8_t dropped[ICCP_INGEST_BUDGET];
+    struct iccp_ingest_slot* slot;
+    uint64_t val;
+    int count = 0;
+    int i;
+
+    /* cleared before the ring is read, a later push signals again */
+    __atomic_store_n(&g_ingest_wakeup, 0, __ATOMIC_SEQ_CST);
+    if (read(g_ingest_event_fd, &val, sizeof(val)) < 0)
+        val = 0;
+
+    while (count < ICCP_INGEST_BUDGET && iccp_ingest_ring_pop(&batch[count]))
+        count++;
+
+    iccp_ingest_coalesce(batch, dropped, count);
+
+    for (i = 0; i < count; i++)
+    {
+        iccp_ingest_dispatch(&batch[i], dropped[i]);
+        if (dropped[i])
+            g_ingest_coalesced_count++;
+    }
+    g_ingest_event_count += count;
+
+    /* budget used up, keep the event fd readable for the next pass */
+    slot = &g_ingest_ring[g_ingest_ring_tail & (ICCP_INGEST_RING_SIZE - 1)];
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == g_ingest_ring_tail + 1)
+        iccp_ingest_wakeup();
+
+    return 0;
+}
+
+void iccp_ingest_dbg_counters(struct system_dbg_counter_info* counters)
+{
+    counters->ingest_event_counter = g_ingest_event_count;
+    counters->ingest_coalesced_counter = g_ingest_coalesced_count;
+    counters->ingest_ring_full_counter = __atomic_load_n(&g_ingest_ring_full_count, __ATOMIC_RELAXED);
+}
@@ -58,6 +58,7 @@
 #include "../include/iccp_netlink.h"
 #include "../include/mlacp_sync_update.h"
 #include "../include/mlacp_tlv.h"
+#include "../include/iccp_ingest.h"
 
 /**
  * SECTION: Netlink helpers
@@ -501,18 +502,7 @@ void iccp_set_interface_ipadd_mac(struct LocalInterface *lif, char * mac_addr )
 
     /*send msg*/
     if (sys->sync_fd)
-    {
-        if (write(sys->sync_fd,msg_buf, msg_hdr->len) == -1)
-        {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_ERR);
-        }
-        else
-        {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_OK);
-        }
-    }
+        iccp_send_to_mclagsyncd(msg_hdr->type, msg_buf, msg_hdr->len);
     return;
 }
 
@@ -824,15 +814,200 @@ void recover_if_ipmac_on_standby(struct LocalInterface *lif_po, int dir)
     return;
 }
 
-int iccp_netlink_neighbor_request(int family, uint8_t *addr, int add, uint8_t *mac, char *portname, int permanent, int dir)
+/*****************************************
+* Neighbor batching
+*
+* Neighbor add/del requests are packed into one buffer and written with a
+* single sendto() on a socket of their own, so the ACKs can be collected
+* later without mixing with the synchronous requests on route_sock.
+* ***************************************/
+#define ICCP_NEIGH_BATCH_MAX        64
+#define ICCP_NEIGH_BATCH_BUF_SIZE   (16 * 1024)
+
+struct iccp_neigh_batch_req
+{
+    int family;
+    uint8_t addr[16];
+    int add;
+    int dir;
+    int peer_sync;                  /* add of an entry synced from the peer */
+    int peer_ack;                   /* -1 or is_ipv6_ll of the ACK to send */
+    char ifname[MAX_L_PORT_NAME];
+};
+
+static struct nl_sock *g_iccp_neigh_sock = NULL;
+static char g_iccp_neigh_batch_buf[ICCP_NEIGH_BATCH_BUF_SIZE];
+static size_t g_iccp_neigh_batch_len = 0;
+static struct iccp_neigh_batch_req g_iccp_neigh_batch_req[ICCP_NEIGH_BATCH_MAX];
+static int g_iccp_neigh_batch_count = 0;
+
+static struct nl_sock *iccp_netlink_neigh_sock_get()
+{
+    if (g_iccp_neigh_sock)
+        return g_iccp_neigh_sock;
+
+    g_iccp_neigh_sock = nl_socket_alloc();
+    if (!g_iccp_neigh_sock)
+        return NULL;
+
+    if (nl_connect(g_iccp_neigh_sock, NETLINK_ROUTE) < 0)
+    {
+        ICCPD_LOG_ERR(__FUNCTION__, "Failed to connect netlink neighbor socket");
+        nl_socket_free(g_iccp_neigh_sock);
+        g_iccp_neigh_sock = NULL;
+    }
+
+    return g_iccp_neigh_sock;
+}
+
+/* Drop the socket after a send or receive failure, pending ACKs can no
+ * longer be matched to their requests */
+static void iccp_netlink_neigh_sock_reset()
+{
+    if (g_iccp_neigh_sock)
+        nl_socket_free(g_iccp_neigh_sock);
+    g_iccp_neigh_sock = NULL;
+    g_iccp_neigh_batch_len = 0;
+    g_iccp_neigh_batch_count = 0;
+}
+
+/* Complete a neighbor add synced from the peer. The peer only gets its
+ * ACK once the kernel has the entry. If the kernel refused it, the entry
+ * is dropped from the ARP/ND list again, so the list keeps matching the
+ * kernel and the peer's next sync of the entry retries it. */
+static void iccp_netlink_neigh_peer_sync_done(struct iccp_neigh_batch_req *req, int err)
+{
+    struct System *sys = NULL;
+    struct CSM *csm = NULL;
+    struct Msg *msg = NULL;
+    struct ARPMsg *arp_msg = NULL;
+    struct NDISCMsg *ndisc_msg = NULL;
+
+    if (!req->peer_sync)
+        return;
+
+    if (err >= 0)
+    {
+        if (req->peer_ack >= 0)
+        {
+            ICCPD_LOG_DEBUG(__FUNCTION__, "Sync %s on ACK", (req->family == AF_INET) ? "ARP" : "ND");
+            syn_ack_local_neigh_mac_info_to_peer(req->ifname, req->peer_ack);
+        }
+        return;
+    }
+
+    if (!(sys = system_get_instance()))
+        return;
+
+    LIST_FOREACH(csm, &(sys->csm_list), next)
+    {
+        if (req->family == AF_INET)
+        {
+            msg = mlacp_arp_find(csm, *((uint32_t *)req->addr));
+            if (!msg)
+                continue;
+            arp_msg = (struct ARPMsg *)msg->buf;
+            if (arp_msg->learn_flag != NEIGH_REMOTE || strcmp(arp_msg->ifname, req->ifname) != 0)
+                continue;
+            mlacp_dequeue_arp(csm, msg);
+        }
+        else
+        {
+            msg = mlacp_ndisc_find(csm, req->addr);
+            if (!msg)
+                continue;
+            ndisc_msg = (struct NDISCMsg *)msg->buf;
+            if (ndisc_msg->learn_flag != NEIGH_REMOTE || strcmp(ndisc_msg->ifname, req->ifname) != 0)
+                continue;
+            mlacp_dequeue_ndisc(csm, msg);
+        }
+
+        iccp_csm_free_msg(msg);
+        ICCPD_LOG_NOTICE(__FUNCTION__, "Kernel refused peer %s entry(ip:%s, intf:%s), removed, err = %d",
+            (req->family == AF_INET) ? "ARP" : "ND",
+            (req->family == AF_INET) ? show_ip_str(*((int *)req->addr)) : show_ipv6_str((char *)req->addr),
+            req->ifname, err);
+    }
+}
+
+/* Send the queued neighbor requests and check their ACKs */
+int iccp_netlink_neighbor_flush()
+{
+    /* completions may queue again, work on a copy of the batch */
+    struct iccp_neigh_batch_req batch[ICCP_NEIGH_BATCH_MAX];
+    struct iccp_neigh_batch_req *req = NULL;
+    int count = g_iccp_neigh_batch_count;
+    int fail = 0;
+    int err = 0;
+    int i;
+
+    if (count == 0 || !g_iccp_neigh_sock)
+        return 0;
+
+    memcpy(batch, g_iccp_neigh_batch_req, count * sizeof(struct iccp_neigh_batch_req));
+
+    err = nl_sendto(g_iccp_neigh_sock, g_iccp_neigh_batch_buf, g_iccp_neigh_batch_len);
+    if (err < 0)
+    {
+        ICCPD_LOG_ERR(__FUNCTION__, "Failed to send %d neighbor requests, err = %d", count, err);
+        iccp_netlink_neigh_sock_reset();
+        for (i = 0; i < count; i++)
+            iccp_netlink_neigh_peer_sync_done(&batch[i], err);
+        return err;
+    }
+
+    g_iccp_neigh_batch_len = 0;
+    g_iccp_neigh_batch_count = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        req = &batch[i];
+        err = nl_wait_for_ack(g_iccp_neigh_sock);
+        if (err == -NLE_SEQ_MISMATCH)
+        {
+            /* the outcome of the rest is unknown, do not ACK them */
+            ICCPD_LOG_ERR(__FUNCTION__, "Neighbor ACK out of sequence, %d requests unchecked", count - i);
+            iccp_netlink_neigh_sock_reset();
+            for (; i < count; i++)
+                iccp_netlink_neigh_peer_sync_done(&batch[i], err);
+            return err;
+        }
+
+        iccp_netlink_neigh_peer_sync_done(req, err);
+
+        if (err < 0)
+        {
+            ++fail;
+            ICCPD_LOG_DEBUG(__FUNCTION__, "%s neigh error, entry(ip:%s, intf:%s), dir %d, err = %d",
+                req->add ? "add" : "del",
+                (req->family == AF_INET) ? show_ip_str(*((int *)req->addr)) : show_ipv6_str((char *)req->addr),
+                req->ifname, req->dir, err);
+        }
+    }
+
+    if (fail)
+        ICCPD_LOG_NOTICE(__FUNCTION__, "%d of %d neighbor requests failed", fail, count);
+
+    return fail ? MCLAG_ERROR : 0;
+}
+
+/* Queue a neighbor add/del for the kernel. Kernel errors are reported
+ * by iccp_netlink_neighbor_flush(), which runs once per scheduler pass
+ * or when the batch is full */
+static int iccp_netlink_neighbor_queue(int family, uint8_t *addr, int add, uint8_t *mac, char *portname,
+                                       int permanent, int dir, int peer_sync, int peer_ack)
 {
     struct System *sys = NULL;
     struct rtnl_neigh *neigh = NULL;
     struct nl_addr *nl_addr_mac = NULL;
     struct nl_addr *nl_addr_dst = NULL;
     struct LocalInterface *lif = NULL;
-    struct nl_cache *link_cache;
+    struct nl_sock *sock = NULL;
+    struct nl_msg *nlmsg = NULL;
+    struct nlmsghdr *hdr = NULL;
+    struct iccp_neigh_batch_req *req = NULL;
     char mac_str[18] = "";
+    size_t len = 0;
     int err = 0;
 
     if (!(sys = system_get_instance()))
@@ -884,23 +1059,79 @@ int iccp_netlink_neighbor_request(int family, uint8_t *addr, int add, uint8_t *m
     }
 
     if (add)
+        err = rtnl_neigh_build_add_request(neigh, NLM_F_REPLACE | NLM_F_CREATE, &nlmsg);
+    else
+        err = rtnl_neigh_build_delete_request(neigh, 0, &nlmsg);
+
+    if (err < 0)
     {
-        if ((err = rtnl_neigh_add(sys->route_sock, neigh, NLM_F_REPLACE | NLM_F_CREATE)) < 0)
-            ICCPD_LOG_DEBUG(__FUNCTION__, "add neigh error, err = %d", err);
+        ICCPD_LOG_DEBUG(__FUNCTION__, "build %s neigh request error, err = %d", add ? "add" : "del", err);
+        goto errout;
     }
-    else
+
+    if (!(sock = iccp_netlink_neigh_sock_get()))
+    {
+        err = -7;
+        goto errout;
+    }
+
+    hdr = nlmsg_hdr(nlmsg);
+    len = NLMSG_ALIGN(hdr->nlmsg_len);
+    if (len > ICCP_NEIGH_BATCH_BUF_SIZE)
     {
-        if ((err = rtnl_neigh_delete(sys->route_sock, neigh, 0)) < 0)
-            ICCPD_LOG_DEBUG(__FUNCTION__, "del neigh error, err = %d", err);
+        err = -8;
+        goto errout;
     }
 
+    /* Flush before queueing, not after: the caller records the entry
+     * only once this returns, and a failed add must find it to drop it */
+    if (g_iccp_neigh_batch_count >= ICCP_NEIGH_BATCH_MAX
+        || g_iccp_neigh_batch_len + len > ICCP_NEIGH_BATCH_BUF_SIZE)
+    {
+        iccp_netlink_neighbor_flush();
+        if (!(sock = iccp_netlink_neigh_sock_get()))
+        {
+            err = -7;
+            goto errout;
+        }
+    }
+
+    /* Sequence number and ACK flag, ACKs come back in this order */
+    nl_complete_msg(sock, nlmsg);
+    memcpy(g_iccp_neigh_batch_buf + g_iccp_neigh_batch_len, hdr, hdr->nlmsg_len);
+    g_iccp_neigh_batch_len += len;
+
+    req = &g_iccp_neigh_batch_req[g_iccp_neigh_batch_count++];
+    req->family = family;
+    memcpy(req->addr, addr, (family == AF_INET) ? 4 : 16);
+    req->add = add;
+    req->dir = dir;
+    req->peer_sync = peer_sync;
+    req->peer_ack = peer_ack;
+    snprintf(req->ifname, sizeof(req->ifname), "%s", portname);
+
 errout:
+    nlmsg_free(nlmsg);
     nl_addr_put(nl_addr_mac);
     nl_addr_put(nl_addr_dst);
     rtnl_neigh_put(neigh);
     return err;
 }
 
+int iccp_netlink_neighbor_request(int family, uint8_t *addr, int add, uint8_t *mac, char *portname, int permanent, int dir)
+{
+    return iccp_netlink_neighbor_queue(family, addr, add, mac, portname, permanent, dir, 0, -1);
+}
+
+/* Queue the add of a neighbor synced from the peer. Once the kernel has
+ * it, an ACK is sent to the peer if peer_ack is not -1 (it is is_ipv6_ll
+ * of syn_ack_local_neigh_mac_info_to_peer()). If the kernel refuses it,
+ * the caller's ARP/ND list entry is removed again. */
+int iccp_netlink_peer_neighbor_add(int family, uint8_t *addr, uint8_t *mac, char *portname, int permanent, int dir, int peer_ack)
+{
+    return iccp_netlink_neighbor_queue(family, addr, 1, mac, portname, permanent, dir, 1, peer_ack);
+}
+
 void iccp_event_handler_obj_input_newlink(struct nl_object *obj, void *arg)
 {
     struct rtnl_link *link;
@@ -957,7 +1188,7 @@ void iccp_event_handler_obj_input_newlink(struct nl_object *obj, void *arg)
 
     if (lif && (lif->ifindex == -1) && (lif->type == IF_T_VLAN))
     {
-        lif->ifindex = ifindex;
+        local_if_set_ifindex(lif, ifindex);
         lif->state = (op_state == IF_OPER_UP) ? PORT_STATE_UP : PORT_STATE_DOWN;
 
         if (addr_type == AF_LLC)
@@ -1226,8 +1457,8 @@ int iccp_del_self_ip_from_neigh_table (struct LocalInterface *lif, int addr_fami
     struct System *sys = NULL;
     struct CSM *csm = NULL;
     struct Msg *msg = NULL;
-    struct ARPMsg *arp_msg = NULL, *arp_info = NULL;
-    struct NDISCMsg *ndisc_msg = NULL, *ndisc_info = NULL;
+    struct ARPMsg *arp_msg = NULL;
+    struct NDISCMsg *ndisc_msg = NULL;
     int err = 0;
 
     if (!(sys = system_get_instance()))
@@ -1239,20 +1470,12 @@ int iccp_del_self_ip_from_neigh_table (struct LocalInterface *lif, int addr_fami
 
         LIST_FOREACH(csm, &(sys->csm_list), next)
         {
-            TAILQ_FOREACH(msg, &MLACP(csm).arp_list, tail)
-            {
-                arp_info = (struct ARPMsg *)msg->buf;
-                if (arp_info->ipv4_addr == lif->ipv4_addr) {
-                    ICCPD_LOG_NOTICE(__FUNCTION__, " Delete ARP %s", show_ip_str(lif->ipv4_addr));
-                    break;
-                }
-            }
-
+            msg = mlacp_arp_find(csm, lif->ipv4_addr);
             if (msg)
             {
-                TAILQ_REMOVE(&(MLACP(csm).arp_list), msg, tail);
-                free(msg->buf);
-                free(msg);
+                ICCPD_LOG_NOTICE(__FUNCTION__, " Delete ARP %s", show_ip_str(lif->ipv4_addr));
+                mlacp_dequeue_arp(csm, msg);
+                iccp_csm_free_msg(msg);
                 msg = NULL;
                 break;
             }
@@ -1261,21 +1484,12 @@ int iccp_del_self_ip_from_neigh_table (struct LocalInterface *lif, int addr_fami
 
         LIST_FOREACH(csm, &(sys->csm_list), next)
         {
-            TAILQ_FOREACH(msg, &MLACP(csm).ndisc_list, tail)
-            {
-                ndisc_info = (struct NDISCMsg *)msg->buf;
-
-                if (memcmp(&ndisc_info->ipv6_addr, &lif->ipv6_addr, 16) == 0) {
-                    ICCPD_LOG_DEBUG(__FUNCTION__, " Delete neighbor %s", show_ipv6_str((char *)lif->ipv6_addr));
-                    break;
-                }
-            }
-
+            msg = mlacp_ndisc_find(csm, lif->ipv6_addr);
             if (msg)
             {
-                TAILQ_REMOVE(&MLACP(csm).ndisc_list, msg, tail);
-                free(msg->buf);
-                free(msg);
+                ICCPD_LOG_DEBUG(__FUNCTION__, " Delete neighbor %s", show_ipv6_str((char *)lif->ipv6_addr));
+                mlacp_dequeue_ndisc(csm, msg);
+                iccp_csm_free_msg(msg);
                 msg = NULL;
                 break;
             }
@@ -1840,10 +2054,17 @@ succes_return:
 void iccp_system_dinit_netlink_socket()
 {
     struct System* sys = NULL;
+    int i;
 
     if ((sys = system_get_instance()) == NULL )
         return;
 
+    /* shutting down, nothing left to ACK or to drop from the lists */
+    for (i = 0; i < g_iccp_neigh_batch_count; i++)
+        g_iccp_neigh_batch_req[i].peer_sync = 0;
+    iccp_netlink_neighbor_flush();
+    iccp_netlink_neigh_sock_reset();
+
     nl_socket_free(sys->route_event_sock);
     nl_socket_free(sys->route_sock);
     nl_socket_free(sys->genric_event_sock);
@@ -1870,38 +2091,43 @@ static int iccp_netlink_genic_sock_event_handler(struct System *sys)
     return ret;
 }
 
+/* The route event and packet sockets are read here only if the ingest
+ * thread is not running */
 static int iccp_get_netlink_route_sock_event_fd(struct System *sys)
 {
+    if (iccp_ingest_running())
+        return -1;
     return nl_socket_get_fd(sys->route_event_sock);
 }
 
 static int iccp_get_receive_arp_packet_sock_fd(struct System *sys)
 {
+    if (iccp_ingest_running())
+        return -1;
     return sys->arp_receive_fd;
 }
 
 static int iccp_get_receive_ndisc_packet_sock_fd(struct System *sys)
 {
+    if (iccp_ingest_running())
+        return -1;
     return sys->ndisc_receive_fd;
 }
 
-static int iccp_receive_arp_packet_handler(struct System *sys)
+/* Read one ARP packet, returns 1 for a reply worth learning from */
+int iccp_receive_arp_packet(int fd, unsigned int *ifindex, unsigned int *addr, uint8_t *mac_addr)
 {
     unsigned char buf[1024];
     struct sockaddr_ll sll;
     socklen_t sll_len = sizeof(sll);
     struct arphdr *a = (struct arphdr*)buf;
     int n;
-    unsigned int ifindex;
-    unsigned int addr;
-    uint8_t mac_addr[ETHER_ADDR_LEN];
-    struct CSM* csm = NULL;
 
-    n = recvfrom(sys->arp_receive_fd, buf, sizeof(buf), MSG_DONTWAIT,
+    n = recvfrom(fd, buf, sizeof(buf), MSG_DONTWAIT,
                  (struct sockaddr*)&sll, &sll_len);
     if (n < 0)
     {
-        ICCPD_LOG_WARN(__FUNCTION__, "ARP recvfrom error: %s", buf);
+        ICCPD_LOG_WARN(__FUNCTION__, "ARP recvfrom error: %s", strerror(errno));
         return MCLAG_ERROR;
     }
 
@@ -1915,37 +2141,47 @@ static int iccp_receive_arp_packet_handler(struct System *sys)
         sizeof(*a) + 2 * 4 + 2 * a->ar_hln > n)
         return 0;
 
+    *ifindex = sll.sll_ifindex;
+    memcpy(mac_addr,  (char*)(a + 1), ETHER_ADDR_LEN);
+    memcpy(addr, (char*)(a + 1) + a->ar_hln, 4);
+
+    return 1;
+}
+
+static int iccp_receive_arp_packet_handler(struct System *sys)
+{
+    unsigned int ifindex;
+    unsigned int addr;
+    uint8_t mac_addr[ETHER_ADDR_LEN];
+    int ret;
+
+    ret = iccp_receive_arp_packet(sys->arp_receive_fd, &ifindex, &addr, mac_addr);
+    if (ret <= 0)
+        return ret;
+
     /*Check if mclag configured*/
-    csm = system_get_first_csm();
-    if (!csm)
+    if (!system_get_first_csm())
         return 0;
 
-    ifindex = sll.sll_ifindex;
-    memcpy(mac_addr,  (char*)(a + 1), ETHER_ADDR_LEN);
-    memcpy(&addr, (char*)(a + 1) + a->ar_hln, 4);
-
     do_arp_update_from_reply_packet(ifindex, addr, mac_addr);
 
     return 0;
 }
 
-int iccp_receive_ndisc_packet_handler(struct System *sys)
+/* Read one ND packet, returns 1 for a neighbor advertisement */
+int iccp_receive_ndisc_packet(int fd, unsigned int *ifindex, struct in6_addr *target, uint8_t *mac_addr)
 {
     uint8_t buf[4096];
     uint8_t adata[1024];
     struct sockaddr_in6 from;
-    unsigned int ifindex = 0;
     struct msghdr msg;
     struct iovec iov;
     struct cmsghdr *cmsgptr;
     struct nd_msg *ndmsg = NULL;
     struct nd_opt_hdr *nd_opt = NULL;
-    struct in6_addr target;
-    uint8_t mac_addr[ETHER_ADDR_LEN] = { 0 };
     int8_t *opt = NULL;
     int opt_len = 0, l = 0;
     int len;
-    struct CSM* csm = NULL;
 
     /* Fill in message and iovec. */
     msg.msg_name = (void *)(&from);
@@ -1957,7 +2193,7 @@ int iccp_receive_ndisc_packet_handler(struct System *sys)
     iov.iov_base = buf;
     iov.iov_len = 4096;
 
-    len = recvmsg(sys->ndisc_receive_fd, &msg, 0);
+    len = recvmsg(fd, &msg, 0);
 
     if (len < 0)
     {
@@ -1965,6 +2201,7 @@ int iccp_receive_ndisc_packet_handler(struct System *sys)
         return MCLAG_ERROR;
     }
 
+    *ifindex = 0;
     if (msg.msg_controllen >= sizeof(struct cmsghdr))
         for (cmsgptr = CMSG_FIRSTHDR(&msg); cmsgptr != NULL; cmsgptr = CMSG_NXTHDR(&msg, cmsgptr))
         {
@@ -1974,21 +2211,17 @@ int iccp_receive_ndisc_packet_handler(struct System *sys)
                 struct in6_pktinfo *ptr;
 
                 ptr = (struct in6_pktinfo *)CMSG_DATA(cmsgptr);
-                ifindex = ptr->ipi6_ifindex;
+                *ifindex = ptr->ipi6_ifindex;
             }
         }
 
     ndmsg = (struct nd_msg *)buf;
 
-    /*Check if mclag configured*/
-    csm = system_get_first_csm();
-    if (!csm)
-        return 0;
-
     if (ndmsg->icmph.icmp6_type != NDISC_NEIGHBOUR_ADVERTISEMENT)
         return 0;
 
-    memcpy((char *)(&target), (char *)(&ndmsg->target), sizeof(struct in6_addr));
+    memcpy((char *)target, (char *)(&ndmsg->target), sizeof(struct in6_addr));
+    memset(mac_addr, 0, ETHER_ADDR_LEN);
 
     opt = (char *)ndmsg->opt;
 
@@ -2019,6 +2252,24 @@ int iccp_receive_ndisc_packet_handler(struct System *sys)
         }
     }
 
+    return 1;
+}
+
+int iccp_receive_ndisc_packet_handler(struct System *sys)
+{
+    unsigned int ifindex = 0;
+    struct in6_addr target;
+    uint8_t mac_addr[ETHER_ADDR_LEN] = { 0 };
+    int ret;
+
+    ret = iccp_receive_ndisc_packet(sys->ndisc_receive_fd, &ifindex, &target, mac_addr);
+    if (ret <= 0)
+        return ret;
+
+    /*Check if mclag configured*/
+    if (!system_get_first_csm())
+        return 0;
+
     do_ndisc_update_from_reply_packet(ifindex, (char *)&target, mac_addr);
 
     return 0;
@@ -2056,6 +2307,27 @@ void iccp_netlink_sync_again()
     return;
 }
 
+/* Route event message handed over by the ingest thread */
+int iccp_netlink_route_msg_handler(struct nl_msg *msg)
+{
+    return iccp_route_event_handler(msg, NULL);
+}
+
+/* Route event socket overrun seen by the ingest thread, events were lost */
+void iccp_netlink_route_sock_error()
+{
+    struct System* sys = NULL;
+
+    if ((sys = system_get_instance()) == NULL )
+        return;
+
+    sys->need_sync_netlink_again = 1;
+    SYSTEM_INCR_NETLINK_RX_ERROR();
+    iccp_netlink_sync_again();
+
+    return;
+}
+
 static int iccp_netlink_route_sock_event_handler(struct System *sys)
 {
     int ret = 0;
@@ -2084,6 +2356,7 @@ struct iccp_eventfd
 {
     int (*get_fd)(struct System* sys);
     int (*event_handler)(struct System* sys);
+    int source; /* ICCP_SCHED_SRC_* the handler time is charged to */
 };
 /* endcond */
 
@@ -2091,22 +2364,32 @@ static const struct iccp_eventfd iccp_eventfds[] = {
     {
         .get_fd = iccp_get_server_sock_fd,
         .event_handler = scheduler_server_accept,
+        .source = ICCP_SCHED_SRC_OTHER,
     },
     {
         .get_fd = iccp_get_netlink_genic_sock_event_fd,
         .event_handler = iccp_netlink_genic_sock_event_handler,
+        .source = ICCP_SCHED_SRC_NETLINK,
     },
     {
         .get_fd = iccp_get_netlink_route_sock_event_fd,
         .event_handler = iccp_netlink_route_sock_event_handler,
+        .source = ICCP_SCHED_SRC_NETLINK,
     },
     {
         .get_fd = iccp_get_receive_arp_packet_sock_fd,
         .event_handler = iccp_receive_arp_packet_handler,
+        .source = ICCP_SCHED_SRC_PKT,
      },
     {
      .get_fd = iccp_get_receive_ndisc_packet_sock_fd,
      .event_handler = iccp_receive_ndisc_packet_handler,
+     .source = ICCP_SCHED_SRC_PKT,
+    },
+    {
+        .get_fd = iccp_ingest_get_fd,
+        .event_handler = iccp_ingest_event_handler,
+        .source = ICCP_SCHED_SRC_NETLINK,
     }
 };
 
@@ -2138,6 +2421,9 @@ int iccp_init_netlink_event_fd(struct System *sys)
     {
         int fd = iccp_eventfds[i].get_fd(sys);
 
+        if (fd < 0)
+            continue;
+
         event.data.fd = fd;
         event.events = EPOLLIN;
         err = epoll_ctl(efd, EPOLL_CTL_ADD, fd, &event);
@@ -2174,21 +2460,57 @@ int iccp_handle_events(struct System * sys)
     int i;
     int err;
     int max_nfds;
+    int timeout;
+    uint64_t start;
     struct mLACPHeartbeatTLV dummy_tlv;
 
     max_nfds = ICCP_EVENT_FDS_COUNT + sys->readfd_count;
 
-    nfds = epoll_wait(sys->epoll_fd, events, max_nfds, EPOLL_TIMEOUT_MSEC);
+    /* Work left over from the last pass, only poll */
+    timeout = sys->sched_work_pending ? 0 : EPOLL_TIMEOUT_MSEC;
+    sys->sched_work_pending = 0;
+
+    nfds = epoll_wait(sys->epoll_fd, events, max_nfds, timeout);
+
+    /* Peer sockets first, ICCP control and keepalive traffic must not
+     * wait behind netlink or packet bursts of the same pass */
+    for (i = 0; i < nfds; i++)
+    {
+        LIST_FOREACH(csm, &(sys->csm_list), next)
+        {
+            if (csm->sock_fd > 0 && csm->sock_fd == events[i].data.fd)
+                break;
+        }
+
+        if (csm == NULL)
+            continue;
+
+        start = scheduler_time_usec();
+        if (scheduler_csm_read_callback(csm) != MCLAG_ERROR)
+        {
+            //consider any msg from peer as heartbeat update, this will be in scenarios of scaled msg sync b/w peers
+            mlacp_fsm_update_heartbeat(csm, &dummy_tlv);
+        }
+        scheduler_account(sys, ICCP_SCHED_SRC_PEER, start);
+
+        /* handled, skip it in the pass below */
+        events[i].data.fd = -1;
+    }
 
     /* Go over list of event fds and handle them sequentially */
     for (i = 0; i < nfds; i++)
     {
+        if (events[i].data.fd < 0)
+            continue;
+
         for (n = 0; n < ICCP_EVENT_FDS_COUNT; n++)
         {
             const struct iccp_eventfd *eventfd = &iccp_eventfds[n];
             if (events[i].data.fd == eventfd->get_fd(sys))
             {
+                start = scheduler_time_usec();
                 err = eventfd->event_handler(sys);
+                scheduler_account(sys, eventfd->source, start);
                 if (err)
                     ICCPD_LOG_INFO(__FUNCTION__, "Scheduler fd %d handler error %d !", events[i].data.fd, err );
                 break;
@@ -2198,44 +2520,47 @@ int iccp_handle_events(struct System * sys)
         if (n < ICCP_EVENT_FDS_COUNT)
             continue;
 
+        start = scheduler_time_usec();
+
         if (events[i].data.fd == sys->sync_ctrl_fd)
         {
             int client_fd = mclagd_ctl_sock_accept(sys->sync_ctrl_fd);
             if (client_fd > 0)
             {
                 mclagd_ctl_interactive_process(client_fd);
-                close(client_fd);
+                mclagd_ctl_sock_release(client_fd);
             }
+            scheduler_account(sys, ICCP_SCHED_SRC_OTHER, start);
             continue;
         }
 
-        if (events[i].data.fd == sys->sync_fd)
+        /* mclagdctl dump still being written */
+        if (mclagd_ctl_reply_handler(events[i].data.fd))
         {
-            iccp_mclagsyncd_msg_handler(sys);
+            scheduler_account(sys, ICCP_SCHED_SRC_OTHER, start);
             continue;
         }
 
-        if (events[i].data.fd == sys->sig_pipe_r)
+        if (events[i].data.fd == sys->sync_fd)
         {
-            iccp_receive_signal_handler(sys);
-
+            /* a failed drain closes the socket, nothing left to read */
+            if ((events[i].events & EPOLLOUT)
+                && iccp_mclagsyncd_sendq_drain(sys) < 0)
+            {
+                scheduler_account(sys, ICCP_SCHED_SRC_SYNCD, start);
+                continue;
+            }
+            if (events[i].events & ~EPOLLOUT)
+                iccp_mclagsyncd_msg_handler(sys);
+            scheduler_account(sys, ICCP_SCHED_SRC_SYNCD, start);
             continue;
         }
 
-        if (FD_ISSET(events[i].data.fd, &sys->readfd))
+        if (events[i].data.fd == sys->sig_pipe_r)
         {
-            LIST_FOREACH(csm, &(sys->csm_list), next)
-            {
-                if (csm->sock_fd == events[i].data.fd )
-                {
-                    if (scheduler_csm_read_callback(csm) != MCLAG_ERROR)
-                    {
-                        //consider any msg from peer as heartbeat update, this will be in scenarios of scaled msg sync b/w peers
-                        mlacp_fsm_update_heartbeat(csm, &dummy_tlv);
-                    }
-                    break;
-                }
-            }
+            iccp_receive_signal_handler(sys);
+            scheduler_account(sys, ICCP_SCHED_SRC_OTHER, start);
+            continue;
         }
     }
 
@@ -23,7 +23,10 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
 
 #include "../include/cmd_option.h"
 #include "../include/logger.h"
@@ -38,6 +41,48 @@ static uint32_t _iccpd_log_level_map[] =
     LOG_DEBUG
 };
 
+/* Read by the ICCPD_LOG_* macros before any argument is evaluated */
+struct LoggerConfig g_iccpd_log_config =
+{
+    .console_log_enabled = 0,
+    .log_level = NOTICE_LOG_LEVEL,
+    .init = 1,
+};
+
+/* Messages are formatted by the caller into a ring slot and handed to
+ * syslog by the log thread, so a slow syslog never stalls the scheduler.
+ * The ring is a bounded MPSC queue: producers reserve a slot by moving
+ * the head, each slot sequence number tells whose turn it is. */
+struct log_ring_slot
+{
+    uint32_t seq;
+    int level;
+    char buf[LOGBUF_SIZE];
+};
+
+static struct log_ring_slot g_log_ring[LOG_RING_SIZE];
+static uint32_t g_log_ring_head = 0;
+static uint32_t g_log_ring_tail = 0;
+static uint32_t g_log_ring_dropped = 0;
+static sem_t g_log_ring_sem;
+static pthread_t g_log_thread;
+static int g_log_thread_running = 0;
+static volatile int g_log_thread_stop = 0;
+
+/* Per tag rate limit of NOTICE and lower, tags are __FUNCTION__ or literal
+ * pointers. Best effort, a collision resets the slot for the new tag. */
+struct log_ratelimit
+{
+    const char* tag;
+    time_t sec;
+    uint32_t count;
+    uint32_t suppressed;
+};
+
+static struct log_ratelimit g_log_ratelimit[LOG_RATELIMIT_SLOTS];
+/* The ingest thread logs as well */
+static pthread_mutex_t g_log_ratelimit_lock = PTHREAD_MUTEX_INITIALIZER;
+
 char* log_level_to_string(int level)
 {
     switch (level)
@@ -66,16 +111,7 @@ char* log_level_to_string(int level)
 
 struct LoggerConfig* logger_get_configuration()
 {
-    static struct LoggerConfig config;
-
-    if (config.init == 0)
-    {
-        config.console_log_enabled = 0;
-        config.log_level = NOTICE_LOG_LEVEL;
-        config.init = 1;
-    }
-
-    return &config;
+    return &g_iccpd_log_config;
 }
 
 void logger_set_configuration(int log_level)
@@ -88,23 +124,184 @@ void logger_set_configuration(int log_level)
     return;
 }
 
+static void log_ring_init()
+{
+    uint32_t i;
+
+    for (i = 0; i < LOG_RING_SIZE; i++)
+        g_log_ring[i].seq = i;
+
+    g_log_ring_head = 0;
+    g_log_ring_tail = 0;
+
+    return;
+}
+
+/* Reserve the next free slot, NULL if the ring is full */
+static struct log_ring_slot* log_ring_reserve(uint32_t* pos)
+{
+    struct log_ring_slot* slot;
+    uint32_t head;
+    uint32_t seq;
+    int32_t dif;
+
+    head = __atomic_load_n(&g_log_ring_head, __ATOMIC_RELAXED);
+    while (1)
+    {
+        slot = &g_log_ring[head & (LOG_RING_SIZE - 1)];
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        dif = (int32_t)(seq - head);
+
+        if (dif == 0)
+        {
+            if (__atomic_compare_exchange_n(&g_log_ring_head, &head, head + 1, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                *pos = head;
+                return slot;
+            }
+        }
+        else if (dif < 0)
+        {
+            return NULL;
+        }
+        else
+        {
+            head = __atomic_load_n(&g_log_ring_head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void log_ring_publish(struct log_ring_slot* slot, uint32_t pos)
+{
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    sem_post(&g_log_ring_sem);
+
+    return;
+}
+
+/* Hand every published message to syslog, log thread only */
+static void log_ring_drain()
+{
+    struct log_ring_slot* slot;
+    uint32_t dropped;
+
+    while (1)
+    {
+        slot = &g_log_ring[g_log_ring_tail & (LOG_RING_SIZE - 1)];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != g_log_ring_tail + 1)
+            break;
+
+        ICCPD_UTILS_SYSLOG(_iccpd_log_level_map[slot->level], "%s", slot->buf);
+
+        __atomic_store_n(&slot->seq, g_log_ring_tail + LOG_RING_SIZE, __ATOMIC_RELEASE);
+        g_log_ring_tail++;
+    }
+
+    dropped = __atomic_exchange_n(&g_log_ring_dropped, 0, __ATOMIC_RELAXED);
+    if (dropped)
+        ICCPD_UTILS_SYSLOG(LOG_WARNING, "[logger.WARN] %u log messages dropped, ring full", dropped);
+
+    return;
+}
+
+static void* log_thread_main(void* arg)
+{
+    while (!g_log_thread_stop)
+    {
+        sem_wait(&g_log_ring_sem);
+        log_ring_drain();
+    }
+
+    log_ring_drain();
+
+    return NULL;
+}
+
 void log_init(struct CmdOptionParser* parser)
 {
     struct LoggerConfig* config = logger_get_configuration();
 
     config->console_log_enabled = parser->console_log;
+
+    if (g_log_thread_running)
+        return;
+
+    log_ring_init();
+    if (sem_init(&g_log_ring_sem, 0, 0) < 0)
+        return;
+
+    g_log_thread_stop = 0;
+    if (pthread_create(&g_log_thread, NULL, log_thread_main, NULL) != 0)
+    {
+        sem_destroy(&g_log_ring_sem);
+        return;
+    }
+
+    g_log_thread_running = 1;
+    atexit(log_finalize);
+
+    return;
 }
 
+/* Stop the log thread once everything queued is written */
 void log_finalize()
 {
-    /*do nothing*/
+    if (!g_log_thread_running)
+        return;
+
+    g_log_thread_running = 0;
+    g_log_thread_stop = 1;
+    sem_post(&g_log_ring_sem);
+    pthread_join(g_log_thread, NULL);
+    sem_destroy(&g_log_ring_sem);
+
+    return;
+}
+
+/* Returns 0 if the tag is over its budget for this second. The first
+ * message of a new second reports how many were suppressed. */
+static int log_ratelimit_check(const char* tag, uint32_t* suppressed)
+{
+    struct log_ratelimit* rl;
+    time_t now = time(NULL);
+    int ret = 1;
+
+    rl = &g_log_ratelimit[((uintptr_t)tag >> 3) & (LOG_RATELIMIT_SLOTS - 1)];
+
+    pthread_mutex_lock(&g_log_ratelimit_lock);
+
+    *suppressed = 0;
+    if (rl->tag != tag || rl->sec != now)
+    {
+        if (rl->tag == tag)
+            *suppressed = rl->suppressed;
+        rl->tag = tag;
+        rl->sec = now;
+        rl->count = 0;
+        rl->suppressed = 0;
+    }
+
+    if (++rl->count > LOG_RATELIMIT_BURST)
+    {
+        rl->suppressed++;
+        ret = 0;
+    }
+
+    pthread_mutex_unlock(&g_log_ratelimit_lock);
+
+    return ret;
 }
 
 void write_log(int level, const char* tag, const char* format, ...)
 {
     struct LoggerConfig* config = logger_get_configuration();
-    char buf[LOGBUF_SIZE];
+    struct log_ring_slot* slot = NULL;
+    char local_buf[LOGBUF_SIZE];
+    char* buf;
     va_list args;
+    uint32_t pos = 0;
+    uint32_t suppressed = 0;
     unsigned int   prefix_len;
     unsigned int   avbl_buf_len;
     unsigned int   print_len;
@@ -117,7 +314,32 @@ void write_log(int level, const char* tag, const char* format, ...)
     if (level > config->log_level)
         return;
 
-    prefix_len = snprintf(buf, LOGBUF_SIZE, "[%s.%s] ", tag, log_level_to_string(level));
+    /* tags are shared by many call sites, a noisy one must not hide errors */
+    if (level > WARN_LOG_LEVEL && !log_ratelimit_check(tag, &suppressed))
+        return;
+
+    if (g_log_thread_running)
+    {
+        slot = log_ring_reserve(&pos);
+        if (!slot)
+        {
+            __atomic_add_fetch(&g_log_ring_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        buf = slot->buf;
+        slot->level = level;
+    }
+    else
+    {
+        buf = local_buf;
+    }
+
+    if (suppressed)
+        prefix_len = snprintf(buf, LOGBUF_SIZE, "[%s.%s] (%u suppressed) ", tag, log_level_to_string(level), suppressed);
+    else
+        prefix_len = snprintf(buf, LOGBUF_SIZE, "[%s.%s] ", tag, log_level_to_string(level));
+    if (prefix_len >= LOGBUF_SIZE)
+        prefix_len = LOGBUF_SIZE - 1;
     avbl_buf_len = LOGBUF_SIZE - prefix_len;
 
     va_start(args, format);
@@ -127,14 +349,17 @@ void write_log(int level, const char* tag, const char* format, ...)
     /* Since osal_vsnprintf doesn't always return the exact size written to the buffer,
      * we must check if the user string length exceeds the remaing buffer size.
      */
-    if (print_len > avbl_buf_len)
+    if (print_len >= avbl_buf_len)
     {
-        print_len = avbl_buf_len;
+        print_len = avbl_buf_len - 1;
     }
 
     buf[prefix_len + print_len] = '\0';
-    ICCPD_UTILS_SYSLOG(_iccpd_log_level_map[level], "%s", buf);
+
+    if (slot)
+        log_ring_publish(slot, pos);
+    else
+        ICCPD_UTILS_SYSLOG(_iccpd_log_level_map[level], "%s", buf);
 
     return;
 }
-
@@ -38,14 +38,18 @@
 static int mclagdctl_sock_fd = -1;
 char *mclagdctl_sock_path = "/var/run/iccpd/mclagdctl.sock";
 
+/* Dump filters, applied by iccpd before the reply is built */
+static int mclagdctl_filter_vid = 0;
+static char mclagdctl_filter_ifname[MCLAGDCTL_PARA2_LEN] = { 0 };
+
 /*
    Already implemented command:
    mclagdctl -i dump state
-   mclagdctl -i dump arp
-   mclagdctl -i dump nd
-   mclagdctl -i dump mac
+   mclagdctl -i dump arp [-p port]
+   mclagdctl -i dump nd [-p port]
+   mclagdctl -i dump mac [-v vlan-id] [-p port]
    mclagdctl -i dump unique_ip
-   mclagdctl -i dump portlist local
+   mclagdctl -i dump portlist local [-p port]
    mclagdctl -i dump portlist peer
  */
 
@@ -346,6 +350,7 @@ int mclagdctl_enca_dump_arp(char *msg, int mclag_id, int argc, char **argv)
     memset(&req, 0, sizeof(struct mclagdctl_req_hdr));
     req.info_type = INFO_TYPE_DUMP_ARP;
     req.mclag_id = mclag_id;
+    snprintf(req.para1, sizeof(req.para1), "%s", mclagdctl_filter_ifname);
     memcpy((struct mclagdctl_req_hdr *)msg, &req, sizeof(struct mclagdctl_req_hdr));
 
     return 1;
@@ -364,6 +369,7 @@ int mclagdctl_enca_dump_ndisc(char *msg, int mclag_id, int argc, char **argv)
     memset(&req, 0, sizeof(struct mclagdctl_req_hdr));
     req.info_type = INFO_TYPE_DUMP_NDISC;
     req.mclag_id = mclag_id;
+    snprintf(req.para1, sizeof(req.para1), "%s", mclagdctl_filter_ifname);
     memcpy((struct mclagdctl_req_hdr *)msg, &req, sizeof(struct mclagdctl_req_hdr));
 
     return 1;
@@ -461,6 +467,9 @@ int mclagdctl_enca_dump_mac(char *msg, int mclag_id, int argc, char **argv)
     memset(&req, 0, sizeof(struct mclagdctl_req_hdr));
     req.info_type = INFO_TYPE_DUMP_MAC;
     req.mclag_id = mclag_id;
+    snprintf(req.para1, sizeof(req.para1), "%s", mclagdctl_filter_ifname);
+    if (mclagdctl_filter_vid > 0)
+        snprintf(req.para2, sizeof(req.para2), "%d", mclagdctl_filter_vid);
     memcpy((struct mclagdctl_req_hdr *)msg, &req, sizeof(struct mclagdctl_req_hdr));
 
     return 1;
@@ -529,6 +538,7 @@ int mclagdctl_enca_dump_local_portlist(char *msg, int mclag_id, int argc, char *
     memset(&req, 0, sizeof(struct mclagdctl_req_hdr));
     req.info_type = INFO_TYPE_DUMP_LOCAL_PORTLIST;
     req.mclag_id = mclag_id;
+    snprintf(req.para1, sizeof(req.para1), "%s", mclagdctl_filter_ifname);
     memcpy((struct mclagdctl_req_hdr *)msg, &req, sizeof(struct mclagdctl_req_hdr));
 
     return 1;
@@ -831,6 +841,8 @@ int mclagdctl_parse_dump_dbg_counters(char *msg, int data_len)
     system_dbg_counter_info_t *sys_counter_p;
     mlacp_dbg_counter_info_t  *iccp_counter_p;
     int                       i, j;
+    static const char         *sched_src_names[ICCP_SCHED_SRC_MAX] = {
+        "Peer", "Netlink", "MclagSyncd", "ARP/ND packet", "FSM", "Other" };
 
     dbg_counter_p = (mclagd_dbg_counter_info_t *)msg;
     sys_counter_p = (system_dbg_counter_info_t *)&dbg_counter_p->system_dbg;
@@ -905,6 +917,12 @@ int mclagdctl_parse_dump_dbg_counters(char *msg, int data_len)
                 iccp_counter_p->iccp_counters[j][0][1],
                 iccp_counter_p->iccp_counters[j][1][1]);
         }
+        fprintf(stdout, "%-20s%lu\n", "Tx queued msgs:", iccp_counter_p->tx_queue_msgs);
+        fprintf(stdout, "%-20s%lu\n", "Tx writes:", iccp_counter_p->tx_writes);
+        fprintf(stdout, "%-20s%lu\n", "Tx bytes/write:",
+            iccp_counter_p->tx_writes ? iccp_counter_p->tx_write_bytes / iccp_counter_p->tx_writes : 0);
+        fprintf(stdout, "%-20s%lu\n", "Tx write error:", iccp_counter_p->tx_write_err);
+        fprintf(stdout, "%-20s%u\n", "Tx queue max bytes:", iccp_counter_p->tx_queue_max_len);
         fprintf(stdout, "\n");
     }
     /* Netlink counters */
@@ -921,6 +939,53 @@ int mclagdctl_parse_dump_dbg_counters(char *msg, int data_len)
         sys_counter_p->newaddr_count, sys_counter_p->deladdr_count);
     fprintf(stdout, "Unexpected message type: %u\n", sys_counter_p->unknown_type_count);
     fprintf(stdout, "Receive error: %u\n\n", sys_counter_p->rx_error_count);
+
+    /* Object pool counters */
+    fprintf(stdout, "%-20s%-12s%-12s%-12s%-20s%-20s%-12s\n",
+        "Object Pool", "IN_USE", "FREE", "SLABS", "ALLOC", "FREED", "ALLOC_FAIL");
+    fprintf(stdout, "%-20s%-12s%-12s%-12s%-20s%-20s%-12s\n",
+        "-----------", "------", "----", "-----", "-----", "-----", "----------");
+    for (i = 0; i < ICCP_POOL_MAX; ++i)
+    {
+        fprintf(stdout, "%-20s%-12u%-12u%-12u%-20lu%-20lu%-12u\n",
+            (i == ICCP_POOL_MSG) ? "Msg" : "MACMsg",
+            sys_counter_p->pool_counters[i].in_use,
+            sys_counter_p->pool_counters[i].free,
+            sys_counter_p->pool_counters[i].slabs,
+            sys_counter_p->pool_counters[i].allocs,
+            sys_counter_p->pool_counters[i].frees,
+            sys_counter_p->pool_counters[i].alloc_fail);
+    }
+    fprintf(stdout, "Msg large buffers: %lu\n\n", sys_counter_p->msg_large_buf_counter);
+
+    /* Scheduler per source processing time */
+    fprintf(stdout, "%-20s%-20s%-20s%-12s\n",
+        "Scheduler Source", "RUNS", "TOTAL_USEC", "MAX_USEC");
+    fprintf(stdout, "%-20s%-20s%-20s%-12s\n",
+        "----------------", "----", "----------", "--------");
+    for (i = 0; i < ICCP_SCHED_SRC_MAX; ++i)
+    {
+        fprintf(stdout, "%-20s%-20lu%-20lu%-12u\n",
+            sched_src_names[i],
+            sys_counter_p->sched_counters[i].runs,
+            sys_counter_p->sched_counters[i].total_usec,
+            sys_counter_p->sched_counters[i].max_usec);
+    }
+    fprintf(stdout, "mLACP msg budget exceeded: %lu\n\n", sys_counter_p->sched_budget_exceeded_counter);
+
+    fprintf(stdout, "Netlink ingest events: %lu, coalesced: %lu, ring full: %lu\n\n",
+        sys_counter_p->ingest_event_counter,
+        sys_counter_p->ingest_coalesced_counter,
+        sys_counter_p->ingest_ring_full_counter);
+
+    fprintf(stdout, "MAC updates held: %lu, suppressed: %lu, FDB batch coalesced: %lu\n\n",
+        sys_counter_p->mac_coalesce_held_counter,
+        sys_counter_p->mac_coalesce_suppressed_counter,
+        sys_counter_p->fdb_batch_coalesced_counter);
+
+    fprintf(stdout, "Port isolation updates sent: %lu, unchanged skipped: %lu\n\n",
+        sys_counter_p->isolate_update_sent_counter,
+        sys_counter_p->isolate_update_skipped_counter);
     return 0;
 }
 
@@ -1066,7 +1131,9 @@ static void mclagdctl_print_help(const char *argv0)
     fprintf(stdout, "%s [options] command [command args]\n"
             "    -h --help                Show this help\n"
             "    -i --mclag-id            Specify one mclag id\n"
-            "    -l --level               Specify log level     critical,err,warn,notice,info,debug\n",
+            "    -l --level               Specify log level     critical,err,warn,notice,info,debug\n"
+            "    -v --vlan                Only dump MACs of this vlan\n"
+            "    -p --port                Only dump entries of this interface\n",
             argv0);
     fprintf(stdout, "Commands:\n");
 
@@ -1095,6 +1162,8 @@ int main(int argc, char **argv)
         { "help",      no_argument,             NULL,        'h' },
         { "mclag id",  required_argument,       NULL,        'i' },
         { "log level", required_argument,       NULL,        'l' },
+        { "vlan",      required_argument,       NULL,        'v' },
+        { "port",      required_argument,       NULL,        'p' },
         { NULL,        0,                       NULL,        0   }
     };
     int opt;
@@ -1107,7 +1176,7 @@ int main(int argc, char **argv)
     char *data;
     struct mclagd_reply_hdr *reply;
 
-    while ((opt = getopt_long(argc, argv, "hi:l:", long_options, NULL)) >= 0)
+    while ((opt = getopt_long(argc, argv, "hi:l:v:p:", long_options, NULL)) >= 0)
     {
         switch (opt)
         {
@@ -1153,6 +1222,14 @@ int main(int argc, char **argv)
             }
             break;
 
+            case 'v':
+                mclagdctl_filter_vid = atoi(optarg);
+                break;
+
+            case 'p':
+                snprintf(mclagdctl_filter_ifname, sizeof(mclagdctl_filter_ifname), "%s", optarg);
+                break;
+
             case '?':
                 fprintf(stderr, "unknown option.\n");
                 mclagdctl_print_help(argv0);
@@ -55,8 +55,7 @@
         while (!TAILQ_EMPTY(&(list))) { \
             msg = TAILQ_FIRST(&(list)); \
             TAILQ_REMOVE(&(list), msg, tail); \
-            free(msg->buf); \
-            free(msg); \
+            iccp_csm_free_msg(msg); \
         } \
         TAILQ_INIT(&(list)); \
     }
@@ -68,7 +67,7 @@
             mac_msg = TAILQ_FIRST(&(list)); \
             TAILQ_REMOVE(&(list), mac_msg, tail); \
             if (mac_msg->op_type == MAC_SYNC_DEL) \
-                free(mac_msg); \
+                iccp_csm_free_mac_msg(mac_msg); \
         } \
         TAILQ_INIT(&(list)); \
     }
@@ -144,6 +143,7 @@ RB_GENERATE(mac_rb_tree, MACMsg, mac_entry_rb, MACMsg_compare);
 char *mlacp_state(struct CSM* csm);
 static void mlacp_resync_arp(struct CSM* csm);
 static void mlacp_resync_ndisc(struct CSM *csm);
+static void mlacp_mac_digest_reconcile(struct CSM* csm, int full);
 /* Sync Sender APIs*/
 static void mlacp_sync_send_sysConf(struct CSM* csm);
 static void mlacp_sync_send_aggConf(struct CSM* csm);
@@ -196,7 +196,6 @@ static void mlacp_sync_send_sysConf(struct CSM* csm)
 {
     int msg_len = 0;
 
-    memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
     msg_len = mlacp_prepare_for_sys_config(csm, g_csm_buf, CSM_BUFFER_SIZE);
     if (msg_len > 0)
         iccp_csm_send(csm, g_csm_buf, msg_len);
@@ -221,7 +220,6 @@ static void mlacp_sync_send_aggConf(struct CSM* csm)
     {
         if (local_if->type == IF_T_PORT_CHANNEL)
         {
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
             msg_len = mlacp_prepare_for_Aggport_config(csm, g_csm_buf, CSM_BUFFER_SIZE, local_if, 0);
             iccp_csm_send(csm, g_csm_buf, msg_len);
             local_if->port_config_sync = 0;
@@ -245,7 +243,6 @@ static void mlacp_sync_send_aggState(struct CSM* csm)
     {
         if (local_if->type == IF_T_PORT_CHANNEL)
         {
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
             msg_len = mlacp_prepare_for_Aggport_state(csm, g_csm_buf, CSM_BUFFER_SIZE, local_if);
             iccp_csm_send(csm, g_csm_buf, msg_len);
             local_if->changed = 0;
@@ -264,7 +261,6 @@ static void mlacp_sync_send_syncMacInfo(struct CSM* csm)
     struct MACMsg mac_find;
     int count = 0;
 
-    memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
     memset(&mac_find, 0, sizeof(struct MACMsg));
 
     while (!TAILQ_EMPTY(&(MLACP(csm).mac_msg_list)))
@@ -285,7 +281,7 @@ static void mlacp_sync_send_syncMacInfo(struct CSM* csm)
                 mac_find.vid = mac_msg->vid ;
                 memcpy(mac_find.mac_addr, mac_msg->mac_addr, ETHER_ADDR_LEN);
                 if (!RB_FIND(mac_rb_tree, &MLACP(csm).mac_rb ,&mac_find))
-                    free(mac_msg);
+                    iccp_csm_free_mac_msg(mac_msg);
             }
         }
 
@@ -293,7 +289,6 @@ static void mlacp_sync_send_syncMacInfo(struct CSM* csm)
         {
             iccp_csm_send(csm, g_csm_buf, msg_len);
             count = 0;
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         }
         /*ICCPD_LOG_DEBUG("mlacp_fsm", "  [SYNC_Send] MacInfo,len=[%d]", msg_len);*/
     }
@@ -310,8 +305,6 @@ static void mlacp_sync_send_syncArpInfo(struct CSM* csm)
     struct Msg* msg = NULL;
     int count = 0;
 
-    memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
-
     while (!TAILQ_EMPTY(&(MLACP(csm).arp_msg_list)))
     {
         msg = TAILQ_FIRST(&(MLACP(csm).arp_msg_list));
@@ -319,13 +312,11 @@ static void mlacp_sync_send_syncArpInfo(struct CSM* csm)
 
         msg_len = mlacp_prepare_for_arp_info(csm, g_csm_buf, CSM_BUFFER_SIZE, (struct ARPMsg*)msg->buf, count, NEIGH_SYNC_CLIENT_IP);
         count++;
-        free(msg->buf);
-        free(msg);
+        iccp_csm_free_msg(msg);
         if (count >= MAX_NEIGH_ENTRY_NUM)
         {
             iccp_csm_send(csm, g_csm_buf, msg_len);
             count = 0;
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         }
         /*ICCPD_LOG_DEBUG("mlacp_fsm", "  [SYNC_Send] ArpInfo,len=[%d]", msg_len);*/
     }
@@ -342,8 +333,6 @@ static void mlacp_sync_send_syncNdiscInfo(struct CSM *csm)
     struct Msg *msg = NULL;
     int count = 0;
 
-    memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
-
     while (!TAILQ_EMPTY(&(MLACP(csm).ndisc_msg_list)))
     {
         msg = TAILQ_FIRST(&(MLACP(csm).ndisc_msg_list));
@@ -351,13 +340,11 @@ static void mlacp_sync_send_syncNdiscInfo(struct CSM *csm)
 
         msg_len = mlacp_prepare_for_ndisc_info(csm, g_csm_buf, CSM_BUFFER_SIZE, (struct NDISCMsg *)msg->buf, count, NEIGH_SYNC_CLIENT_IP);
         count++;
-        free(msg->buf);
-        free(msg);
+        iccp_csm_free_msg(msg);
         if (count >= MAX_NEIGH_ENTRY_NUM)
         {
             iccp_csm_send(csm, g_csm_buf, msg_len);
             count = 0;
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         }
         /* ICCPD_LOG_DEBUG("mlacp_fsm", " [SYNC_Send] NDInfo,len=[%d]", msg_len); */
     }
@@ -381,7 +368,6 @@ static void mlacp_sync_send_syncPortChannelInfo(struct CSM* csm)
     {
         if (local_if->type == IF_T_PORT_CHANNEL)
         {
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
             msg_len = mlacp_prepare_for_port_channel_info(csm, g_csm_buf, CSM_BUFFER_SIZE, local_if);
             iccp_csm_send(csm, g_csm_buf, msg_len);
             local_if->changed = 0;
@@ -402,7 +388,6 @@ static void mlacp_sync_send_syncPeerLinkInfo(struct CSM* csm)
 
     if (csm->peer_link_if)
     {
-        memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         msg_len = mlacp_prepare_for_port_peerlink_info(csm, g_csm_buf, CSM_BUFFER_SIZE, csm->peer_link_if);
         iccp_csm_send(csm, g_csm_buf, msg_len);
     }
@@ -417,7 +402,6 @@ static void mlacp_sync_send_heartbeat(struct CSM* csm)
     if ((csm->heartbeat_send_time == 0) ||
         ((time(NULL) - csm->heartbeat_send_time) > csm->keepalive_time))
     {
-        memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         msg_len = mlacp_prepare_for_heartbeat(csm, g_csm_buf, CSM_BUFFER_SIZE);
         iccp_csm_send(csm, g_csm_buf, msg_len);
         time(&csm->heartbeat_send_time);
@@ -426,13 +410,32 @@ static void mlacp_sync_send_heartbeat(struct CSM* csm)
     return;
 }
 
+/* Send a due heartbeat and put it on the wire straight away, called by
+ * the scheduler ahead of the event and state machine work of a pass */
+void mlacp_fsm_send_heartbeat(struct CSM* csm)
+{
+    if (csm == NULL)
+        return;
+
+    if (csm->sock_fd <= 0 || csm->app_csm.current_state != APP_OPERATIONAL)
+        return;
+
+    if ((csm->heartbeat_send_time != 0) &&
+        ((time(NULL) - csm->heartbeat_send_time) <= csm->keepalive_time))
+        return;
+
+    mlacp_sync_send_heartbeat(csm);
+    iccp_csm_tx_flush(csm);
+
+    return;
+}
+
 static void mlacp_sync_send_syncDoneData(struct CSM* csm)
 {
     int msg_len = 0;
 
     /*Sync done & go to next stage*/
     MLACP(csm).wait_for_sync_data = 0;
-    memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
     msg_len = mlacp_prepare_for_sync_data_tlv(csm, g_csm_buf, CSM_BUFFER_SIZE, 1);
     iccp_csm_send(csm, g_csm_buf, msg_len);
     /*ICCPD_LOG_DEBUG("mlacp_fsm", "  [SYNC_Send] SyncDone, len=[%d]", msg_len);*/
@@ -616,6 +619,48 @@ static void mlacp_sync_recv_macInfo(struct CSM* csm, struct Msg* msg)
     return;
 }
 
+static void mlacp_sync_recv_macDigest(struct CSM* csm, struct Msg* msg)
+{
+    struct mLACPMACDigestTLV* tlv = NULL;
+    size_t tlv_len = 0;
+    uint16_t num_buckets = 0;
+    int i;
+
+    if (MLACP(csm).mac_digest_state & MLACP_MAC_DIGEST_DONE)
+        return;
+
+    tlv = (struct mLACPMACDigestTLV *)&(msg->buf[sizeof(ICCHdr)]);
+    tlv_len = ntohs(tlv->icc_parameter.len);
+
+    /*Read num_buckets only if the TLV, and the message, hold it*/
+    if (tlv_len >= offsetof(struct mLACPMACDigestTLV, digest) - sizeof(ICCParameter)
+        && msg->len >= sizeof(ICCHdr) + sizeof(ICCParameter) + tlv_len)
+        num_buckets = ntohs(tlv->num_buckets);
+
+    /*A digest of another size can't be compared, sync every bucket*/
+    if (num_buckets != MLACP_MAC_DIGEST_BUCKETS
+        || tlv_len != sizeof(struct mLACPMACDigestTLV) - sizeof(ICCParameter))
+    {
+        ICCPD_LOG_NOTICE("ICCP_FDB", "Receive MAC digest with %d buckets, len %zu, sync all MACs",
+            num_buckets, tlv_len);
+        memset(MLACP(csm).peer_mac_digest, 0, sizeof(MLACP(csm).peer_mac_digest));
+        MLACP(csm).mac_digest_state |= MLACP_MAC_DIGEST_PEER;
+        if (MLACP(csm).mac_digest_state & MLACP_MAC_DIGEST_LOCAL)
+            mlacp_mac_digest_reconcile(csm, 1);
+        return;
+    }
+
+    for (i = 0; i < MLACP_MAC_DIGEST_BUCKETS; i++)
+        MLACP(csm).peer_mac_digest[i] = ntohl(tlv->digest[i]);
+    MLACP(csm).mac_digest_state |= MLACP_MAC_DIGEST_PEER;
+
+    /*Peer may finish sync first, then reconcile in mlacp_sync_mac()*/
+    if (MLACP(csm).mac_digest_state & MLACP_MAC_DIGEST_LOCAL)
+        mlacp_mac_digest_reconcile(csm, 0);
+
+    return;
+}
+
 static void mlacp_sync_recv_arpInfo(struct CSM* csm, struct Msg* msg)
 {
     struct mLACPARPInfoTLV* arp_info = NULL;
@@ -685,7 +730,7 @@ static void mlacp_fsm_recv_if_up_ack(struct CSM* csm, struct Msg* msg)
         local_if = local_if_find_by_po_id(if_id);
 
         ICCPD_LOG_DEBUG("ICCP_FSM",
-            "RX if_up_ack: po_id %d, local if 0x%x, active %u",
+            "RX if_up_ack: po_id %d, local if %p, active %u",
             if_id, local_if, local_if ? local_if->po_active : 0);
 
         /* Ignore the ack if MLAG interface has gone down */
@@ -773,6 +818,7 @@ void mlacp_init(struct CSM* csm, int all)
 
     MLACP(csm).current_state = MLACP_STATE_INIT;
     memset(MLACP(csm).remote_system.system_id, 0, ETHER_ADDR_LEN);
+    MLACP(csm).mac_digest_state = 0;
 
     MLACP_MSG_QUEUE_REINIT(MLACP(csm).mlacp_msg_list);
     MLACP_MSG_QUEUE_REINIT(MLACP(csm).arp_msg_list);
@@ -780,6 +826,7 @@ void mlacp_init(struct CSM* csm, int all)
     mlacp_mac_msg_queue_reinit(csm);
 
     PIF_QUEUE_REINIT(MLACP(csm).pif_list);
+    memset(MLACP(csm).pif_name_hash, 0, sizeof(MLACP(csm).pif_name_hash));
     LIF_PURGE_QUEUE_REINIT(MLACP(csm).lif_purge_list);
 
     if (all != 0)
@@ -787,6 +834,8 @@ void mlacp_init(struct CSM* csm, int all)
         /* if no clean all, keep the arp info & local interface info for next connection*/
         MLACP_MSG_QUEUE_REINIT(MLACP(csm).arp_list);
         MLACP_MSG_QUEUE_REINIT(MLACP(csm).ndisc_list);
+        memset(MLACP(csm).arp_hash, 0, sizeof(MLACP(csm).arp_hash));
+        memset(MLACP(csm).ndisc_hash, 0, sizeof(MLACP(csm).ndisc_hash));
         RB_INIT(mac_rb_tree, &MLACP(csm).mac_rb );
         LIF_QUEUE_REINIT(MLACP(csm).lif_list);
 
@@ -814,6 +863,8 @@ void mlacp_finalize(struct CSM* csm)
     mlacp_mac_msg_queue_reinit(csm);
     MLACP_MSG_QUEUE_REINIT(MLACP(csm).arp_list);
     MLACP_MSG_QUEUE_REINIT(MLACP(csm).ndisc_list);
+    memset(MLACP(csm).arp_hash, 0, sizeof(MLACP(csm).arp_hash));
+    memset(MLACP(csm).ndisc_hash, 0, sizeof(MLACP(csm).ndisc_hash));
 
     RB_INIT(mac_rb_tree, &MLACP(csm).mac_rb );
 
@@ -822,6 +873,7 @@ void mlacp_finalize(struct CSM* csm)
     LIF_PURGE_QUEUE_REINIT(MLACP(csm).lif_purge_list);
     /* remove & destroy pif queue */
     PIF_QUEUE_REINIT(MLACP(csm).pif_list);
+    memset(MLACP(csm).pif_name_hash, 0, sizeof(MLACP(csm).pif_name_hash));
 
     return;
 }
@@ -838,6 +890,7 @@ void mlacp_fsm_transit(struct CSM* csm)
     ICCHdr* icc_hdr = NULL;
     ICCParameter* icc_param = NULL;
     int have_msg = 1;
+    int budget = MLACP_MSG_BUDGET;
 
     if (csm == NULL)
         return;
@@ -854,6 +907,7 @@ void mlacp_fsm_transit(struct CSM* csm)
             MLACP_MSG_QUEUE_REINIT(MLACP(csm).arp_msg_list);
             MLACP_MSG_QUEUE_REINIT(MLACP(csm).ndisc_msg_list);
             mlacp_mac_msg_queue_reinit(csm);
+            MLACP(csm).mac_digest_state = 0;
             MLACP(csm).current_state = MLACP_STATE_INIT;
             if (csm->sock_fd > 0)
             {
@@ -887,8 +941,20 @@ void mlacp_fsm_transit(struct CSM* csm)
     {
         if (MLACP(csm).current_state != MLACP_STATE_INIT)
         {
-            /* Handler NAK First*/
-            msg = mlacp_dequeue_msg(csm);
+            /* Leave the rest of the queue to the next pass, so the
+             * scheduler gets back to heartbeats and peer reads. The
+             * handler still runs once without a message below. */
+            if (budget-- <= 0)
+            {
+                sys->sched_work_pending = 1;
+                ++sys->dbg_counters.sched_budget_exceeded_counter;
+                msg = NULL;
+            }
+            else
+            {
+                /* Handler NAK First*/
+                msg = mlacp_dequeue_msg(csm);
+            }
             if (msg != NULL)
             {
                 have_msg = 1;
@@ -899,8 +965,7 @@ void mlacp_fsm_transit(struct CSM* csm)
                 if (icc_hdr->ldp_hdr.msg_type == MSG_T_NOTIFICATION && icc_param->type == TLV_T_NAK)
                 {
                     mlacp_sync_recv_nak_handler(csm, msg);
-                    free(msg->buf);
-                    free(msg);
+                    iccp_csm_free_msg(msg);
                     continue;
                 }
             }
@@ -946,8 +1011,7 @@ void mlacp_fsm_transit(struct CSM* csm)
         /*ICCPD_LOG_DEBUG("mlacp_fsm", "  Next State = %s", mlacp_state(csm));*/
         if (msg)
         {
-            free(msg->buf);
-            free(msg);
+            iccp_csm_free_msg(msg);
         }
     }
 }
@@ -985,7 +1049,7 @@ void mlacp_enqueue_msg(struct CSM* csm, struct Msg* msg)
     if (csm == NULL )
     {
         if (msg != NULL )
-            free(msg);
+            iccp_csm_free_msg(msg);
         return;
     }
 
@@ -1011,9 +1075,132 @@ struct Msg* mlacp_dequeue_msg(struct CSM* csm)
     return msg;
 }
 
+/*****************************************
+* Tool : MAC digest
+*
+* ***************************************/
+static uint32_t mlacp_mac_hash(uint32_t hash, const uint8_t* data, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        hash ^= data[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+static uint32_t mlacp_mac_digest_bucket(struct MACMsg* mac_msg)
+{
+    uint8_t vid[2] = { mac_msg->vid >> 8, mac_msg->vid & 0xff };
+    uint32_t hash = 2166136261U;
+
+    hash = mlacp_mac_hash(hash, vid, sizeof(vid));
+    hash = mlacp_mac_hash(hash, mac_msg->mac_addr, ETHER_ADDR_LEN);
+
+    return hash & (MLACP_MAC_DIGEST_BUCKETS - 1);
+}
+
+static uint32_t mlacp_mac_digest_entry(struct MACMsg* mac_msg)
+{
+    uint8_t vid[2] = { mac_msg->vid >> 8, mac_msg->vid & 0xff };
+    uint32_t hash = 2166136261U;
+
+    hash = mlacp_mac_hash(hash, vid, sizeof(vid));
+    hash = mlacp_mac_hash(hash, mac_msg->mac_addr, ETHER_ADDR_LEN);
+    hash = mlacp_mac_hash(hash, (const uint8_t*)mac_msg->ifname,
+        strnlen(mac_msg->ifname, MAX_L_PORT_NAME));
+
+    return hash;
+}
+
+/* MACs learned locally on an MCLAG interface. A MAC ADD from the peer for
+ * such an entry on the same interface only clears MAC_AGE_PEER, so when
+ * both nodes hold the same set of them the sync can be skipped.
+ */
+static int mlacp_mac_digest_member(struct CSM* csm, struct MACMsg* mac_msg)
+{
+    struct LocalInterface* lif = NULL;
+
+    if ((mac_msg->age_flag & MAC_AGE_LOCAL) || mac_msg->pending_local_del)
+        return 0;
+
+    if (strcmp(mac_msg->ifname, mac_msg->origin_ifname) != 0)
+        return 0;
+
+    lif = local_if_find_by_name(mac_msg->ifname);
+    if (!lif || lif->type != IF_T_PORT_CHANNEL || lif->csm != csm)
+        return 0;
+
+    return 1;
+}
+
+static void mlacp_mac_digest_compute(struct CSM* csm, uint32_t* digest)
+{
+    struct MACMsg* mac_msg = NULL;
+
+    memset(digest, 0, sizeof(uint32_t) * MLACP_MAC_DIGEST_BUCKETS);
+
+    RB_FOREACH (mac_msg, mac_rb_tree, &MLACP(csm).mac_rb)
+    {
+        if (mlacp_mac_digest_member(csm, mac_msg))
+            digest[mlacp_mac_digest_bucket(mac_msg)] += mlacp_mac_digest_entry(mac_msg);
+    }
+
+    return;
+}
+
+/* Sync the MACs left out by mlacp_sync_mac(). A bucket is skipped only if
+ * the peer digest, the digest sent to the peer and the current table all
+ * agree; MACs in such a bucket are known by both nodes. With full set,
+ * every bucket is synced.
+ */
+static void mlacp_mac_digest_reconcile(struct CSM* csm, int full)
+{
+    struct MACMsg* mac_msg = NULL;
+    static uint32_t digest[MLACP_MAC_DIGEST_BUCKETS];
+    uint32_t bucket;
+    int synced = 0, skipped = 0;
+
+    mlacp_mac_digest_compute(csm, digest);
+
+    RB_FOREACH (mac_msg, mac_rb_tree, &MLACP(csm).mac_rb)
+    {
+        if (!mlacp_mac_digest_member(csm, mac_msg))
+            continue;
+
+        bucket = mlacp_mac_digest_bucket(mac_msg);
+        if (!full && digest[bucket] == MLACP(csm).mac_digest[bucket]
+            && digest[bucket] == MLACP(csm).peer_mac_digest[bucket])
+        {
+            mac_msg->age_flag &= ~MAC_AGE_PEER;
+            mac_msg->warm_restored = 0;
+            skipped++;
+            continue;
+        }
+
+        mac_msg->op_type = MAC_SYNC_ADD;
+        if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_msg, tail))
+        {
+            TAILQ_INSERT_TAIL(&(MLACP(csm).mac_msg_list), mac_msg, tail);
+        }
+        synced++;
+    }
+
+    MLACP(csm).mac_digest_state |= MLACP_MAC_DIGEST_DONE;
+
+    ICCPD_LOG_NOTICE("ICCP_FDB", "Sync MAC: %s reconcile, %d MACs synced, %d MACs already on peer",
+        full ? "full" : "digest", synced, skipped);
+    return;
+}
+
 void mlacp_sync_mac(struct CSM* csm)
 {
     struct MACMsg* mac_msg = NULL;
+    int msg_len = 0;
+
     RB_FOREACH (mac_msg, mac_rb_tree, &MLACP(csm).mac_rb)
     {
         /*If MAC with local age flag, dont sync to peer. Such MAC only exist when peer is warm-reboot.
@@ -1022,6 +1209,10 @@ void mlacp_sync_mac(struct CSM* csm)
           After warm-reboot, this MAC must be learnt by peer and sync to local switch*/
         if (!(mac_msg->age_flag & MAC_AGE_LOCAL))
         {
+            /*MACs on MCLAG interfaces wait for the peer digest*/
+            if (mlacp_mac_digest_member(csm, mac_msg))
+                continue;
+
             mac_msg->op_type = MAC_SYNC_ADD;
             //As part of local sync do not delete peer age
             //mac_msg->age_flag &= ~MAC_AGE_PEER;
@@ -1049,6 +1240,20 @@ void mlacp_sync_mac(struct CSM* csm)
             }
         }
     }
+
+    /*Send the digest, the rest of the table is synced once the peer digest
+      arrives or, for a peer without digest support, after a timeout*/
+    mlacp_mac_digest_compute(csm, MLACP(csm).mac_digest);
+    msg_len = mlacp_prepare_for_mac_digest(csm, g_csm_buf, CSM_BUFFER_SIZE, MLACP(csm).mac_digest);
+    if (msg_len > 0)
+        iccp_csm_send(csm, g_csm_buf, msg_len);
+
+    MLACP(csm).mac_digest_state |= MLACP_MAC_DIGEST_LOCAL;
+    MLACP(csm).mac_digest_time = time(NULL);
+
+    if (MLACP(csm).mac_digest_state & MLACP_MAC_DIGEST_PEER)
+        mlacp_mac_digest_reconcile(csm, 0);
+
     return;
 }
 
@@ -1074,7 +1279,7 @@ void mlacp_local_lif_clear_pending_mac(struct CSM* csm, struct LocalInterface *l
                 mac_msg->op_type = MAC_SYNC_DEL;
                 if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_msg, tail))
                 {
-                    free(mac_msg);
+                    iccp_csm_free_mac_msg(mac_msg);
                 }
             }
             else
@@ -1149,7 +1354,6 @@ static void mlacp_sync_send_nak_handler(struct CSM* csm,  struct Msg* msg)
 
     ICCPD_LOG_WARN(__FUNCTION__, "Send NAK");
 
-    memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
     csm->app_csm.invalid_msg_id = ntohl(icc_hdr->ldp_hdr.msg_id);
     msg_len = app_csm_prepare_nak_msg(csm, g_csm_buf, CSM_BUFFER_SIZE);
     iccp_csm_send(csm, g_csm_buf, msg_len);
@@ -1287,6 +1491,10 @@ static void mlacp_sync_receiver_handler(struct CSM* csm, struct Msg* msg)
             mlacp_fsm_recv_if_up_ack(csm, msg);
             break;
 
+        case TLV_T_MLACP_MAC_DIGEST:
+            mlacp_sync_recv_macDigest(csm, msg);
+            break;
+
         default:
             ICCPD_LOG_ERR("ICCP_FSM", "Receive unsupported msg 0x%x from peer",
                 icc_param->type);
@@ -1352,7 +1560,6 @@ static void mlacp_sync_send_all_info_handler(struct CSM* csm)
     size_t len = 0;
 
     /* Prepare for sync start reply*/
-    memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
     len = mlacp_prepare_for_sync_data_tlv(csm, g_csm_buf, CSM_BUFFER_SIZE, 0);
     iccp_csm_send(csm, g_csm_buf, len);
 
@@ -1414,7 +1621,6 @@ static void mlacp_stage_sync_request_handler(struct CSM* csm, struct Msg* msg)
     if (MLACP(csm).wait_for_sync_data == 0)
     {
         // Send out the request for ALL
-        memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         msg_len = mlacp_prepare_for_sync_request_tlv(csm, g_csm_buf, CSM_BUFFER_SIZE);
         iccp_csm_send(csm, g_csm_buf, msg_len);
         MLACP(csm).wait_for_sync_data = 1;
@@ -1482,7 +1688,6 @@ static void mlacp_exchange_handler(struct CSM* csm, struct Msg* msg)
     {
         /* Send out the request for ALL info*/
         MLACP(csm).need_to_sync = 0;
-        memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         len = mlacp_prepare_for_sync_request_tlv(csm, g_csm_buf, CSM_BUFFER_SIZE);
         iccp_csm_send(csm, g_csm_buf, len);
     }
@@ -1490,13 +1695,11 @@ static void mlacp_exchange_handler(struct CSM* csm, struct Msg* msg)
     /* Send system config*/
     if (MLACP(csm).system_config_changed != 0)
     {
-        memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         len = mlacp_prepare_for_sys_config(csm, g_csm_buf, CSM_BUFFER_SIZE);
         iccp_csm_send(csm, g_csm_buf, len);
 
         if (csm->peer_link_if)
         {
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
             len = mlacp_prepare_for_port_peerlink_info(csm, g_csm_buf, CSM_BUFFER_SIZE, csm->peer_link_if);
             iccp_csm_send(csm, g_csm_buf, len);
         }
@@ -1508,7 +1711,6 @@ static void mlacp_exchange_handler(struct CSM* csm, struct Msg* msg)
     LIST_FOREACH(lif_purge, &(MLACP(csm).lif_purge_list), mlacp_purge_next)
     {
         /* Purge info*/
-        memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
         len = mlacp_prepare_for_Aggport_config(csm, g_csm_buf, CSM_BUFFER_SIZE, lif_purge, 1);
         iccp_csm_send(csm, g_csm_buf, len);
         /* Destroy old interface*/
@@ -1532,11 +1734,9 @@ static void mlacp_exchange_handler(struct CSM* csm, struct Msg* msg)
                 mlacp_link_disable_traffic_distribution(lif);
 
             /* Send port channel information*/
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
             len = mlacp_prepare_for_Aggport_config(csm, g_csm_buf, CSM_BUFFER_SIZE, lif, 0);
             iccp_csm_send(csm, g_csm_buf, len);
 
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
             len = mlacp_prepare_for_port_channel_info(csm, g_csm_buf, CSM_BUFFER_SIZE, lif);
             iccp_csm_send(csm, g_csm_buf, len);
 
@@ -1547,7 +1747,6 @@ static void mlacp_exchange_handler(struct CSM* csm, struct Msg* msg)
         if (lif->type == IF_T_PORT_CHANNEL && lif->changed)
         {
             /* Send port channel state information*/
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
             len = mlacp_prepare_for_Aggport_state(csm, g_csm_buf, CSM_BUFFER_SIZE, lif);
             //if po state send to peer is not successful, next time will try to
             //send again, until then dont unmark lif->changed flag
@@ -1558,6 +1757,13 @@ static void mlacp_exchange_handler(struct CSM* csm, struct Msg* msg)
         }
     }
 
+    /*Peer without MAC digest support, sync all MACs*/
+    if ((MLACP(csm).mac_digest_state & (MLACP_MAC_DIGEST_LOCAL | MLACP_MAC_DIGEST_PEER)) == MLACP_MAC_DIGEST_LOCAL
+        && (time(NULL) - MLACP(csm).mac_digest_time) >= MLACP_MAC_DIGEST_TIMEOUT)
+    {
+        mlacp_mac_digest_reconcile(csm, 1);
+    }
+
     /* Send MAC info if any*/
     mlacp_sync_send_syncMacInfo(csm);
 
@@ -1603,7 +1809,6 @@ static void mlacp_fsm_send_if_up_ack(
     if (MLACP(csm).current_state != MLACP_STATE_EXCHANGE)
         return;
 
-    memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
     msg_len = mlacp_prepare_for_if_up_ack(
         csm, g_csm_buf, CSM_BUFFER_SIZE, if_type, if_id, port_isolation_enable);
     if (msg_len > 0)
@@ -71,8 +71,47 @@ char g_iccp_mlagsyncd_send_buf[ICCP_MLAGSYNCD_SEND_MSG_BUFFER_SIZE] = { 0 };
 
 extern void mlacp_sync_mac(struct CSM* csm);
 
-#define SYNCD_SEND_RETRY_INTERVAL_USEC    50000 //50 mseconds
-#define SYNCD_SEND_RETRY_MAX              5
+/* Cap on bytes waiting for mclagsyncd to drain its socket */
+#define SYNCD_SEND_QUEUE_MAX_SIZE         (16 * 1024 * 1024)
+
+/* Seconds a mclagdctl client may take to read its reply */
+#define MCLAGD_CTL_REPLY_TIMEOUT          30
+
+/* FDB entries not yet sent, flushed as one SET_FDB message */
+static char g_iccp_fdb_batch_buf[ICCP_MLAGSYNCD_SEND_MSG_BUFFER_SIZE] = { 0 };
+static uint16_t g_iccp_fdb_batch_len = 0;
+
+/* MAC updates from mclagsyncd within this window of the last applied one
+ * are held, only the last of them is applied when the window ends */
+#define MAC_COALESCE_WINDOW_USEC          (100 * 1000)
+#define MAC_COALESCE_MAX                  4096
+#define MAC_COALESCE_HASH_SIZE            4096
+
+struct mac_coalesce_entry
+{
+    uint8_t mac_addr[ETHER_ADDR_LEN];
+    uint16_t vid;
+    char ifname[MAX_L_PORT_NAME];
+    uint8_t fdb_type;
+    uint8_t op_type;
+    uint8_t pending;        /* update held for the end of the window */
+    uint64_t expire_usec;
+    struct mac_coalesce_entry* hash_next;
+    TAILQ_ENTRY(mac_coalesce_entry) tail;
+};
+
+static struct mac_coalesce_entry g_mac_coalesce_pool[MAC_COALESCE_MAX];
+static struct mac_coalesce_entry* g_mac_coalesce_hash[MAC_COALESCE_HASH_SIZE];
+/* open windows, oldest first; unused entries */
+static TAILQ_HEAD(mac_coalesce_list, mac_coalesce_entry) g_mac_coalesce_list =
+    TAILQ_HEAD_INITIALIZER(g_mac_coalesce_list);
+static struct mac_coalesce_list g_mac_coalesce_free = TAILQ_HEAD_INITIALIZER(g_mac_coalesce_free);
+static int g_mac_coalesce_init = 0;
+
+/* Bytes sync_fd did not accept yet, drained when it turns writable */
+static char *g_iccp_syncd_sendq_buf = NULL;
+static size_t g_iccp_syncd_sendq_len = 0;
+static size_t g_iccp_syncd_sendq_size = 0;
 
 #define SYNCD_RECV_RETRY_INTERVAL_USEC    50000 //50 mseconds
 #define SYNCD_RECV_RETRY_MAX              5
@@ -361,71 +400,193 @@ static int peer_po_is_alive(struct CSM *csm, int po_ifindex)
     return pif_active;
 }
 
-// return -1 if failed
-ssize_t iccp_send_to_mclagsyncd(uint8_t msg_type, char *send_buff, uint16_t msg_len)
+/*****************************************
+ * Tool : Watch sync_fd for writability only
+ *        while the send queue is not empty
+ *
+ ****************************************/
+static void iccp_syncd_sendq_watch(struct System *sys, int enable)
+{
+    struct epoll_event event;
+
+    memset(&event, 0, sizeof(event));
+    event.data.fd = sys->sync_fd;
+    event.events = enable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    if (epoll_ctl(sys->epoll_fd, EPOLL_CTL_MOD, sys->sync_fd, &event) < 0)
+        ICCPD_LOG_WARN(__FUNCTION__, "Failed to update sync_fd epoll events, errno %d", errno);
+}
+
+/* The tail of a partially written message is always queued, dropping it
+ * would break the message framing of the mclagsyncd stream */
+static int iccp_syncd_sendq_append(char *buf, size_t len, int partial)
+{
+    size_t new_size;
+    char *new_buf;
+
+    if (!partial && g_iccp_syncd_sendq_len + len > SYNCD_SEND_QUEUE_MAX_SIZE)
+        return MCLAG_ERROR;
+
+    if (g_iccp_syncd_sendq_len + len > g_iccp_syncd_sendq_size)
+    {
+        new_size = g_iccp_syncd_sendq_size ? g_iccp_syncd_sendq_size : MCLAG_MAX_MSG_LEN;
+        while (new_size < g_iccp_syncd_sendq_len + len)
+            new_size *= 2;
+
+        new_buf = (char *)realloc(g_iccp_syncd_sendq_buf, new_size);
+        if (new_buf == NULL)
+            return MCLAG_ERROR;
+
+        g_iccp_syncd_sendq_buf = new_buf;
+        g_iccp_syncd_sendq_size = new_size;
+    }
+
+    memcpy(g_iccp_syncd_sendq_buf + g_iccp_syncd_sendq_len, buf, len);
+    g_iccp_syncd_sendq_len += len;
+
+    return 0;
+}
+
+/*****************************************
+ * Tool : Drain queued bytes once sync_fd
+ *        is writable again
+ *
+ ****************************************/
+int iccp_mclagsyncd_sendq_drain(struct System *sys)
 {
-    struct System *sys;
-    ssize_t write = 0;
-    int num_retry = 0;
     size_t pos = 0;
-    int send_len = 0;
+    ssize_t send_len;
 
-    sys = system_get_instance();
-    if (sys == NULL)
+    while (pos < g_iccp_syncd_sendq_len)
     {
-        ICCPD_LOG_ERR(__FUNCTION__, "Invalid system instance");
+        send_len = send(sys->sync_fd, &g_iccp_syncd_sendq_buf[pos],
+                        g_iccp_syncd_sendq_len - pos, MSG_DONTWAIT);
+        if (send_len > 0)
+        {
+            pos += send_len;
+            continue;
+        }
+
+        if ((send_len == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+            break;
+
+        /* The queued bytes can not be dropped without breaking the stream */
+        ICCPD_LOG_ERR("ICCP_FSM", "Send to mclagsyncd queue drain failed, %zu bytes queued, errno %d, reset connection",
+                      g_iccp_syncd_sendq_len - pos, errno);
+        syncd_info_close();
         return MCLAG_ERROR;
     }
 
-    if (sys->sync_fd)
+    if (pos < g_iccp_syncd_sendq_len)
     {
-        while (msg_len > 0)
-        {
-            send_len = send(sys->sync_fd, &send_buff[pos], msg_len, MSG_DONTWAIT);
+        memmove(g_iccp_syncd_sendq_buf, &g_iccp_syncd_sendq_buf[pos],
+                g_iccp_syncd_sendq_len - pos);
+        g_iccp_syncd_sendq_len -= pos;
+        return 0;
+    }
 
-            if (send_len == -1)
-            {
-                if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
-                {
-                    ++num_retry;
-                    if (num_retry > SYNCD_SEND_RETRY_MAX)
-                    {
-                        ICCPD_LOG_ERR("ICCP_FSM", "Send to mclagsyncd Non-blocking send() retry failed,msg_type: %d msg_len/send_len %d/%d",
-                                msg_type, msg_len, send_len);
-                        SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                                            sys, msg_type, ICCP_DBG_CNTR_STS_ERR);
-                        return MCLAG_ERROR;
-                    }
-                    else
-                    {
-                        usleep(SYNCD_SEND_RETRY_INTERVAL_USEC);
-                        send_len = 0;
-                    }
-                }
-                else
-                {
-                    ICCPD_LOG_ERR("ICCP_FSM", "Send to mclagsyncd Non-blocking send() failed, msg_type: %d errno %d",
-                            msg_type, errno);
-                    SYSTEM_SET_SYNCD_TX_DBG_COUNTER(sys, msg_type, ICCP_DBG_CNTR_STS_ERR);
-                    return MCLAG_ERROR;
-                }
-            }
-            else if (send_len == 0)
-            {
-                ICCPD_LOG_ERR("ICCP_FSM", "Send to mclagsyncd Non-blocking send() failed socket closed msg_type: %d errno %d",
-                        msg_type, errno);
-                SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                                    sys, msg_type, ICCP_DBG_CNTR_STS_ERR);
-                return MCLAG_ERROR;
-            }
-            msg_len -= send_len;
+    g_iccp_syncd_sendq_len = 0;
+    iccp_syncd_sendq_watch(sys, 0);
+
+    return 0;
+}
+
+/* Whatever the socket does not take now is queued behind EPOLLOUT,
+ * so callers never sleep waiting for mclagsyncd */
+static ssize_t iccp_send_to_mclagsyncd_nobatch(struct System *sys, uint8_t msg_type, char *send_buff, uint16_t msg_len)
+{
+    size_t pos = 0;
+    ssize_t send_len = 0;
+
+    if (sys->sync_fd <= 0)
+    {
+        SYSTEM_SET_SYNCD_TX_DBG_COUNTER(sys, msg_type, ICCP_DBG_CNTR_STS_ERR);
+        return MCLAG_ERROR;
+    }
+
+    /* Keep message order behind anything already queued */
+    while ((g_iccp_syncd_sendq_len == 0) && (pos < msg_len))
+    {
+        send_len = send(sys->sync_fd, &send_buff[pos], msg_len - pos, MSG_DONTWAIT);
+
+        if (send_len > 0)
+        {
             pos += send_len;
+            continue;
         }
-        SYSTEM_SET_SYNCD_TX_DBG_COUNTER(sys, msg_type, ICCP_DBG_CNTR_STS_OK);
+
+        if ((send_len == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+        {
+            iccp_syncd_sendq_watch(sys, 1);
+            break;
+        }
+
+        ICCPD_LOG_ERR("ICCP_FSM", "Send to mclagsyncd Non-blocking send() failed, msg_type: %d send_len %zd errno %d",
+                      msg_type, send_len, errno);
+        SYSTEM_SET_SYNCD_TX_DBG_COUNTER(sys, msg_type, ICCP_DBG_CNTR_STS_ERR);
+        return MCLAG_ERROR;
     }
 
-    return pos;
+    if (pos < msg_len)
+    {
+        if (iccp_syncd_sendq_append(&send_buff[pos], msg_len - pos, pos > 0) < 0)
+        {
+            ICCPD_LOG_ERR("ICCP_FSM", "Send to mclagsyncd queue full, msg_type: %d queued %zu",
+                          msg_type, g_iccp_syncd_sendq_len);
+            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(sys, msg_type, ICCP_DBG_CNTR_STS_ERR);
+            /* Out of memory for the tail of a partially written message */
+            if (pos > 0)
+                syncd_info_close();
+            return MCLAG_ERROR;
+        }
+    }
+
+    SYSTEM_SET_SYNCD_TX_DBG_COUNTER(sys, msg_type, ICCP_DBG_CNTR_STS_OK);
+
+    return msg_len;
+}
+
+/*****************************************
+ * Tool : Send the pending FDB entries to
+ *        mclagsyncd in one SET_FDB message
+ *
+ ****************************************/
+void iccp_mclagsyncd_fdb_flush()
+{
+    struct System *sys;
+    struct IccpSyncdHDr * msg_hdr;
+
+    if (g_iccp_fdb_batch_len <= sizeof(struct IccpSyncdHDr))
+        return;
+
+    if ((sys = system_get_instance()) == NULL)
+        return;
+
+    msg_hdr = (struct IccpSyncdHDr *)g_iccp_fdb_batch_buf;
+    msg_hdr->ver = ICCPD_TO_MCLAGSYNCD_HDR_VERSION;
+    msg_hdr->type = MCLAG_MSG_TYPE_SET_FDB;
+    msg_hdr->len = g_iccp_fdb_batch_len;
+    g_iccp_fdb_batch_len = 0;
 
+    if (iccp_send_to_mclagsyncd_nobatch(sys, msg_hdr->type, g_iccp_fdb_batch_buf, msg_hdr->len) <= 0)
+        ICCPD_LOG_WARN(__FUNCTION__, "Send fdb batch to Mclagsyncd failed, len %d", msg_hdr->len);
+}
+
+// return -1 if failed
+ssize_t iccp_send_to_mclagsyncd(uint8_t msg_type, char *send_buff, uint16_t msg_len)
+{
+    struct System *sys;
+
+    sys = system_get_instance();
+    if (sys == NULL)
+    {
+        ICCPD_LOG_ERR(__FUNCTION__, "Invalid system instance");
+        return MCLAG_ERROR;
+    }
+
+    /* FDB entries queued before this message must reach mclagsyncd first */
+    iccp_mclagsyncd_fdb_flush();
+
+    return iccp_send_to_mclagsyncd_nobatch(sys, msg_type, send_buff, msg_len);
 }
 
 #if 0
@@ -507,19 +668,12 @@ void set_peerlink_mlag_port_learn(struct LocalInterface *lif, int enable)
     /*send msg*/
     if (sys->sync_fd)
     {
-        rc = write(sys->sync_fd,msg_buf, msg_hdr->len);
+        rc = iccp_send_to_mclagsyncd(msg_hdr->type, msg_buf, msg_hdr->len);
         if ((rc <= 0) || (rc != msg_hdr->len))
         {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_ERR);
-            ICCPD_LOG_ERR(__FUNCTION__, "Failed to write for %s, rc %d",
+            ICCPD_LOG_ERR(__FUNCTION__, "Failed to write for %s, rc %zd",
                 lif->name, rc);
         }
-        else
-        {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_OK);
-        }
     }
     return;
 }
@@ -567,7 +721,7 @@ static int mlacp_link_set_traffic_dist_mode(
     if ((rc <= 0) || (rc != msg_hdr->len))
     {
         ICCPD_LOG_ERR(__FUNCTION__,
-            "Failed to write traffic %s for %s, rc %d",
+            "Failed to write traffic %s for %s, rc %zd",
             is_enable ? "enable" : "disable", po_name, rc);
         return MCLAG_ERROR;
     }
@@ -635,7 +789,7 @@ int mlacp_link_set_iccp_state(
     if ((rc <= 0) || (rc != msg_hdr->len))
     {
         ICCPD_LOG_ERR(__FUNCTION__,
-            "Failed to write mlag %d, ICCP status %s, rc %d",
+            "Failed to write mlag %d, ICCP status %s, rc %zd",
             mlag_id, is_oper_up ? "up" : "down", rc);
         return MCLAG_ERROR;
     }
@@ -704,7 +858,7 @@ int mlacp_link_set_iccp_role(
     if ((rc <= 0) || (rc != msg_hdr->len))
     {
         ICCPD_LOG_ERR(__FUNCTION__,
-            "Failed to write mlag %d, ICCP role %s, rc %d",
+            "Failed to write mlag %d, ICCP role %s, rc %zd",
             mlag_id, is_active_role ? "active" : "standby", rc);
         return MCLAG_ERROR;
     }
@@ -762,7 +916,7 @@ int mlacp_link_set_iccp_system_id(
     if ((rc <= 0) || (rc != msg_hdr->len))
     {
         ICCPD_LOG_ERR(__FUNCTION__,
-            "Failed to write mlag %d, ICCP system ID %s, rc %d",
+            "Failed to write mlag %d, ICCP system ID %s, rc %zd",
             mlag_id, mac_addr_to_str(system_id), rc);
         return MCLAG_ERROR;
     }
@@ -808,17 +962,16 @@ int mlacp_link_del_iccp_info(
     msg_hdr->len += (sizeof(mclag_sub_option_hdr_t) + sub_msg->op_len);
 
     if (sys->sync_fd)
-        rc = send(sys->sync_fd,msg_buf, msg_hdr->len, MSG_DONTWAIT);
+        rc = iccp_send_to_mclagsyncd(msg_hdr->type, msg_buf, msg_hdr->len);
 
     if ((rc <= 0) || (rc != msg_hdr->len))
     {
         ICCPD_LOG_ERR(__FUNCTION__,
-            "Failed to write mlag %d delete request, rc %d", mlag_id, rc);
+            "Failed to write mlag %d delete request, rc %zd", mlag_id, rc);
         return MCLAG_ERROR;
     }
     else
     {
-        SYSTEM_SET_SYNCD_TX_DBG_COUNTER(sys, msg_hdr->type, ICCP_DBG_CNTR_STS_OK);
         ICCPD_LOG_DEBUG("ICCP_FSM", "Delete mlag %d", mlag_id);
         return 0;
     }
@@ -879,7 +1032,7 @@ int mlacp_link_set_remote_if_state(
     if ((rc <= 0) || (rc != msg_hdr->len))
     {
         ICCPD_LOG_ERR(__FUNCTION__,
-            "Failed to write mlag %d, remote if %s status %s, rc %d",
+            "Failed to write mlag %d, remote if %s status %s, rc %zd",
             mlag_id, po_name, is_oper_up ? "up" : "down", rc);
         return MCLAG_ERROR;
     }
@@ -939,7 +1092,7 @@ int mlacp_link_del_remote_if_info(
     if ((rc <= 0) || (rc != msg_hdr->len))
     {
         ICCPD_LOG_ERR(__FUNCTION__,
-            "Failed to write mlag %d, del remote if %s, rc %d",
+            "Failed to write mlag %d, del remote if %s, rc %zd",
             mlag_id, po_name, rc);
         return MCLAG_ERROR;
     }
@@ -1005,7 +1158,7 @@ int mlacp_link_set_peerlink_port_isolation(
     if ((rc <= 0) || (rc != msg_hdr->len))
     {
         ICCPD_LOG_ERR(__FUNCTION__,
-            "Failed to write mlag %d, %s port isolation %s, rc %d",
+            "Failed to write mlag %d, %s port isolation %s, rc %zd",
             mlag_id, po_name, is_isolation_enable ? "enable" : "disable", rc);
         return MCLAG_ERROR;
     }
@@ -1041,8 +1194,24 @@ static void set_peerlink_mlag_port_kernel_forward(
     return;
 }
 
+/*****************************************
+* Tool : Mark the isolation group of a CSM for a full resend
+*
+* The group is recomputed and sent by iccp_peerlink_isolate_flush()
+* at the end of the scheduler pass, even if it did not change.
+* ***************************************/
 void update_peerlink_isolate_from_all_csm_lif(
     struct CSM* csm)
+{
+    if (!csm)
+        return;
+
+    MLACP(csm).isolate_dirty = 1;
+    MLACP(csm).isolate_sent_valid = 0;
+}
+
+static void peerlink_isolate_send(
+    struct CSM* csm)
 {
     struct LocalInterface *lif = NULL;
     struct IccpSyncdHDr * msg_hdr;
@@ -1145,12 +1314,22 @@ void update_peerlink_isolate_from_all_csm_lif(
             }
             else
             {
-                ICCPD_LOG_WARN(__FUNCTION__, "the remaining length %d is not enough to store:%s%s%s", 
+                ICCPD_LOG_WARN(__FUNCTION__, "the remaining length %zu is not enough to store:%s%s%s", 
                     sizeof(mlag_po_buf) - dst_len, lif->name, lif->portchannel_member_buf[0] == 0 ? "" : ",", lif->portchannel_member_buf);
             }
         }
     }
 
+    /* same group as the last one mclagsyncd got, nothing to send */
+    if (MLACP(csm).isolate_sent_valid
+        && strcmp(MLACP(csm).isolate_sent_src, csm->peer_link_if->name) == 0
+        && strcmp(MLACP(csm).isolate_sent_dst, mlag_po_buf) == 0)
+    {
+        ++sys->dbg_counters.isolate_update_skipped_counter;
+        return;
+    }
+    MLACP(csm).isolate_sent_valid = 0;
+
     sub_msg->op_len = dst_len;
     msg_hdr->len += sizeof(mclag_sub_option_hdr_t);
     msg_hdr->len += sub_msg->op_len;
@@ -1168,23 +1347,50 @@ void update_peerlink_isolate_from_all_csm_lif(
     /*send msg*/
     if (sys->sync_fd)
     {
-        rc = write(sys->sync_fd,msg_buf, msg_hdr->len);
+        rc = iccp_send_to_mclagsyncd(msg_hdr->type, msg_buf, msg_hdr->len);
         if ((rc <= 0) || (rc != msg_hdr->len))
         {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_ERR);
-            ICCPD_LOG_ERR(__FUNCTION__, "Failed to write, rc %d", rc);
+            ICCPD_LOG_ERR(__FUNCTION__, "Failed to write, rc %zd", rc);
         }
         else
         {
-            SYSTEM_SET_SYNCD_TX_DBG_COUNTER(
-                sys, msg_hdr->type, ICCP_DBG_CNTR_STS_OK);
+            /* remember what syncd has, an unchanged recompute is skipped */
+            snprintf(MLACP(csm).isolate_sent_src, sizeof(MLACP(csm).isolate_sent_src),
+                     "%s", csm->peer_link_if->name);
+            memcpy(MLACP(csm).isolate_sent_dst, mlag_po_buf, sizeof(MLACP(csm).isolate_sent_dst));
+            MLACP(csm).isolate_sent_valid = 1;
+            ++sys->dbg_counters.isolate_update_sent_counter;
         }
     }
 
     return;
 }
 
+/*****************************************
+* Tool : Send the isolation groups changed in this pass
+*
+* Port state changes only mark the CSM, so a burst of flaps on many
+* MLAG port-channels ends up as at most one message per CSM per pass,
+* and none if the group is back to what was last sent.
+* ***************************************/
+void iccp_peerlink_isolate_flush()
+{
+    struct System *sys;
+    struct CSM *csm;
+
+    if ((sys = system_get_instance()) == NULL)
+        return;
+
+    LIST_FOREACH(csm, &(sys->csm_list), next)
+    {
+        if (!MLACP(csm).isolate_dirty)
+            continue;
+
+        MLACP(csm).isolate_dirty = 0;
+        peerlink_isolate_send(csm);
+    }
+}
+
 static void set_peerlink_mlag_port_isolate(
     struct CSM *csm,
     struct LocalInterface *lif,
@@ -1207,7 +1413,8 @@ static void set_peerlink_mlag_port_isolate(
     ICCPD_LOG_DEBUG("ICCP_FSM", "Set port isolation %s: mlag_if %s, members %s",
         enable ? "enable" : "disable", lif->name, lif->portchannel_member_buf);
 
-    update_peerlink_isolate_from_all_csm_lif(csm);
+    /* group goes out with iccp_peerlink_isolate_flush() */
+    MLACP(csm).isolate_dirty = 1;
 
     /* Kernel also needs to block traffic from peerlink to mlag-port*/
     set_peerlink_mlag_port_kernel_forward(csm, lif, enable);
@@ -1236,6 +1443,16 @@ void peerlink_port_isolate_cleanup(struct CSM* csm)
         }
     }
 
+    /* Send the cleared group now, not from iccp_peerlink_isolate_flush():
+     * on session down iccp_csm_status_reset() drops peer_link_if before
+     * the end of the pass and the flush would have nothing to send from.
+     */
+    if (MLACP(csm).isolate_dirty)
+    {
+        MLACP(csm).isolate_dirty = 0;
+        peerlink_isolate_send(csm);
+    }
+
     return;
 }
 
@@ -1599,13 +1816,29 @@ void update_stp_peer_link(struct CSM *csm,
     return;
 }
 
+/* Entry of the same MAC in the pending FDB batch, NULL if none */
+static struct mclag_fdb_info* iccp_fdb_batch_find(uint8_t* mac_addr, uint16_t vid)
+{
+    struct mclag_fdb_info * mac_info;
+    uint16_t pos;
+
+    if (g_iccp_fdb_batch_len <= sizeof(struct IccpSyncdHDr))
+        return NULL;
+
+    for (pos = sizeof(struct IccpSyncdHDr); pos < g_iccp_fdb_batch_len; pos += sizeof(struct mclag_fdb_info))
+    {
+        mac_info = (struct mclag_fdb_info *)&g_iccp_fdb_batch_buf[pos];
+        if (mac_info->vid == vid && memcmp(mac_info->mac, mac_addr, ETHER_ADDR_LEN) == 0)
+            return mac_info;
+    }
+
+    return NULL;
+}
+
 void iccp_send_fdb_entry_to_syncd( struct MACMsg* mac_msg, uint8_t mac_type, uint8_t oper)
 {
-    struct IccpSyncdHDr * msg_hdr;
-    char *msg_buf = g_iccp_mlagsyncd_send_buf;
     struct System *sys;
     struct mclag_fdb_info * mac_info;
-    ssize_t rc;
     uint8_t null_mac[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 
     sys = system_get_instance();
@@ -1621,37 +1854,40 @@ void iccp_send_fdb_entry_to_syncd( struct MACMsg* mac_msg, uint8_t mac_type, uin
         return;
     }
 
-    memset(msg_buf, 0, ICCP_MLAGSYNCD_SEND_MSG_BUFFER_SIZE);
-
-    msg_hdr = (struct IccpSyncdHDr *)msg_buf;
-    msg_hdr->ver = ICCPD_TO_MCLAGSYNCD_HDR_VERSION;
-    msg_hdr->type = MCLAG_MSG_TYPE_SET_FDB;
-
-    /*mac msg */
-    mac_info = (struct mclag_fdb_info *)&msg_buf[sizeof(struct IccpSyncdHDr)];
-    mac_info->vid = mac_msg->vid;
-    memcpy(mac_info->port_name, mac_msg->ifname, MAX_L_PORT_NAME);
-    memcpy(mac_info->mac, mac_msg->mac_addr, ETHER_ADDR_LEN);
-    mac_info->type = mac_type;
-    mac_info->op_type = oper;
-    msg_hdr->len = sizeof(struct IccpSyncdHDr) + sizeof(struct mclag_fdb_info);
-
-    ICCPD_LOG_DEBUG("ICCP_FDB", "Send fdb to syncd: write mac msg vid : %d ; ifname %s ; mac %s fdb type %d ; op type %s",
-        mac_info->vid, mac_info->port_name, mac_addr_to_str(mac_info->mac), mac_info->type,
-        oper == MAC_SYNC_ADD ? "add" : "del");
-
-    /*send msg*/
     if (sys->sync_fd > 0 )
     {
-        rc = iccp_send_to_mclagsyncd(msg_hdr->type, msg_buf, msg_hdr->len);
-        if (rc <= 0)
+        /*a later update of a MAC still in the batch replaces it */
+        mac_info = iccp_fdb_batch_find(mac_msg->mac_addr, mac_msg->vid);
+        if (mac_info)
         {
-            ICCPD_LOG_WARN(__FUNCTION__, "Send to Mclagsyncd failed rc: %d",rc);
+            ++sys->dbg_counters.fdb_batch_coalesced_counter;
         }
+        else
+        {
+            if (g_iccp_fdb_batch_len + sizeof(struct mclag_fdb_info) > ICCP_MLAGSYNCD_SEND_MSG_BUFFER_SIZE)
+                iccp_mclagsyncd_fdb_flush();
+            if (g_iccp_fdb_batch_len == 0)
+                g_iccp_fdb_batch_len = sizeof(struct IccpSyncdHDr);
+
+            mac_info = (struct mclag_fdb_info *)&g_iccp_fdb_batch_buf[g_iccp_fdb_batch_len];
+            g_iccp_fdb_batch_len += sizeof(struct mclag_fdb_info);
+        }
+
+        /*mac msg, sent with the batch at the end of this event loop pass */
+        memset(mac_info, 0, sizeof(struct mclag_fdb_info));
+        mac_info->vid = mac_msg->vid;
+        memcpy(mac_info->port_name, mac_msg->ifname, MAX_L_PORT_NAME);
+        memcpy(mac_info->mac, mac_msg->mac_addr, ETHER_ADDR_LEN);
+        mac_info->type = mac_type;
+        mac_info->op_type = oper;
+
+        ICCPD_LOG_DEBUG("ICCP_FDB", "Send fdb to syncd: write mac msg vid : %d ; ifname %s ; mac %s fdb type %d ; op type %s",
+            mac_info->vid, mac_info->port_name, mac_addr_to_str(mac_info->mac), mac_info->type,
+            oper == MAC_SYNC_ADD ? "add" : "del");
     }
     else
     {
-        SYSTEM_SET_SYNCD_TX_DBG_COUNTER(sys, msg_hdr->type, ICCP_DBG_CNTR_STS_ERR);
+        SYSTEM_SET_SYNCD_TX_DBG_COUNTER(sys, MCLAG_MSG_TYPE_SET_FDB, ICCP_DBG_CNTR_STS_ERR);
         ICCPD_LOG_ERR(__FUNCTION__, "Invalid sync_fd Failed to write, fd %d", sys->sync_fd);
     }
 
@@ -1750,12 +1986,12 @@ static void update_l2_mac_state(struct CSM *csm,
     if (po_state == 0)
     {
         lif->po_down_time = time(NULL);
-        ICCPD_LOG_DEBUG("ICCP_FDB", "Intf down,  ifname: %s, po_down_time: %u", lif->name, lif->po_down_time);
+        ICCPD_LOG_DEBUG("ICCP_FDB", "Intf down,  ifname: %s, po_down_time: %ld", lif->name, (long)lif->po_down_time);
     }
     else
     {
         lif->po_down_time = 0;
-        ICCPD_LOG_DEBUG("ICCP_FDB", "Intf up,  ifname: %s, clear po_down_time, time %u", lif->name, lif->po_down_time);
+        ICCPD_LOG_DEBUG("ICCP_FDB", "Intf up,  ifname: %s, clear po_down_time, time %ld", lif->name, (long)lif->po_down_time);
     }
 
 
@@ -1819,7 +2055,7 @@ static void update_l2_mac_state(struct CSM *csm,
                 // else free is taken care after sending the update to peer
                 if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_msg, tail))
                 {
-                    free(mac_msg);
+                    iccp_csm_free_mac_msg(mac_msg);
                 }
             }
             else
@@ -1908,7 +2144,7 @@ static void update_l2_mac_state(struct CSM *csm,
                         mac_msg->op_type = MAC_SYNC_DEL;
                         if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_msg, tail))
                         {
-                            free(mac_msg);
+                            iccp_csm_free_mac_msg(mac_msg);
                         }
                     }
                     else
@@ -2318,7 +2554,7 @@ void mlacp_peer_disconn_fdb_handler(struct CSM* csm)
                 // else free is taken care after sending the update to peer
                 if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_msg, tail))
                 {
-                    free(mac_msg);
+                    iccp_csm_free_mac_msg(mac_msg);
                 }
             }
         }
@@ -2505,7 +2741,7 @@ void mlacp_peerlink_down_handler(struct CSM* csm)
             // else free is taken care after sending the update to peer
             if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_msg, tail))
             {
-                free(mac_msg);
+                iccp_csm_free_mac_msg(mac_msg);
             }
         }
     }
@@ -2562,6 +2798,7 @@ void mlacp_mlag_link_del_handler(struct CSM *csm, struct LocalInterface *lif)
 int iccp_connect_syncd()
 {
     struct System* sys = NULL;
+    struct CSM* csm = NULL;
     int ret = 0;
     int fd = 0;
     struct sockaddr_in serv;
@@ -2610,6 +2847,10 @@ int iccp_connect_syncd()
     ICCPD_LOG_NOTICE(__FUNCTION__, "Success to link syncd");
     sys->sync_fd = fd;
 
+    /* new syncd connection, do not skip the next isolation group */
+    LIST_FOREACH(csm, &(sys->csm_list), next)
+        MLACP(csm).isolate_sent_valid = 0;
+
     event.data.fd = fd;
     event.events = EPOLLIN;
     ret = epoll_ctl(sys->epoll_fd, EPOLL_CTL_ADD, fd, &event);
@@ -2642,6 +2883,13 @@ void syncd_info_close()
         sys->sync_fd = -1;
     }
 
+    /* Nothing queued for the old connection is valid for the next one */
+    g_iccp_fdb_batch_len = 0;
+    g_iccp_syncd_sendq_len = 0;
+    g_iccp_syncd_sendq_size = 0;
+    free(g_iccp_syncd_sendq_buf);
+    g_iccp_syncd_sendq_buf = NULL;
+
     return;
 }
 
@@ -2750,6 +2998,7 @@ void do_mac_update_from_syncd(uint8_t mac_addr[ETHER_ADDR_LEN], uint16_t vid, ch
     if(mac_info)
     {
         mac_exist = 1;
+        mac_info->warm_restored = 0;
         ICCPD_LOG_DEBUG("ICCP_FDB", "MAC update from mclagsyncd: RB_FIND success for the MAC entry : %s, "
             " vid: %d , ifname %s, type: %d, age flag: %d", mac_addr_to_str(mac_info->mac_addr),
             mac_info->vid, mac_info->ifname, mac_info->fdb_type, mac_info->age_flag );
@@ -2976,7 +3225,7 @@ void do_mac_update_from_syncd(uint8_t mac_addr[ETHER_ADDR_LEN], uint16_t vid, ch
                     // else free is taken care after sending the update to peer
                     if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_info, tail))
                     {
-                        free(mac_info);
+                        iccp_csm_free_mac_msg(mac_info);
                     }
                 }
                 else if (csm->peer_link_if && csm->peer_link_if->state != PORT_STATE_DOWN)
@@ -3013,7 +3262,7 @@ void do_mac_update_from_syncd(uint8_t mac_addr[ETHER_ADDR_LEN], uint16_t vid, ch
                 // else free is taken care after sending the update to peer
                 if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_info, tail))
                 {
-                    free(mac_info);
+                    iccp_csm_free_mac_msg(mac_info);
                 }
             }
             else
@@ -3326,6 +3575,155 @@ int iccp_mclagsyncd_vlan_mbr_update_handler(struct System *sys, char *msg_buf)
     return 0;
 }
 
+static uint32_t mac_coalesce_hash(uint8_t* mac_addr, uint16_t vid)
+{
+    uint32_t hash = vid;
+    int i;
+
+    for (i = 0; i < ETHER_ADDR_LEN; i++)
+        hash = hash * 31 + mac_addr[i];
+
+    return hash & (MAC_COALESCE_HASH_SIZE - 1);
+}
+
+static struct mac_coalesce_entry* mac_coalesce_find(uint8_t* mac_addr, uint16_t vid)
+{
+    struct mac_coalesce_entry* entry;
+
+    entry = g_mac_coalesce_hash[mac_coalesce_hash(mac_addr, vid)];
+    while (entry)
+    {
+        if (entry->vid == vid && memcmp(entry->mac_addr, mac_addr, ETHER_ADDR_LEN) == 0)
+            return entry;
+        entry = entry->hash_next;
+    }
+
+    return NULL;
+}
+
+static void mac_coalesce_remove(struct mac_coalesce_entry* entry)
+{
+    struct mac_coalesce_entry** prev;
+
+    prev = &g_mac_coalesce_hash[mac_coalesce_hash(entry->mac_addr, entry->vid)];
+    while (*prev && *prev != entry)
+        prev = &(*prev)->hash_next;
+    if (*prev)
+        *prev = entry->hash_next;
+
+    TAILQ_REMOVE(&g_mac_coalesce_list, entry, tail);
+
+    return;
+}
+
+/* Open a window for a MAC just applied, no window if all are in use */
+static void mac_coalesce_open(uint8_t* mac_addr, uint16_t vid, uint64_t now)
+{
+    struct mac_coalesce_entry* entry;
+    uint32_t hash;
+    int i;
+
+    if (!g_mac_coalesce_init)
+    {
+        for (i = 0; i < MAC_COALESCE_MAX; i++)
+            TAILQ_INSERT_TAIL(&g_mac_coalesce_free, &g_mac_coalesce_pool[i], tail);
+        g_mac_coalesce_init = 1;
+    }
+
+    entry = TAILQ_FIRST(&g_mac_coalesce_free);
+    if (!entry)
+        return;
+    TAILQ_REMOVE(&g_mac_coalesce_free, entry, tail);
+
+    memcpy(entry->mac_addr, mac_addr, ETHER_ADDR_LEN);
+    entry->vid = vid;
+    entry->pending = 0;
+    entry->expire_usec = now + MAC_COALESCE_WINDOW_USEC;
+
+    hash = mac_coalesce_hash(mac_addr, vid);
+    entry->hash_next = g_mac_coalesce_hash[hash];
+    g_mac_coalesce_hash[hash] = entry;
+    TAILQ_INSERT_TAIL(&g_mac_coalesce_list, entry, tail);
+
+    return;
+}
+
+/* A MAC update from mclagsyncd. The first one is applied at once, the
+ * ones following within the window only replace the held state. */
+static void mac_coalesce_update(struct System *sys, uint8_t* mac_addr, uint16_t vid,
+                                char* ifname, uint8_t fdb_type, uint8_t op_type)
+{
+    struct mac_coalesce_entry* entry;
+
+    entry = mac_coalesce_find(mac_addr, vid);
+    if (entry)
+    {
+        if (entry->pending)
+            ++sys->dbg_counters.mac_coalesce_suppressed_counter;
+        else
+            ++sys->dbg_counters.mac_coalesce_held_counter;
+
+        memcpy(entry->ifname, ifname, MAX_L_PORT_NAME);
+        entry->ifname[MAX_L_PORT_NAME - 1] = '\0';
+        entry->fdb_type = fdb_type;
+        entry->op_type = op_type;
+        entry->pending = 1;
+        return;
+    }
+
+    do_mac_update_from_syncd(mac_addr, vid, ifname, fdb_type, op_type);
+    mac_coalesce_open(mac_addr, vid, scheduler_time_usec());
+
+    return;
+}
+
+/*****************************************
+ * Tool : Apply the MAC updates held until
+ *        the end of their window, all of
+ *        them if flush_all is set
+ *
+ ****************************************/
+void iccp_mac_coalesce_flush(int flush_all)
+{
+    struct mac_coalesce_entry* entry;
+    uint64_t now;
+    uint32_t hash;
+
+    if (TAILQ_EMPTY(&g_mac_coalesce_list))
+        return;
+
+    now = scheduler_time_usec();
+    while ((entry = TAILQ_FIRST(&g_mac_coalesce_list)) != NULL)
+    {
+        if (!flush_all && entry->expire_usec > now)
+            break;
+
+        mac_coalesce_remove(entry);
+
+        if (entry->pending)
+        {
+            do_mac_update_from_syncd(entry->mac_addr, entry->vid, entry->ifname,
+                                     entry->fdb_type, entry->op_type);
+
+            /*still changing, keep holding the updates that follow */
+            if (!flush_all)
+            {
+                entry->pending = 0;
+                entry->expire_usec = now + MAC_COALESCE_WINDOW_USEC;
+                hash = mac_coalesce_hash(entry->mac_addr, entry->vid);
+                entry->hash_next = g_mac_coalesce_hash[hash];
+                g_mac_coalesce_hash[hash] = entry;
+                TAILQ_INSERT_TAIL(&g_mac_coalesce_list, entry, tail);
+                continue;
+            }
+        }
+
+        TAILQ_INSERT_TAIL(&g_mac_coalesce_free, entry, tail);
+    }
+
+    return;
+}
+
 int iccp_receive_fdb_handler_from_syncd(struct System *sys, char *msg_buf)
 {
     int count = 0;
@@ -3342,7 +3740,7 @@ int iccp_receive_fdb_handler_from_syncd(struct System *sys, char *msg_buf)
     {
         mac_info = (struct mclag_fdb_info *)&msg_buf[sizeof(struct IccpSyncdHDr )+ i * sizeof(struct mclag_fdb_info)];
 
-        do_mac_update_from_syncd(mac_info->mac, mac_info->vid, mac_info->port_name, mac_info->type, mac_info->op_type);
+        mac_coalesce_update(sys, mac_info->mac, mac_info->vid, mac_info->port_name, mac_info->type, mac_info->op_type);
     }
     return 0;
 }
@@ -3783,6 +4181,163 @@ int mclagd_ctl_sock_read(int fd, char *r_buf, int total_len)
     return read_len;
 }
 
+/* A reply mclagdctl has not read yet. A dump is copied out of the tables
+ * in one scheduler pass, which makes it a consistent snapshot, and is
+ * then written as the client socket drains, so a large dump never holds
+ * the scheduler in write(). */
+struct mclagd_ctl_reply
+{
+    int fd;
+    char *buf;
+    size_t len;
+    size_t pos;
+    time_t start_time;
+    LIST_ENTRY(mclagd_ctl_reply) next;
+};
+
+static LIST_HEAD(mclagd_ctl_reply_list, mclagd_ctl_reply) g_mclagd_ctl_reply_list =
+    LIST_HEAD_INITIALIZER(g_mclagd_ctl_reply_list);
+
+static struct mclagd_ctl_reply *mclagd_ctl_reply_find(int fd)
+{
+    struct mclagd_ctl_reply *reply = NULL;
+
+    LIST_FOREACH(reply, &g_mclagd_ctl_reply_list, next)
+    {
+        if (reply->fd == fd)
+            return reply;
+    }
+
+    return NULL;
+}
+
+static void mclagd_ctl_reply_free(struct mclagd_ctl_reply *reply)
+{
+    struct System* sys = NULL;
+
+    if ((sys = system_get_instance()) != NULL)
+    {
+        epoll_ctl(sys->epoll_fd, EPOLL_CTL_DEL, reply->fd, NULL);
+        sys->readfd_count--;
+    }
+
+    LIST_REMOVE(reply, next);
+    close(reply->fd);
+    free(reply->buf);
+    free(reply);
+
+    return;
+}
+
+/* Drop replies of clients that stopped reading, called every scheduler
+ * pass so a stalled client is closed even when no other one connects */
+void mclagd_ctl_reply_expire()
+{
+    struct mclagd_ctl_reply *reply = NULL;
+    struct mclagd_ctl_reply *reply_next = NULL;
+    time_t now = 0;
+
+    if (LIST_EMPTY(&g_mclagd_ctl_reply_list))
+        return;
+
+    now = time(NULL);
+    reply = LIST_FIRST(&g_mclagd_ctl_reply_list);
+    while (reply)
+    {
+        reply_next = LIST_NEXT(reply, next);
+        if ((now - reply->start_time) >= MCLAGD_CTL_REPLY_TIMEOUT)
+        {
+            ICCPD_LOG_WARN(__FUNCTION__, "mclagdctl client fd %d stalled, %zu of %zu bytes dropped",
+                           reply->fd, reply->len - reply->pos, reply->len);
+            mclagd_ctl_reply_free(reply);
+        }
+        reply = reply_next;
+    }
+
+    return;
+}
+
+/* Queue what the client socket did not take, the fd is closed once the
+ * reply is written */
+static int mclagd_ctl_reply_queue(int fd, char *buf, size_t len)
+{
+    struct System* sys = NULL;
+    struct mclagd_ctl_reply *reply = NULL;
+    struct epoll_event event;
+
+    if ((sys = system_get_instance()) == NULL)
+        return MCLAG_ERROR;
+
+    reply = (struct mclagd_ctl_reply *)calloc(1, sizeof(struct mclagd_ctl_reply));
+    if (!reply)
+        return MCLAG_ERROR;
+
+    reply->buf = (char *)malloc(len);
+    if (!reply->buf)
+    {
+        free(reply);
+        return MCLAG_ERROR;
+    }
+
+    memcpy(reply->buf, buf, len);
+    reply->fd = fd;
+    reply->len = len;
+    reply->start_time = time(NULL);
+
+    event.data.fd = fd;
+    event.events = EPOLLOUT;
+    if (epoll_ctl(sys->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+        free(reply->buf);
+        free(reply);
+        return MCLAG_ERROR;
+    }
+
+    sys->readfd_count++;
+    LIST_INSERT_HEAD(&g_mclagd_ctl_reply_list, reply, next);
+
+    return 0;
+}
+
+/* Write more of a queued reply, returns 0 if fd is not a reply fd */
+int mclagd_ctl_reply_handler(int fd)
+{
+    struct mclagd_ctl_reply *reply = NULL;
+    ssize_t ret = 0;
+
+    if ((reply = mclagd_ctl_reply_find(fd)) == NULL)
+        return 0;
+
+    while (reply->pos < reply->len)
+    {
+        ret = send(fd, reply->buf + reply->pos, reply->len - reply->pos, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (ret > 0)
+        {
+            reply->pos += ret;
+            continue;
+        }
+
+        if ((ret == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+            return 1;
+
+        ICCPD_LOG_DEBUG(__FUNCTION__, "mclagdctl client fd %d write failed, errno %d", fd, errno);
+        break;
+    }
+
+    mclagd_ctl_reply_free(reply);
+
+    return 1;
+}
+
+/* Close a client after its request, unless its reply is still queued */
+void mclagd_ctl_sock_release(int fd)
+{
+    if (mclagd_ctl_reply_find(fd) == NULL)
+        close(fd);
+
+    return;
+}
+
 int mclagd_ctl_sock_write(int fd, char *w_buf, int total_len)
 {
     int write_len = 0;
@@ -3790,12 +4345,21 @@ int mclagd_ctl_sock_write(int fd, char *w_buf, int total_len)
 
     while (write_len < total_len)
     {
-        ret = write(fd, w_buf + write_len, total_len - write_len);
-        if (ret <= 0)
+        ret = send(fd, w_buf + write_len, total_len - write_len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (ret > 0)
         {
-            return 0;
+            write_len += ret;
+            continue;
         }
-        write_len += ret;
+
+        if ((ret == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+        {
+            if (mclagd_ctl_reply_queue(fd, w_buf + write_len, total_len - write_len) < 0)
+                return 0;
+            return total_len;
+        }
+
+        return 0;
     }
 
     return write_len;
@@ -3841,7 +4405,7 @@ void mclagd_ctl_handle_dump_state(int client_fd, int mclag_id)
     return;
 }
 
-void mclagd_ctl_handle_dump_arp(int client_fd, int mclag_id)
+void mclagd_ctl_handle_dump_arp(int client_fd, int mclag_id, const char *ifname)
 {
     char * Pbuf = NULL;
     char buf[512] = { 0 };
@@ -3850,7 +4414,7 @@ void mclagd_ctl_handle_dump_arp(int client_fd, int mclag_id)
     struct mclagd_reply_hdr *hd = NULL;
     int len_tmp = 0;
 
-    ret = iccp_arp_dump(&Pbuf, &arp_num, mclag_id);
+    ret = iccp_arp_dump(&Pbuf, &arp_num, mclag_id, ifname);
     if (ret != EXEC_TYPE_SUCCESS)
     {
         len_tmp = sizeof(struct mclagd_reply_hdr);
@@ -3881,7 +4445,7 @@ void mclagd_ctl_handle_dump_arp(int client_fd, int mclag_id)
     return;
 }
 
-void mclagd_ctl_handle_dump_ndisc(int client_fd, int mclag_id)
+void mclagd_ctl_handle_dump_ndisc(int client_fd, int mclag_id, const char *ifname)
 {
     char *Pbuf = NULL;
     char buf[512] = { 0 };
@@ -3890,7 +4454,7 @@ void mclagd_ctl_handle_dump_ndisc(int client_fd, int mclag_id)
     struct mclagd_reply_hdr *hd = NULL;
     int len_tmp = 0;
 
-    ret = iccp_ndisc_dump(&Pbuf, &ndisc_num, mclag_id);
+    ret = iccp_ndisc_dump(&Pbuf, &ndisc_num, mclag_id, ifname);
     if (ret != EXEC_TYPE_SUCCESS)
     {
         len_tmp = sizeof(struct mclagd_reply_hdr);
@@ -3921,7 +4485,7 @@ void mclagd_ctl_handle_dump_ndisc(int client_fd, int mclag_id)
     return;
 }
 
-void mclagd_ctl_handle_dump_mac(int client_fd, int mclag_id)
+void mclagd_ctl_handle_dump_mac(int client_fd, int mclag_id, int vid, const char *ifname)
 {
     char * Pbuf = NULL;
     char buf[512] = { 0 };
@@ -3930,7 +4494,7 @@ void mclagd_ctl_handle_dump_mac(int client_fd, int mclag_id)
     struct mclagd_reply_hdr *hd = NULL;
     int len_tmp = 0;
 
-    ret = iccp_mac_dump(&Pbuf, &mac_num, mclag_id);
+    ret = iccp_mac_dump(&Pbuf, &mac_num, mclag_id, vid, ifname);
     if (ret != EXEC_TYPE_SUCCESS)
     {
         len_tmp = sizeof(struct mclagd_reply_hdr);
@@ -3963,7 +4527,7 @@ void mclagd_ctl_handle_dump_mac(int client_fd, int mclag_id)
     return;
 }
 
-void mclagd_ctl_handle_dump_local_portlist(int client_fd, int mclag_id)
+void mclagd_ctl_handle_dump_local_portlist(int client_fd, int mclag_id, const char *ifname)
 {
     char * Pbuf = NULL;
     char buf[512] = { 0 };
@@ -3972,7 +4536,7 @@ void mclagd_ctl_handle_dump_local_portlist(int client_fd, int mclag_id)
     struct mclagd_reply_hdr *hd = NULL;
     int len_tmp = 0;
 
-    ret = iccp_local_if_dump(&Pbuf, &lif_num, mclag_id);
+    ret = iccp_local_if_dump(&Pbuf, &lif_num, mclag_id, ifname);
     if (ret != EXEC_TYPE_SUCCESS)
     {
         len_tmp = sizeof(struct mclagd_reply_hdr);
@@ -4155,6 +4719,9 @@ int mclagd_ctl_interactive_process(int client_fd)
         return MCLAG_ERROR;
 
     req = (struct mclagdctl_req_hdr*)buf;
+    /* para1 carries an interface filter, para2 a VLAN filter */
+    req->para1[sizeof(req->para1) - 1] = '\0';
+    req->para2[sizeof(req->para2) - 1] = '\0';
 
     ICCPD_LOG_DEBUG(__FUNCTION__, "Receive request %s from mclagdctl", mclagd_ctl_cmd_str(req->info_type));
 
@@ -4165,19 +4732,19 @@ int mclagd_ctl_interactive_process(int client_fd)
             break;
 
         case INFO_TYPE_DUMP_ARP:
-            mclagd_ctl_handle_dump_arp(client_fd, req->mclag_id);
+            mclagd_ctl_handle_dump_arp(client_fd, req->mclag_id, req->para1);
             break;
 
         case INFO_TYPE_DUMP_NDISC:
-            mclagd_ctl_handle_dump_ndisc(client_fd, req->mclag_id);
+            mclagd_ctl_handle_dump_ndisc(client_fd, req->mclag_id, req->para1);
             break;
 
         case INFO_TYPE_DUMP_MAC:
-            mclagd_ctl_handle_dump_mac(client_fd, req->mclag_id);
+            mclagd_ctl_handle_dump_mac(client_fd, req->mclag_id, atoi(req->para2), req->para1);
             break;
 
         case INFO_TYPE_DUMP_LOCAL_PORTLIST:
-            mclagd_ctl_handle_dump_local_portlist(client_fd, req->mclag_id);
+            mclagd_ctl_handle_dump_local_portlist(client_fd, req->mclag_id, req->para1);
             break;
 
         case INFO_TYPE_DUMP_PEER_PORTLIST:
@@ -4241,7 +4808,6 @@ int syn_local_mac_info_to_peer(struct CSM* csm, struct LocalInterface *local_if,
     ICCPD_LOG_DEBUG(__FUNCTION__,"mac [%02X:%02X:%02X:%02X:%02X:%02X]",
         mac_msg.mac_addr[0], mac_msg.mac_addr[1], mac_msg.mac_addr[2], mac_msg.mac_addr[3], mac_msg.mac_addr[4], mac_msg.mac_addr[5]);
 
-    memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
     msg_len = mlacp_prepare_for_mac_info_to_peer(csm, g_csm_buf, CSM_BUFFER_SIZE, &mac_msg, 0);
     if (msg_len > 0)
         rc = iccp_csm_send(csm, g_csm_buf, msg_len);
@@ -4285,7 +4851,6 @@ int syn_local_arp_info_to_peer(struct CSM* csm, struct LocalInterface *local_if,
     ICCPD_LOG_DEBUG(__FUNCTION__," mac [%02X:%02X:%02X:%02X:%02X:%02X]",
         arp_msg.mac_addr[0], arp_msg.mac_addr[1], arp_msg.mac_addr[2], arp_msg.mac_addr[3], arp_msg.mac_addr[4], arp_msg.mac_addr[5]);
 
-    memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
     msg_len = mlacp_prepare_for_arp_info(csm, g_csm_buf, CSM_BUFFER_SIZE, &arp_msg, 0, NEIGH_SYNC_SELF_IP);
     if (msg_len > 0)
         rc = iccp_csm_send(csm, g_csm_buf, msg_len);
@@ -4346,7 +4911,6 @@ int syn_local_nd_info_to_peer(struct CSM* csm, struct LocalInterface *local_if,
     ICCPD_LOG_DEBUG(__FUNCTION__,"mac [%02X:%02X:%02X:%02X:%02X:%02X]",
         nd_msg.mac_addr[0], nd_msg.mac_addr[1], nd_msg.mac_addr[2], nd_msg.mac_addr[3], nd_msg.mac_addr[4], nd_msg.mac_addr[5]);
 
-    memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
     msg_len = mlacp_prepare_for_ndisc_info(csm, g_csm_buf, CSM_BUFFER_SIZE, &nd_msg, 0, NEIGH_SYNC_SELF_IP);
     if (msg_len > 0)
         rc = iccp_csm_send(csm, g_csm_buf, msg_len);
@@ -66,7 +66,7 @@ int mlacp_prepare_for_sync_request_tlv(struct CSM* csm, char* buf, size_t max_bu
         return MCLAG_ERROR;
 
     /* Prepare for sync request */
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     icc_hdr = (ICCHdr*)buf;
     tlv = (mLACPSyncReqTLV*)&buf[sizeof(ICCHdr)];
@@ -122,7 +122,7 @@ int mlacp_prepare_for_sync_data_tlv(struct CSM* csm, char* buf, size_t max_buf_s
         return MCLAG_ERROR;
 
     /* Prepare for sync request */
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     icc_hdr = (ICCHdr*)buf;
     tlv = (mLACPSyncDataTLV*)&buf[sizeof(ICCHdr)];
@@ -170,7 +170,7 @@ int mlacp_prepare_for_sys_config(struct CSM* csm, char* buf, size_t max_buf_size
         return MCLAG_ERROR;
 
     /* Prepare for sync request */
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     icc_hdr = (ICCHdr*)buf;
     tlv = (mLACPSysConfigTLV*)&buf[sizeof(ICCHdr)];
@@ -221,7 +221,7 @@ int mlacp_prepare_for_Aggport_state(struct CSM* csm, char* buf, size_t max_buf_s
         return MCLAG_ERROR;
 
     /* Prepare for sync request */
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     icc_hdr = (ICCHdr*)buf;
     tlv = (mLACPAggPortStateTLV*)&buf[sizeof(ICCHdr)];
@@ -268,7 +268,7 @@ int mlacp_prepare_for_Aggport_config(struct CSM* csm,
         return MCLAG_ERROR;
 
     /* Prepare for sync request */
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     icc_hdr = (ICCHdr*)buf;
     tlv = (mLACPAggConfigTLV*)&buf[sizeof(ICCHdr)];
@@ -318,6 +318,9 @@ int mlacp_prepare_for_mac_info_to_peer(struct CSM* csm, char* buf, size_t max_bu
     if ((msg_len = sizeof(ICCHdr) + tlv_len) > max_buf_size)
         return MCLAG_ERROR;
 
+    if (count == 0)
+        memset(buf, 0, sizeof(ICCHdr) + sizeof(struct mLACPMACInfoTLV));
+
     /* ICC header */
     icc_hdr = (ICCHdr*)buf;
     mlacp_fill_icc_header(csm, icc_hdr, msg_len);
@@ -333,7 +336,9 @@ int mlacp_prepare_for_mac_info_to_peer(struct CSM* csm, char* buf, size_t max_bu
         tlv->icc_parameter.type = htons(TLV_T_MLACP_MAC_INFO);
     }
 
+    /* Only the new entry is cleared, earlier ones are already in buf */
     MacData = (struct mLACPMACData *)&buf[sizeof(ICCHdr) + sizeof(struct mLACPMACInfoTLV) + sizeof(struct mLACPMACData) * count];
+    memset(MacData, 0, sizeof(struct mLACPMACData));
     MacData->type = mac_msg->op_type;
     MacData->mac_type = mac_msg->fdb_type;
     memcpy(MacData->mac_addr, mac_msg->mac_addr,ETHER_ADDR_LEN);
@@ -368,6 +373,9 @@ int mlacp_prepare_for_arp_info(struct CSM* csm, char* buf, size_t max_buf_size,
     if ((msg_len = sizeof(ICCHdr) + tlv_len) > max_buf_size)
         return MCLAG_ERROR;
 
+    if (count == 0)
+        memset(buf, 0, sizeof(ICCHdr) + sizeof(struct mLACPARPInfoTLV));
+
     /* ICC header */
     icc_hdr = (ICCHdr*)buf;
     mlacp_fill_icc_header(csm, icc_hdr, msg_len);
@@ -384,7 +392,9 @@ int mlacp_prepare_for_arp_info(struct CSM* csm, char* buf, size_t max_buf_size,
         tlv->icc_parameter.type = htons(TLV_T_MLACP_ARP_INFO);
     }
 
+    /* Only the new entry is cleared, earlier ones are already in buf */
     ArpData = (struct ARPMsg *)&buf[sizeof(ICCHdr) + sizeof(struct mLACPARPInfoTLV) + sizeof(struct ARPMsg) * count];
+    memset(ArpData, 0, sizeof(struct ARPMsg));
 
     ArpData->op_type = arp_msg->op_type;
     ArpData->flag = arp_msg->flag;
@@ -421,6 +431,9 @@ int mlacp_prepare_for_ndisc_info(struct CSM *csm, char *buf, size_t max_buf_size
     if ((msg_len = sizeof(ICCHdr) + tlv_len) > max_buf_size)
         return -1;
 
+    if (count == 0)
+        memset(buf, 0, sizeof(ICCHdr) + sizeof(struct mLACPNDISCInfoTLV));
+
     /* ICC header */
     icc_hdr = (ICCHdr *)buf;
     mlacp_fill_icc_header(csm, icc_hdr, msg_len);
@@ -437,7 +450,9 @@ int mlacp_prepare_for_ndisc_info(struct CSM *csm, char *buf, size_t max_buf_size
         tlv->icc_parameter.type = htons(TLV_T_MLACP_NDISC_INFO);
     }
 
+    /* Only the new entry is cleared, earlier ones are already in buf */
     NdiscData = (struct NDISCMsg *)&buf[sizeof(ICCHdr) + sizeof(struct mLACPNDISCInfoTLV) + sizeof(struct NDISCMsg) * count];
+    memset(NdiscData, 0, sizeof(struct NDISCMsg));
 
     NdiscData->op_type = ndisc_msg->op_type;
     NdiscData->flag = ndisc_msg->flag;
@@ -492,7 +507,7 @@ int mlacp_prepare_for_port_channel_info(struct CSM* csm, char* buf,
         return MCLAG_ERROR;
 
     /* Prepare for port channel info */
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     icc_hdr = (ICCHdr*)buf;
     tlv = (struct mLACPPortChannelInfoTLV*)&buf[sizeof(ICCHdr)];
@@ -556,14 +571,14 @@ int mlacp_prepare_for_port_peerlink_info(struct CSM* csm, char* buf,
     if ((sys = system_get_instance()) == NULL )
         return MCLAG_ERROR;
 
-    /* Prepare for port channel info */
-    memset(buf, 0, max_buf_size);
-
     tlv_len = sizeof(struct mLACPPeerLinkInfoTLV);
 
     if ((msg_len = sizeof(ICCHdr) + tlv_len) > max_buf_size)
         return MCLAG_ERROR;
 
+    /* Prepare for port channel info */
+    memset(buf, 0, msg_len);
+
     icc_hdr = (ICCHdr*)buf;
     tlv = (struct mLACPPeerLinkInfoTLV*)&buf[sizeof(ICCHdr)];
 
@@ -609,7 +624,7 @@ int mlacp_prepare_for_heartbeat(struct CSM* csm, char* buf, size_t max_buf_size)
         return MCLAG_ERROR;
 
     /* Prepare for sync request */
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     icc_hdr = (ICCHdr*)buf;
     tlv = (struct mLACPHeartbeatTLV*)&buf[sizeof(ICCHdr)];
@@ -651,7 +666,7 @@ int mlacp_prepare_for_warm_reboot(struct CSM* csm, char* buf, size_t max_buf_siz
         return MCLAG_ERROR;
 
     /* Prepare for sync request */
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     icc_hdr = (ICCHdr*)buf;
     tlv = (struct mLACPWarmbootTLV*)&buf[sizeof(ICCHdr)];
@@ -700,7 +715,7 @@ int mlacp_prepare_for_if_up_ack(
         return -1;
 
     /* Prepare for sync request */
-    memset(buf, 0, max_buf_size);
+    memset(buf, 0, msg_len);
 
     icc_hdr = (ICCHdr*) buf;
     tlv = (struct mLACPIfUpAckTLV*) &buf[sizeof(ICCHdr)];
@@ -723,6 +738,44 @@ int mlacp_prepare_for_if_up_ack(
     return msg_len;
 }
 
+/*****************************************
+* Prepare MAC digest message
+*
+* ***************************************/
+int mlacp_prepare_for_mac_digest(struct CSM* csm, char* buf, size_t max_buf_size, uint32_t* digest)
+{
+    ICCHdr* icc_hdr = (ICCHdr*)buf;
+    struct mLACPMACDigestTLV* tlv = (struct mLACPMACDigestTLV*)&buf[sizeof(ICCHdr)];
+    size_t msg_len = sizeof(ICCHdr) + sizeof(struct mLACPMACDigestTLV);
+    int i;
+
+    if (csm == NULL)
+        return MCLAG_ERROR;
+
+    if (buf == NULL || digest == NULL)
+        return MCLAG_ERROR;
+
+    if (msg_len > max_buf_size)
+        return MCLAG_ERROR;
+
+    memset(buf, 0, msg_len);
+
+    /* ICC header */
+    mlacp_fill_icc_header(csm, icc_hdr, msg_len);
+
+    /* MAC digest TLV */
+    tlv->icc_parameter.u_bit = 0;
+    tlv->icc_parameter.f_bit = 0;
+    tlv->icc_parameter.type = htons(TLV_T_MLACP_MAC_DIGEST);
+    tlv->icc_parameter.len = htons(sizeof(struct mLACPMACDigestTLV) - sizeof(ICCParameter));
+
+    tlv->num_buckets = htons(MLACP_MAC_DIGEST_BUCKETS);
+    for (i = 0; i < MLACP_MAC_DIGEST_BUCKETS; i++)
+        tlv->digest[i] = htonl(digest[i]);
+
+    return msg_len;
+}
+
 /*****************************************
 * Tool : Prepare ICC Header
 *
@@ -132,7 +132,7 @@ int mlacp_fsm_update_Agg_conf(struct CSM* csm, mLACPAggConfigTLV* portconf)
     }
 
     pif->po_id = ntohs(portconf->agg_id);
-    memcpy(pif->name, portconf->agg_name, portconf->agg_name_len);
+    peer_if_set_name(pif, portconf->agg_name, portconf->agg_name_len);
     memcpy(pif->mac_addr, portconf->mac_addr, ETHER_ADDR_LEN);
 
     po_active = (pif->state == PORT_STATE_UP);
@@ -254,6 +254,7 @@ int mlacp_fsm_update_mac_entry_from_peer( struct CSM* csm, struct mLACPMACData *
     //if (strcmp(mac_msg->mac_str, MacData->mac_str) == 0 && mac_msg->vid == ntohs(MacData->vid))
     if (mac_msg)
     {
+        mac_msg->warm_restored = 0;
         ICCPD_LOG_DEBUG("ICCP_FDB", "Recv MAC update from peer RB_FIND success, existing MAC age flag:%d interface %s, "
             "MAC %s vlan-id %d, fdb_type: %d, op_type %s", mac_msg->age_flag, mac_msg->ifname,
             mac_addr_to_str(mac_msg->mac_addr), mac_msg->vid, mac_msg->fdb_type,
@@ -361,7 +362,7 @@ int mlacp_fsm_update_mac_entry_from_peer( struct CSM* csm, struct mLACPMACData *
                             // else free is taken care after sending the update to peer
                             if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_msg, tail))
                             {
-                                free(mac_msg);
+                                iccp_csm_free_mac_msg(mac_msg);
                             }
 
                             ICCPD_LOG_ERR(__FUNCTION__, "Ignore Recv MAC ADD "
@@ -467,7 +468,7 @@ int mlacp_fsm_update_mac_entry_from_peer( struct CSM* csm, struct mLACPMACData *
             // else free is taken care after sending the update to peer
             if (!MAC_IN_MSG_LIST(&(MLACP(csm).mac_msg_list), mac_msg, tail))
             {
-                free(mac_msg);
+                iccp_csm_free_mac_msg(mac_msg);
             }
         }
         else
@@ -500,7 +501,7 @@ int mlacp_fsm_update_mac_entry_from_peer( struct CSM* csm, struct mLACPMACData *
                 {
                     ICCPD_LOG_DEBUG("ICCP_FDB", "Recv MAC ADD from peer: Ignore MAC learn on orphan port "
                         "peer-link is not configured interface %s, MAC %s vlan-id %d, "
-                        " op_type %d", from_mclag_intf, mac_msg->ifname,
+                        " op_type %d", mac_msg->ifname,
                         mac_addr_to_str(mac_msg->mac_addr),
                         mac_msg->vid, mac_msg->op_type);
                     return 0;
@@ -568,6 +569,26 @@ int mlacp_fsm_update_mac_info_from_peer(struct CSM* csm, struct mLACPMACInfoTLV*
     }
 }
 
+/*****************************************
+ * Tool : ARP/ND index bucket of an IP address
+ *
+ ****************************************/
+static uint32_t mlacp_neigh_hash(const void *addr, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)addr;
+    uint32_t hash = 2166136261U;
+    size_t i;
+
+    /* FNV-1a, bytewise since peer TLV entries may be unaligned */
+    for (i = 0; i < len; i++)
+    {
+        hash ^= p[i];
+        hash *= 16777619U;
+    }
+
+    return hash & (MLACP_NEIGH_HASH_SIZE - 1);
+}
+
 /*****************************************
  * Tool : Add ARP Info into ARP list
  *
@@ -575,11 +596,12 @@ int mlacp_fsm_update_mac_info_from_peer(struct CSM* csm, struct mLACPMACInfoTLV*
 void mlacp_enqueue_arp(struct CSM* csm, struct Msg* msg)
 {
     struct ARPMsg *arp_msg = NULL;
+    uint32_t idx;
 
     if (!csm)
     {
         if (msg)
-            free(msg);
+            iccp_csm_free_msg(msg);
         return;
     }
     if (!msg)
@@ -589,6 +611,9 @@ void mlacp_enqueue_arp(struct CSM* csm, struct Msg* msg)
     if (arp_msg->op_type != NEIGH_SYNC_DEL)
     {
         TAILQ_INSERT_TAIL(&(MLACP(csm).arp_list), msg, tail);
+        idx = mlacp_neigh_hash(&arp_msg->ipv4_addr, sizeof(arp_msg->ipv4_addr));
+        msg->hash_next = MLACP(csm).arp_hash[idx];
+        MLACP(csm).arp_hash[idx] = msg;
     }
 
     return;
@@ -601,11 +626,12 @@ void mlacp_enqueue_arp(struct CSM* csm, struct Msg* msg)
 void mlacp_enqueue_ndisc(struct CSM *csm, struct Msg *msg)
 {
     struct NDISCMsg *ndisc_msg = NULL;
+    uint32_t idx;
 
     if (!csm)
     {
         if (msg)
-            free(msg);
+            iccp_csm_free_msg(msg);
         return;
     }
     if (!msg)
@@ -615,11 +641,114 @@ void mlacp_enqueue_ndisc(struct CSM *csm, struct Msg *msg)
     if (ndisc_msg->op_type != NEIGH_SYNC_DEL)
     {
         TAILQ_INSERT_TAIL(&(MLACP(csm).ndisc_list), msg, tail);
+        idx = mlacp_neigh_hash(ndisc_msg->ipv6_addr, sizeof(ndisc_msg->ipv6_addr));
+        msg->hash_next = MLACP(csm).ndisc_hash[idx];
+        MLACP(csm).ndisc_hash[idx] = msg;
     }
 
     return;
 }
 
+/*****************************************
+ * Tool : Unlink a Msg from an ARP/ND index bucket
+ *
+ ****************************************/
+static void mlacp_neigh_hash_unlink(struct Msg **bucket, struct Msg *msg)
+{
+    while (*bucket)
+    {
+        if (*bucket == msg)
+        {
+            *bucket = msg->hash_next;
+            msg->hash_next = NULL;
+            return;
+        }
+        bucket = &(*bucket)->hash_next;
+    }
+}
+
+/*****************************************
+ * Tool : Remove ARP Info from ARP list, caller frees it
+ *
+ ****************************************/
+void mlacp_dequeue_arp(struct CSM* csm, struct Msg* msg)
+{
+    struct ARPMsg *arp_msg = NULL;
+    uint32_t idx;
+
+    if (!csm || !msg)
+        return;
+
+    arp_msg = (struct ARPMsg*)msg->buf;
+    idx = mlacp_neigh_hash(&arp_msg->ipv4_addr, sizeof(arp_msg->ipv4_addr));
+    mlacp_neigh_hash_unlink(&MLACP(csm).arp_hash[idx], msg);
+    TAILQ_REMOVE(&(MLACP(csm).arp_list), msg, tail);
+}
+
+/*****************************************
+ * Tool : Remove Ndisc Info from ndisc list, caller frees it
+ *
+ ****************************************/
+void mlacp_dequeue_ndisc(struct CSM *csm, struct Msg *msg)
+{
+    struct NDISCMsg *ndisc_msg = NULL;
+    uint32_t idx;
+
+    if (!csm || !msg)
+        return;
+
+    ndisc_msg = (struct NDISCMsg *)msg->buf;
+    idx = mlacp_neigh_hash(ndisc_msg->ipv6_addr, sizeof(ndisc_msg->ipv6_addr));
+    mlacp_neigh_hash_unlink(&MLACP(csm).ndisc_hash[idx], msg);
+    TAILQ_REMOVE(&(MLACP(csm).ndisc_list), msg, tail);
+}
+
+/*****************************************
+ * Tool : Find ARP Info by IPv4 address (net order)
+ *
+ ****************************************/
+struct Msg* mlacp_arp_find(struct CSM* csm, uint32_t ipv4_addr)
+{
+    struct Msg *msg = NULL;
+    struct ARPMsg *arp_msg = NULL;
+
+    if (!csm)
+        return NULL;
+
+    msg = MLACP(csm).arp_hash[mlacp_neigh_hash(&ipv4_addr, sizeof(ipv4_addr))];
+    for (; msg; msg = msg->hash_next)
+    {
+        arp_msg = (struct ARPMsg*)msg->buf;
+        if (arp_msg->ipv4_addr == ipv4_addr)
+            return msg;
+    }
+
+    return NULL;
+}
+
+/*****************************************
+ * Tool : Find Ndisc Info by IPv6 address
+ *
+ ****************************************/
+struct Msg* mlacp_ndisc_find(struct CSM *csm, const void *ipv6_addr)
+{
+    struct Msg *msg = NULL;
+    struct NDISCMsg *ndisc_msg = NULL;
+
+    if (!csm)
+        return NULL;
+
+    msg = MLACP(csm).ndisc_hash[mlacp_neigh_hash(ipv6_addr, 16)];
+    for (; msg; msg = msg->hash_next)
+    {
+        ndisc_msg = (struct NDISCMsg *)msg->buf;
+        if (memcmp(ndisc_msg->ipv6_addr, ipv6_addr, 16) == 0)
+            return msg;
+    }
+
+    return NULL;
+}
+
 /*****************************************
 * ARP-Info Update
 * ***************************************/
@@ -795,7 +924,10 @@ int mlacp_fsm_update_arp_entry(struct CSM* csm, struct ARPMsg *arp_entry)
 
         if (arp_entry->op_type == NEIGH_SYNC_ADD)
         {
-            err = iccp_netlink_neighbor_request(AF_INET, (uint8_t *)&arp_entry->ipv4_addr, 1, arp_entry->mac_addr, arp_entry->ifname, permanent_neigh, 8);
+            /* The ACK goes to the peer once the kernel has the entry, and
+             * the list entry added below is dropped if the kernel refuses it */
+            err = iccp_netlink_peer_neighbor_add(AF_INET, (uint8_t *)&arp_entry->ipv4_addr, arp_entry->mac_addr, arp_entry->ifname, permanent_neigh, 8,
+                                                 (arp_entry->flag & NEIGH_SYNC_FLAG_ACK) ? 0 : -1);
             if (err < 0)
             {
                 if (err != ICCP_NLE_SEQ_MISMATCH) {
@@ -804,12 +936,6 @@ int mlacp_fsm_update_arp_entry(struct CSM* csm, struct ARPMsg *arp_entry)
                     return MCLAG_ERROR;
                 }
             }
-
-           if (arp_entry->flag & NEIGH_SYNC_FLAG_ACK)
-           {
-               ICCPD_LOG_DEBUG(__FUNCTION__,"Sync ARP on ACK ");
-               syn_ack_local_neigh_mac_info_to_peer(arp_entry->ifname, 0);
-           }
         }
         else
         {
@@ -841,24 +967,20 @@ int mlacp_fsm_update_arp_entry(struct CSM* csm, struct ARPMsg *arp_entry)
     }
 
     /* update ARP list*/
-    TAILQ_FOREACH(msg, &(MLACP(csm).arp_list), tail)
+    msg = mlacp_arp_find(csm, arp_entry->ipv4_addr);
+    if (msg)
     {
         arp_msg = (struct ARPMsg*)msg->buf;
-        if (arp_msg->ipv4_addr == arp_entry->ipv4_addr)
-        {
-            /*arp_msg->op_type = tlv->type;*/
-            sprintf(arp_msg->ifname, "%s", arp_entry->ifname);
-            memcpy(arp_msg->mac_addr, arp_entry->mac_addr, ETHER_ADDR_LEN);
-            break;
-        }
+        /*arp_msg->op_type = tlv->type;*/
+        sprintf(arp_msg->ifname, "%s", arp_entry->ifname);
+        memcpy(arp_msg->mac_addr, arp_entry->mac_addr, ETHER_ADDR_LEN);
     }
 
     /* delete/add ARP list*/
     if (msg && arp_entry->op_type == NEIGH_SYNC_DEL)
     {
-        TAILQ_REMOVE(&(MLACP(csm).arp_list), msg, tail);
-        free(msg->buf);
-        free(msg);
+        mlacp_dequeue_arp(csm, msg);
+        iccp_csm_free_msg(msg);
         /*ICCPD_LOG_INFO(__FUNCTION__, "Del arp queue successfully");*/
     }
     else if (!msg && arp_entry->op_type == NEIGH_SYNC_ADD)
@@ -889,8 +1011,7 @@ int mlacp_fsm_update_arp_entry(struct CSM* csm, struct ARPMsg *arp_entry)
     {
         arp_msg = (struct ARPMsg*)msg->buf;
         TAILQ_REMOVE(&(MLACP(csm).arp_msg_list), msg, tail);
-        free(msg->buf);
-        free(msg);
+        iccp_csm_free_msg(msg);
         TAILQ_FOREACH(msg, &(MLACP(csm).arp_msg_list), tail)
         {
             arp_msg = (struct ARPMsg*)msg->buf;
@@ -1118,7 +1239,10 @@ int mlacp_fsm_update_ndisc_entry(struct CSM *csm, struct NDISCMsg *ndisc_entry)
 
         if (ndisc_entry->op_type == NEIGH_SYNC_ADD)
         {
-            err = iccp_netlink_neighbor_request(AF_INET6, (uint8_t *)ndisc_entry->ipv6_addr, 1, ndisc_entry->mac_addr, ndisc_entry->ifname, permanent_neigh, 10);
+            /* The ACK goes to the peer once the kernel has the entry, and
+             * the list entry added below is dropped if the kernel refuses it */
+            err = iccp_netlink_peer_neighbor_add(AF_INET6, (uint8_t *)ndisc_entry->ipv6_addr, ndisc_entry->mac_addr, ndisc_entry->ifname, permanent_neigh, 10,
+                                                 (ndisc_entry->flag & NEIGH_SYNC_FLAG_ACK) ? is_ack_ll : -1);
             if (err < 0)
             {
                 if (err != ICCP_NLE_SEQ_MISMATCH) {
@@ -1127,12 +1251,6 @@ int mlacp_fsm_update_ndisc_entry(struct CSM *csm, struct NDISCMsg *ndisc_entry)
                     return MCLAG_ERROR;
                 }
             }
-
-           if (ndisc_entry->flag & NEIGH_SYNC_FLAG_ACK)
-           {
-               ICCPD_LOG_DEBUG(__FUNCTION__,"Sync ND on ACK ");
-               syn_ack_local_neigh_mac_info_to_peer(ndisc_entry->ifname, is_ack_ll);
-           }
         }
         else
         {
@@ -1163,24 +1281,20 @@ int mlacp_fsm_update_ndisc_entry(struct CSM *csm, struct NDISCMsg *ndisc_entry)
     }
 
     /* update NDISC list */
-    TAILQ_FOREACH(msg, &(MLACP(csm).ndisc_list), tail)
+    msg = mlacp_ndisc_find(csm, ndisc_entry->ipv6_addr);
+    if (msg)
     {
         ndisc_msg = (struct NDISCMsg *)msg->buf;
-        if (memcmp((char *)ndisc_msg->ipv6_addr, (char *)ndisc_entry->ipv6_addr, 16) == 0)
-        {
-            /* ndisc_msg->op_type = tlv->type; */
-            sprintf(ndisc_msg->ifname, "%s", ndisc_entry->ifname);
-            memcpy(ndisc_msg->mac_addr, ndisc_entry->mac_addr, ETHER_ADDR_LEN);
-            break;
-        }
+        /* ndisc_msg->op_type = tlv->type; */
+        sprintf(ndisc_msg->ifname, "%s", ndisc_entry->ifname);
+        memcpy(ndisc_msg->mac_addr, ndisc_entry->mac_addr, ETHER_ADDR_LEN);
     }
 
     /* delete/add NDISC list */
     if (msg && ndisc_entry->op_type == NEIGH_SYNC_DEL)
     {
-        TAILQ_REMOVE(&(MLACP(csm).ndisc_list), msg, tail);
-        free(msg->buf);
-        free(msg);
+        mlacp_dequeue_ndisc(csm, msg);
+        iccp_csm_free_msg(msg);
         /* ICCPD_LOG_INFO(__FUNCTION__, "Del ndisc queue successfully"); */
     }
     else if (!msg && ndisc_entry->op_type == NEIGH_SYNC_ADD)
@@ -1211,8 +1325,7 @@ int mlacp_fsm_update_ndisc_entry(struct CSM *csm, struct NDISCMsg *ndisc_entry)
     {
         ndisc_msg = (struct NDISCMsg *)msg->buf;
         TAILQ_REMOVE(&(MLACP(csm).ndisc_msg_list), msg, tail);
-        free(msg->buf);
-        free(msg);
+        iccp_csm_free_msg(msg);
         TAILQ_FOREACH(msg, &(MLACP(csm).ndisc_msg_list), tail)
         {
             ndisc_msg = (struct NDISCMsg *)msg->buf;
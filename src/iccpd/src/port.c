@@ -46,6 +46,91 @@ static int vlan_node_compare(const struct VLAN_ID *p_vlan_node1, const struct VL
 }
 RB_GENERATE(vlan_rb_tree, VLAN_ID, vlan_entry, vlan_node_compare);
 
+/*****************************************
+ * Tool : Interface hash indexes
+ *
+ ****************************************/
+static uint32_t if_name_hash(const char* name)
+{
+    uint32_t hash = 2166136261U;
+    int i;
+
+    for (i = 0; i < MAX_L_PORT_NAME && name[i]; ++i)
+    {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619U;
+    }
+
+    return hash & (IF_HASH_SIZE - 1);
+}
+
+#define IF_ID_HASH(id)  ((uint32_t)(id) & (IF_HASH_SIZE - 1))
+
+static void local_if_hash_add(struct System* sys, struct LocalInterface* lif)
+{
+    uint32_t idx;
+
+    idx = if_name_hash(lif->name);
+    lif->name_hash_next = sys->lif_name_hash[idx];
+    sys->lif_name_hash[idx] = lif;
+
+    idx = IF_ID_HASH(lif->ifindex);
+    lif->ifindex_hash_next = sys->lif_ifindex_hash[idx];
+    sys->lif_ifindex_hash[idx] = lif;
+
+    if (lif->type == IF_T_PORT_CHANNEL)
+    {
+        idx = IF_ID_HASH(lif->po_id);
+        lif->po_hash_next = sys->lif_po_hash[idx];
+        sys->lif_po_hash[idx] = lif;
+    }
+}
+
+static void local_if_hash_del_ifindex(struct System* sys, struct LocalInterface* lif)
+{
+    struct LocalInterface** pp;
+
+    for (pp = &sys->lif_ifindex_hash[IF_ID_HASH(lif->ifindex)]; *pp; pp = &(*pp)->ifindex_hash_next)
+    {
+        if (*pp == lif)
+        {
+            *pp = lif->ifindex_hash_next;
+            break;
+        }
+    }
+    lif->ifindex_hash_next = NULL;
+}
+
+static void local_if_hash_del(struct System* sys, struct LocalInterface* lif)
+{
+    struct LocalInterface** pp;
+
+    for (pp = &sys->lif_name_hash[if_name_hash(lif->name)]; *pp; pp = &(*pp)->name_hash_next)
+    {
+        if (*pp == lif)
+        {
+            *pp = lif->name_hash_next;
+            break;
+        }
+    }
+    lif->name_hash_next = NULL;
+
+    local_if_hash_del_ifindex(sys, lif);
+
+    if (lif->type == IF_T_PORT_CHANNEL)
+    {
+        for (pp = &sys->lif_po_hash[IF_ID_HASH(lif->po_id)]; *pp; pp = &(*pp)->po_hash_next)
+        {
+            if (*pp == lif)
+            {
+                *pp = lif->po_hash_next;
+                break;
+            }
+        }
+        lif->po_hash_next = NULL;
+    }
+}
+
 void local_if_init(struct LocalInterface* local_if)
 {
     if (local_if == NULL)
@@ -165,6 +250,7 @@ struct LocalInterface* local_if_create(int ifindex, char* ifname, int type, uint
                    local_if->mac_addr[3], local_if->mac_addr[4], local_if->mac_addr[5], local_if->state ? "down" : "up");
 
     LIST_INSERT_HEAD(&(sys->lif_list), local_if, system_next);
+    local_if_hash_add(sys, local_if);
 
     //if there is pending vlan membership for this interface move to system lif
     move_pending_vlan_mbr_to_lif(sys, local_if);
@@ -202,7 +288,7 @@ struct LocalInterface* local_if_find_by_name(const char* ifname)
     if (!(sys = system_get_instance()))
         return NULL;
 
-    LIST_FOREACH(local_if, &(sys->lif_list), system_next)
+    for (local_if = sys->lif_name_hash[if_name_hash(ifname)]; local_if; local_if = local_if->name_hash_next)
     {
         if (strcmp(local_if->name, ifname) == 0)
             return local_if;
@@ -219,7 +305,7 @@ struct LocalInterface* local_if_find_by_ifindex(int ifindex)
     if ((sys = system_get_instance()) == NULL)
         return NULL;
 
-    LIST_FOREACH(local_if, &(sys->lif_list), system_next)
+    for (local_if = sys->lif_ifindex_hash[IF_ID_HASH(ifindex)]; local_if; local_if = local_if->ifindex_hash_next)
     {
         if (local_if->ifindex == ifindex)
             return local_if;
@@ -236,15 +322,31 @@ struct LocalInterface* local_if_find_by_po_id(int po_id)
     if ((sys = system_get_instance()) == NULL)
         return NULL;
 
-    LIST_FOREACH(local_if, &(sys->lif_list), system_next)
+    for (local_if = sys->lif_po_hash[IF_ID_HASH(po_id)]; local_if; local_if = local_if->po_hash_next)
     {
-        if (local_if->type == IF_T_PORT_CHANNEL && local_if->po_id == po_id)
+        if (local_if->po_id == po_id)
             return local_if;
     }
 
     return NULL;
 }
 
+/* Change the ifindex of a local interface, keeping its index current */
+void local_if_set_ifindex(struct LocalInterface* lif, int ifindex)
+{
+    struct System* sys = NULL;
+    uint32_t idx;
+
+    if (lif == NULL || (sys = system_get_instance()) == NULL)
+        return;
+
+    local_if_hash_del_ifindex(sys, lif);
+    lif->ifindex = ifindex;
+    idx = IF_ID_HASH(lif->ifindex);
+    lif->ifindex_hash_next = sys->lif_ifindex_hash[idx];
+    sys->lif_ifindex_hash[idx] = lif;
+}
+
  void local_if_vlan_remove(struct LocalInterface *lif_vlan)
 {
     struct System *sys = NULL;
@@ -365,6 +467,7 @@ void local_if_destroy(char *ifname)
 to_sys_purge:
     /* sys purge */
     LIST_REMOVE(lif, system_next);
+    local_if_hash_del(sys, lif);
     if (lif->csm)
         LIST_REMOVE(lif, mlacp_next);
     LIST_INSERT_HEAD(&(sys->lif_purge_list), lif, system_purge_next);
@@ -373,6 +476,7 @@ to_sys_purge:
 to_mlacp_purge:
     /* sys & mlacp purge */
     LIST_REMOVE(lif, system_next);
+    local_if_hash_del(sys, lif);
     LIST_REMOVE(lif, mlacp_next);
     LIST_INSERT_HEAD(&(sys->lif_purge_list), lif, system_purge_next);
     LIST_INSERT_HEAD(&(MLACP(csm).lif_purge_list), lif, mlacp_purge_next);
@@ -490,7 +594,7 @@ struct PeerInterface* peer_if_create(struct CSM* csm,
     if (type != IF_T_PORT && type != IF_T_PORT_CHANNEL)
     {
         ICCPD_LOG_WARN(__FUNCTION__,
-                       "The type(%) of peer interface(%d) is not acceptable",
+                       "The type(%d) of peer interface(%d) is not acceptable",
                        type, peer_if_number);
         return NULL;
     }
@@ -507,15 +611,18 @@ struct PeerInterface* peer_if_create(struct CSM* csm,
     {
         peer_if->ifindex = peer_if_number;
         peer_if->type = IF_T_PORT;
-        peer_if->csm = csm;
     }
     else if (type == IF_T_PORT_CHANNEL)
     {
         peer_if->ifindex = peer_if_number;
         peer_if->type = IF_T_PORT_CHANNEL;
     }
+    /* needed to keep the CSM name index current */
+    peer_if->csm = csm;
 
     LIST_INSERT_HEAD(&(MLACP(csm).pif_list), peer_if, mlacp_next);
+    peer_if->name_hash_next = MLACP(csm).pif_name_hash[if_name_hash(peer_if->name)];
+    MLACP(csm).pif_name_hash[if_name_hash(peer_if->name)] = peer_if;
 
     return peer_if;
 }
@@ -531,7 +638,7 @@ struct PeerInterface* peer_if_find_by_name(struct CSM* csm, char* name)
     if (csm == NULL)
         return NULL;
 
-    LIST_FOREACH(peer_if, &(csm->app_csm.mlacp.pif_list), mlacp_next)
+    for (peer_if = MLACP(csm).pif_name_hash[if_name_hash(name)]; peer_if; peer_if = peer_if->name_hash_next)
     {
         if (strcmp(peer_if->name, name) == 0)
             return peer_if;
@@ -540,6 +647,37 @@ struct PeerInterface* peer_if_find_by_name(struct CSM* csm, char* name)
     return NULL;
 }
 
+static void peer_if_hash_del(struct PeerInterface* pif)
+{
+    struct PeerInterface** pp;
+
+    for (pp = &MLACP(pif->csm).pif_name_hash[if_name_hash(pif->name)]; *pp; pp = &(*pp)->name_hash_next)
+    {
+        if (*pp == pif)
+        {
+            *pp = pif->name_hash_next;
+            break;
+        }
+    }
+    pif->name_hash_next = NULL;
+}
+
+/* Change the name of a peer interface, keeping its index current */
+void peer_if_set_name(struct PeerInterface* pif, const char* name, size_t len)
+{
+    uint32_t idx;
+
+    if (pif == NULL || name == NULL || len > MAX_L_PORT_NAME)
+        return;
+
+    peer_if_hash_del(pif);
+    memset(pif->name, 0, MAX_L_PORT_NAME);
+    memcpy(pif->name, name, len);
+    idx = if_name_hash(pif->name);
+    pif->name_hash_next = MLACP(pif->csm).pif_name_hash[idx];
+    MLACP(pif->csm).pif_name_hash[idx] = pif;
+}
+
 void peer_if_del_all_vlan(struct PeerInterface* pif)
 {
     struct VLAN_ID *vlan = NULL;
@@ -561,6 +699,7 @@ void peer_if_destroy(struct PeerInterface* pif)
 
     /* destroy if*/
     LIST_REMOVE(pif, mlacp_next);
+    peer_if_hash_del(pif);
     peer_if_del_all_vlan(pif);
 
     free(pif);
@@ -719,28 +858,28 @@ int peer_if_clean_unused_vlan(struct PeerInterface* peer_if)
 int set_sys_arp_accept_flag(char* ifname, int flag)
 {
     FILE *file_ptr = NULL;
-    char cmd[64];
     char arp_file[64];
     char buf[2];
     int result = MCLAG_ERROR;
 
     memset(arp_file, 0, 64);
     snprintf(arp_file, 63, "/proc/sys/net/ipv4/conf/%s/arp_accept", ifname);
-    if (!(file_ptr = fopen(arp_file, "r")))
+    if (!(file_ptr = fopen(arp_file, "r+")))
     {
         ICCPD_LOG_WARN(__func__, "Failed to find device %s from %s", ifname, arp_file);
         return result;
     }
 
-    fgets(buf, sizeof(buf), file_ptr);
-    if (atoi(buf) == flag)
+    if (fgets(buf, sizeof(buf), file_ptr) && atoi(buf) == flag)
         result = 0;
     else
     {
-        memset(cmd, 0, 64);
-        snprintf(cmd, 63, "echo %d > /proc/sys/net/ipv4/conf/%s/arp_accept", flag, ifname);
-        if (system(cmd))
-            ICCPD_LOG_WARN(__func__, "Failed to execute cmd = %s", cmd);
+        /* Write the sysctl directly instead of forking a shell */
+        rewind(file_ptr);
+        if (fprintf(file_ptr, "%d\n", flag) < 0 || fflush(file_ptr) != 0)
+            ICCPD_LOG_WARN(__func__, "Failed to set %s to %d", arp_file, flag);
+        else
+            result = 0;
     }
 
     fclose(file_ptr);
@@ -32,11 +32,13 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/epoll.h>
+#include <time.h>
 
 #include "../include/logger.h"
 #include "../include/system.h"
 #include "../include/scheduler.h"
 #include "../include/iccp_csm.h"
+#include "../include/iccp_checkpoint.h"
 #include "../include/iccp_ifm.h"
 #include "../include/iccp_cmd.h"
 #include "../include/mlacp_link_handler.h"
@@ -51,8 +53,6 @@
 //this needs to be fine tuned
 #define PEER_SOCK_SND_BUF_LEN  (6 * 1024 * 1024)
 #define PEER_SOCK_RCV_BUF_LEN  (6 * 1024 * 1024)
-#define RECV_RETRY_INTERVAL_USEC    100000
-#define RECV_RETRY_MAX              10
 
 extern int mlacp_prepare_for_warm_reboot(struct CSM* csm, char* buf, size_t max_buf_size);
 
@@ -99,21 +99,69 @@ static void heartbeat_update(struct CSM *csm)
     return;
 }
 
+/* Monotonic time in microseconds, for the per source accounting */
+uint64_t scheduler_time_usec()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Charge the time since start to an event source */
+void scheduler_account(struct System* sys, int src, uint64_t start)
+{
+    iccp_sched_dbg_counter_info_t *cnt;
+    uint64_t usec;
+
+    if (sys == NULL || src < 0 || src >= ICCP_SCHED_SRC_MAX)
+        return;
+
+    usec = scheduler_time_usec() - start;
+    cnt = &sys->dbg_counters.sched_counters[src];
+    ++cnt->runs;
+    cnt->total_usec += usec;
+    if (usec > cnt->max_usec)
+        cnt->max_usec = (usec > UINT32_MAX) ? UINT32_MAX : (uint32_t)usec;
+
+    return;
+}
+
+/* Keepalives go out ahead of everything else in the pass, so a long
+ * MAC or netlink burst cannot hold them back past the peer timeout */
+static void scheduler_send_heartbeat(struct System* sys)
+{
+    struct CSM* csm = NULL;
+    uint64_t start;
+
+    start = scheduler_time_usec();
+    LIST_FOREACH(csm, &(sys->csm_list), next)
+        mlacp_fsm_send_heartbeat(csm);
+    scheduler_account(sys, ICCP_SCHED_SRC_PEER, start);
+
+    return;
+}
+
 /* Transit FSM of all connections */
 static int scheduler_transit_fsm()
 {
     struct CSM* csm = NULL;
     struct System* sys = NULL;
+    uint64_t start;
 
     if ((sys = system_get_instance()) == NULL)
         return MCLAG_ERROR;
 
+    start = scheduler_time_usec();
     LIST_FOREACH(csm, &(sys->csm_list), next)
     {
         heartbeat_update(csm);
         iccp_csm_transit(csm);
         app_csm_transit(csm);
         mlacp_fsm_transit(csm);
+        /*restored MACs are aged whether or not the peer reconnects*/
+        iccp_checkpoint_age_timer(csm);
     }
 
     //lif->changed flag is marked for state change for lif, for active node when
@@ -123,136 +171,107 @@ static int scheduler_transit_fsm()
     //local_if_change_flag_clear();
     local_if_purge_clear();
 
+    scheduler_account(sys, ICCP_SCHED_SRC_FSM, start);
+
     return 1;
 }
 
-/* Receive packets call back function */
+/* Receive packets call back function
+ * Reads whatever the socket has buffered without blocking and queues
+ * every complete ICCP message, a partial message waits for the next
+ * readiness event. */
 int scheduler_csm_read_callback(struct CSM* csm)
 {
     struct Msg* msg = NULL;
-    /*peer message*/
-    char *peer_msg = g_csm_buf;
-    LDPHdr* ldp_hdr = (LDPHdr*)peer_msg;
-    char* data = &peer_msg[sizeof(LDPHdr)];
-    size_t data_len = 0;
+    LDPHdr* ldp_hdr = NULL;
     size_t pos = 0;
-    int recv_len = 0, len = 0, retval;
-    int num_retry = 0;
-    int total_retry_time = 0;
-    int total_data_len = 0;
+    size_t msg_len = 0;
+    ssize_t recv_len = 0;
+    int retval;
 
     if (csm->sock_fd <= 0)
         return MCLAG_ERROR;
 
-    memset(peer_msg, 0, CSM_BUFFER_SIZE);
-
-    recv_len = 0;
-    errno = 0;
-
-    while (recv_len != sizeof(LDPHdr))
+    while (csm->rx_len < CSM_RX_BUFFER_SIZE)
     {
-        len = recv(csm->sock_fd, peer_msg + recv_len, sizeof(LDPHdr) - recv_len, 0);
-        if (len == -1)
+        recv_len = recv(csm->sock_fd, &csm->rx_buf[csm->rx_len],
+                        CSM_RX_BUFFER_SIZE - csm->rx_len, MSG_DONTWAIT);
+        if (recv_len > 0)
         {
-            perror("recv(). Error");
-            ICCPD_LOG_WARN("ICCP_FSM", "Peer disconnect for header read error[%s] len = -1 till now received len  = %d ", strerror(errno), recv_len);
-            SYSTEM_INCR_HDR_READ_SOCK_ERR_COUNTER(system_get_instance());
-            goto recv_err;
+            csm->rx_len += recv_len;
+            continue;
         }
-        else if (len == 0)
-        {
-            ICCPD_LOG_WARN("ICCP_FSM", "Peer disconnect for header read error[%s] len = 0, till now received len = %d ",strerror(errno), recv_len);
-            SYSTEM_INCR_HDR_READ_SOCK_ZERO_LEN_COUNTER(system_get_instance());
-            goto recv_err;
-        }
-        recv_len += len;
-        /*usleep(100);*/
-    }
-
-    if (ntohs(ldp_hdr->msg_len) >= MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS)
-    {
-        data_len = ntohs(ldp_hdr->msg_len) - MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS;
-    }
-    else
-    {
-        ICCPD_LOG_ERR("ICCP_FSM", "Peer disconnect for invalid data error; length[%d] msg_type[0x%x] ", ntohs(ldp_hdr->msg_len),  ntohs(ldp_hdr->msg_type));
-        SYSTEM_INCR_INVALID_PEER_MSG_COUNTER(system_get_instance());
-        goto recv_err;
-    }
-    total_data_len = data_len;
-    pos = 0;
 
-    while (data_len > 0)
-    {
-        /* When consecutive CCP session flaps happen, recv() call got stuck.
-         * Change recv() to non-blocking with retry mechanism. If max
-         * retry reaches, attempt one more retry after waiting for one KA
-         * interval before bringing down the session.
-         */
-        recv_len = recv(csm->sock_fd, &data[pos], data_len, MSG_DONTWAIT);
-        if (recv_len == -1)
+        if (recv_len == 0)
         {
-            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            ICCPD_LOG_WARN("ICCP_FSM", "Peer disconnect, buffered len = %zu", csm->rx_len);
+            if (csm->rx_len < sizeof(LDPHdr))
             {
-                ICCPD_LOG_NOTICE(
-                    "ICCP_FSM", "Non-blocking recv total/pending len %d/%d, errno %d, num_retry %d",
-                    total_data_len, data_len, errno, num_retry);
-                ++num_retry;
-                if (num_retry > RECV_RETRY_MAX)
-                {
-                    ICCPD_LOG_ERR(
-                        "ICCP_FSM", "Non-blocking recv() retry failed, total/pending len %d/%d",
-                        total_data_len, data_len);
-                    SYSTEM_INCR_RX_RETRY_FAIL_COUNTER(system_get_instance());
-                    goto recv_err;
-                }
-                else
-                {
-                    if (num_retry == RECV_RETRY_MAX)
-                        usleep((csm->session_timeout * 1000000) - total_retry_time);
-                    else
-                    {
-                        total_retry_time += (num_retry * RECV_RETRY_INTERVAL_USEC);
-                        usleep(num_retry * RECV_RETRY_INTERVAL_USEC);
-                    }
-                    recv_len = 0;
-                }
+                SYSTEM_INCR_HDR_READ_SOCK_ZERO_LEN_COUNTER(system_get_instance());
             }
             else
             {
-                perror("continue recv() Error");
-                ICCPD_LOG_WARN("ICCP_FSM", "Peer data read error; recv_len:%d data_len:%d, errno %d",
-                               recv_len, data_len, errno);
-                SYSTEM_INCR_TLV_READ_SOCK_ERR_COUNTER(system_get_instance());
-                goto recv_err;
+                SYSTEM_INCR_TLV_READ_SOCK_ZERO_LEN_COUNTER(system_get_instance());
             }
+            goto recv_err;
         }
-        else if (recv_len == 0)
+
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            break;
+        if (errno == EINTR)
+            continue;
+
+        ICCPD_LOG_WARN("ICCP_FSM", "Peer disconnect for read error[%s], buffered len = %zu",
+                       strerror(errno), csm->rx_len);
+        if (csm->rx_len < sizeof(LDPHdr))
         {
-            ICCPD_LOG_WARN("ICCP_FSM", "Peer disconnect for data read error; recv_len:%d data_len:%d ", recv_len, data_len);
-            SYSTEM_INCR_TLV_READ_SOCK_ZERO_LEN_COUNTER(system_get_instance());
-            goto recv_err;
+            SYSTEM_INCR_HDR_READ_SOCK_ERR_COUNTER(system_get_instance());
+        }
+        else
+        {
+            SYSTEM_INCR_TLV_READ_SOCK_ERR_COUNTER(system_get_instance());
         }
-        data_len -= recv_len;
-        pos += recv_len;
-        /*usleep(100);*/
+        goto recv_err;
     }
-    if (num_retry > 0)
+
+    while (csm->rx_len - pos >= sizeof(LDPHdr))
     {
-        SYSTEM_SET_RETRY_COUNTER(system_get_instance(), num_retry);
+        ldp_hdr = (LDPHdr*)&csm->rx_buf[pos];
+
+        if (ntohs(ldp_hdr->msg_len) < MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS)
+        {
+            ICCPD_LOG_ERR("ICCP_FSM", "Peer disconnect for invalid data error; length[%d] msg_type[0x%x] ", ntohs(ldp_hdr->msg_len),  ntohs(ldp_hdr->msg_type));
+            SYSTEM_INCR_INVALID_PEER_MSG_COUNTER(system_get_instance());
+            goto recv_err;
+        }
+
+        msg_len = ntohs(ldp_hdr->msg_len) + MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS;
+        if (csm->rx_len - pos < msg_len)
+            break;
+
+        retval = iccp_csm_init_msg(&msg, (char*)ldp_hdr, msg_len);
+        if (retval == 0)
+        {
+            iccp_csm_enqueue_msg(csm, msg);
+            ++csm->icc_msg_in_count;
+        }
+        else
+            ++csm->i_msg_in_count;
+
+        pos += msg_len;
     }
-    retval = iccp_csm_init_msg(&msg, peer_msg, ntohs(ldp_hdr->msg_len) + MSG_L_INCLUD_U_BIT_MSG_T_L_FIELDS);
-    if (retval == 0)
+
+    /* Keep the partial message at the head of the buffer */
+    if (pos > 0)
     {
-        iccp_csm_enqueue_msg(csm, msg);
-        ++csm->icc_msg_in_count;
+        csm->rx_len -= pos;
+        memmove(csm->rx_buf, &csm->rx_buf[pos], csm->rx_len);
     }
-    else
-        ++csm->i_msg_in_count;
 
     return 1;
 
  recv_err:
+    csm->rx_len = 0;
     scheduler_session_disconnect_handler(csm);
     return MCLAG_ERROR;
 }
@@ -333,6 +352,8 @@ int scheduler_server_accept()
     }
 
     csm->sock_fd = new_fd;
+    csm->rx_len = 0;
+    csm->tx_len = 0;
     if (setsockopt(csm->sock_fd, SOL_SOCKET, SO_SNDBUF, &send_buf_len, sizeof(send_buf_len)) == -1)
     {
         ICCPD_LOG_ERR(__FUNCTION__, "Set socket send buf option failed. Error");
@@ -381,6 +402,8 @@ void scheduler_init()
         return;
 
     iccp_get_start_type(sys);
+    /*MAC/neighbor tables saved by the previous instance */
+    iccp_checkpoint_load(sys);
     /*Get kernel interface and port */
     iccp_sys_local_if_list_get_init();
     iccp_sys_local_if_list_get_addr();
@@ -422,9 +445,10 @@ void mlacp_sync_send_warmboot_flag()
     {
         if (MLACP(csm).current_state == MLACP_STATE_EXCHANGE)
         {
-            memset(g_csm_buf, 0, CSM_BUFFER_SIZE);
             msg_len = mlacp_prepare_for_warm_reboot(csm, g_csm_buf, CSM_BUFFER_SIZE);
             iccp_csm_send(csm, g_csm_buf, msg_len);
+            /* iccpd exits right after, do not wait for the scheduler pass */
+            iccp_csm_tx_flush(csm);
         }
     }
     ICCPD_LOG_DEBUG("ICCP_FSM", "Send warmboot flag to peer. Start warmboot");
@@ -462,6 +486,7 @@ int iccp_receive_signal_handler(struct System* sys)
 void scheduler_loop()
 {
     struct System* sys = NULL;
+    struct CSM* csm = NULL;
 
     if ((sys = system_get_instance()) == NULL)
         return;
@@ -473,14 +498,33 @@ void scheduler_loop()
             iccp_connect_syncd();
         }
 
+        /*keepalives first, a busy pass must not delay them */
+        scheduler_send_heartbeat(sys);
         /*handle socket slelect event ,If no message received, it will block 0.1s*/
         iccp_handle_events(sys);
+        /*heartbeats due after a long event pass */
+        scheduler_send_heartbeat(sys);
         /*csm, app state machine transit */
         scheduler_transit_fsm();
+        /*port isolation groups changed this pass */
+        iccp_peerlink_isolate_flush();
+        /*MAC updates whose coalescing window ended */
+        iccp_mac_coalesce_flush(0);
+        /*FDB changes of this pass go to mclagsyncd as one message */
+        iccp_mclagsyncd_fdb_flush();
+        /*neighbor entries programmed this pass, one netlink write */
+        iccp_netlink_neighbor_flush();
+        /*messages queued for the peers this pass */
+        LIST_FOREACH(csm, &(sys->csm_list), next)
+            iccp_csm_tx_flush(csm);
+        /*mclagdctl clients that stopped reading their reply */
+        mclagd_ctl_reply_expire();
 
         if (sys->warmboot_exit == WARM_REBOOT)
         {
             ICCPD_LOG_DEBUG(__FUNCTION__, "Warm reboot exit ......");
+            iccp_mac_coalesce_flush(1);
+            iccp_checkpoint_save(sys);
             return;
         }
     }
@@ -627,6 +671,8 @@ void session_client_conn_handler(struct CSM *csm)
         if (err)
             goto conn_fail;
         csm->sock_fd = connFd;
+        csm->rx_len = 0;
+        csm->tx_len = 0;
         if (setsockopt(csm->sock_fd, SOL_SOCKET, SO_SNDBUF, &send_buf_len, sizeof(send_buf_len)) == -1)
         {
             ICCPD_LOG_ERR(__FUNCTION__, "Set socket send buf option failed. Error");
@@ -873,6 +919,9 @@ void scheduler_csm_socket_cleanup(struct CSM* csm, int location)
     if (csm->sock_fd <= 0)
         return;
 
+    /* messages still queued, e.g. the RG disconnect */
+    iccp_csm_tx_flush(csm);
+
     event.data.fd = csm->sock_fd;
     event.events = EPOLLIN;
     if (epoll_ctl(sys->epoll_fd, EPOLL_CTL_DEL, csm->sock_fd, &event) != 0)
@@ -892,5 +941,6 @@ void scheduler_csm_socket_cleanup(struct CSM* csm, int location)
                          csm->sock_fd, location);
     }
     csm->sock_fd = -1;
+    csm->tx_len = 0;
 }
 
@@ -30,6 +30,7 @@
 #include "../include/scheduler.h"
 #include "../include/mlacp_link_handler.h"
 #include "../include/iccp_ifm.h"
+#include "../include/iccp_ingest.h"
 
 #define ETHER_ADDR_LEN 6
 char mac_print_str[ETHER_ADDR_STR_LEN];
@@ -88,6 +89,8 @@ void system_init(struct System* sys)
     sys->need_sync_netlink_again = 0;
     scheduler_server_sock_init();
     iccp_system_init_netlink_socket();
+    /*netlink and ARP/ND sockets are read by the ingest thread */
+    iccp_ingest_init(sys);
     iccp_init_netlink_event_fd(sys);
 }
 
@@ -122,6 +125,9 @@ void system_finalize()
         LIST_REMOVE(local_if, system_next);
         local_if_finalize(local_if);
     }
+    memset(sys->lif_name_hash, 0, sizeof(sys->lif_name_hash));
+    memset(sys->lif_ifindex_hash, 0, sizeof(sys->lif_ifindex_hash));
+    memset(sys->lif_po_hash, 0, sizeof(sys->lif_po_hash));
 
     while (!LIST_EMPTY(&(sys->lif_purge_list)))
     {
@@ -140,6 +146,7 @@ void system_finalize()
         free(unq_ip_if);
     }
 
+    iccp_ingest_finalize();
     iccp_system_dinit_netlink_socket();
 
     if (sys->log_file_path != NULL )
@@ -155,8 +155,15 @@ int main(int ac, char * av[]) {
                  != 0)) {
 
         radius_update_cache( conf->prog, user, mpl);
+        radius_user_cache_rebuild( conf->prog);
         refresh_user = 1;
 
+    } else if (!radius_user_cache_usable( conf->prog)) {
+
+        /* Index absent or from another version, e.g. after an upgrade.
+         */
+        radius_user_cache_rebuild( conf->prog);
+
     }
 
     if (conf->many_to_one) {
@@ -31,7 +31,7 @@ enum nss_status _nss_radius_getpwnam_r( const char * nam, struct passwd * pwd,
     if (!nam || !strcmp(nam, "*") || !pwd || !buf || (buflen == 0))
         return NSS_STATUS_NOTFOUND;
 
-    parse_nss_config(conf, prog, file_buf, sizeof(file_buf), errnop, &ncfd);
+    parse_nss_config_cached(conf, prog, file_buf, sizeof(file_buf), errnop);
 
     if (radius_lookup_cache(prog, nam, &mpl) == 0) {
 
@@ -45,12 +45,20 @@ enum nss_status _nss_radius_getpwnam_r( const char * nam, struct passwd * pwd,
         if (conf->many_to_one) {
             radius_getpwnam_r(prog, rnm->gecos, &pw, buffer, sizeof(buffer),
                 &res);
-        } else if (conf->allow_anonymous) {
-            radius_create_user(conf, nam, mpl, RADIUS_CONFIRMED);
-            radius_getpwnam_r(prog, nam, &pw, buffer, sizeof(buffer), &res);
+        } else if (radius_nss_allow_anonymous(conf, &ncfd)) {
+
+            /* Only fork useradd if the user is not there yet.
+             */
+            if (radius_getpwnam_r(prog, nam, &pw, buffer, sizeof(buffer),
+                    &res) != 0) {
+                radius_create_user(conf, nam, mpl, RADIUS_CONFIRMED);
+                radius_getpwnam_r(prog, nam, &pw, buffer, sizeof(buffer),
+                    &res);
+            }
         }
 
-    } else if (conf->allow_anonymous && is_sshd_lookup(conf, nam)) {
+    } else if (radius_nss_allow_anonymous(conf, &ncfd)
+               && is_sshd_lookup(conf, nam)) {
 
         /* Could be an sshd doing a getpwnam() before pam_authenticate().
          */
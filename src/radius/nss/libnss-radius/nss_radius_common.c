@@ -26,9 +26,27 @@ The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
 #include <regex.h>
 #include <time.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
+#include <dirent.h>
+#include <pthread.h>
 
 #include "nss_radius_common.h"
 
+/* Per process state kept across NSS lookups, refreshed only when the
+ * backing file changes.
+ */
+static pthread_mutex_t radius_nss_state_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static RADIUS_NSS_CONF_B nss_conf_snapshot;
+static char nss_conf_snapshot_buf[RADIUS_MAX_NSS_CONF_SZ];
+static struct stat nss_conf_snapshot_sb;
+static int nss_conf_snapshot_valid = 0;
+static int nss_conf_snapshot_ret = 0;
+
+static RADIUS_USER_CACHE_HDR * user_cache_map = NULL;
+static size_t user_cache_map_sz = 0;
+static struct stat user_cache_sb;
+
 static void dump_rnm(int mpl, RADIUS_NSS_MPL * rnm, char * msg) {
 
     syslog( LOG_DEBUG, "dump_rnm: %s:"
@@ -285,8 +303,19 @@ static int user_mod(const char* name, char* sec_grp) {
     return status;
 }
 
-int parse_nss_config(RADIUS_NSS_CONF_B * conf, char * prog,
-    char * file_buf, int file_buf_sz, int * errnop, int * plockfd) {
+static int same_file(struct stat * a, struct stat * b) {
+    return (   (a->st_dev == b->st_dev)
+            && (a->st_ino == b->st_ino)
+            && (a->st_size == b->st_size)
+            && (a->st_mtim.tv_sec == b->st_mtim.tv_sec)
+            && (a->st_mtim.tv_nsec == b->st_mtim.tv_nsec));
+}
+
+/* Reads and parses the config. The config fd is returned open in *pncfd,
+ * the caller decides whether to lock it.
+ */
+static int read_nss_config(RADIUS_NSS_CONF_B * conf, char * prog,
+    char * file_buf, int file_buf_sz, int * errnop, int * pncfd) {
 
       /* Slurp the whole file.
        */
@@ -318,7 +347,7 @@ int parse_nss_config(RADIUS_NSS_CONF_B * conf, char * prog,
         ret = 1;
         errbuf[0] = 0; strerror_r(errno, errbuf, sizeof(errbuf));
         syslog( LOG_WARNING, "%s: %s", prog, errbuf);
-        goto parse_nss_config_exit;
+        goto read_nss_config_exit;
     }
 
       /* The maximum file size is 1 less than the buffer, to allow space for
@@ -328,13 +357,13 @@ int parse_nss_config(RADIUS_NSS_CONF_B * conf, char * prog,
     if (sb.st_size >= file_buf_sz) {
         syslog( LOG_WARNING, "%s: size greater than %d. Ignoring",
             prog, file_buf_sz - 1);
-        goto parse_nss_config_exit;
+        goto read_nss_config_exit;
     }
 
     if ((i = read(ncfd, file_buf, file_buf_sz)) != sb.st_size) {
         syslog( LOG_WARNING, "%s: read %d of %ld. Ignoring", prog,
             i, sb.st_size);
-        goto parse_nss_config_exit;
+        goto read_nss_config_exit;
     }
 
       /* Parse each line from file.
@@ -436,7 +465,32 @@ int parse_nss_config(RADIUS_NSS_CONF_B * conf, char * prog,
      }
 
 
-parse_nss_config_exit:
+read_nss_config_exit:
+
+    *pncfd = ncfd;
+
+      /* Fix up rnm.
+       */
+
+    if (use_default_rnm || bad_rnm)
+        init_rnm(conf);
+
+    for ( i = 1; i < RADIUS_MAX_MPL; i++) {
+        if ((conf->rnm)[i].gecos == NULL) {
+            (conf->rnm)[i] = (conf->rnm)[i-1];
+        }
+    }
+
+    return ret;
+}
+
+int parse_nss_config(RADIUS_NSS_CONF_B * conf, char * prog,
+    char * file_buf, int file_buf_sz, int * errnop, int * plockfd) {
+
+    int ncfd = -1;
+    int ret;
+
+    ret = read_nss_config(conf, prog, file_buf, file_buf_sz, errnop, &ncfd);
 
     if (ncfd != -1) {
 
@@ -458,22 +512,100 @@ parse_nss_config_exit:
         }
     }
 
+    return ret;
+}
 
-      /* Fix up rnm.
-       */
+static char * rebase_conf_ptr(char * ptr, char * from, char * to, int sz) {
+    if (ptr && (ptr >= from) && (ptr < from + sz))
+        return to + (ptr - from);
+    return ptr;
+}
 
-    if (use_default_rnm || bad_rnm)
-        init_rnm(conf);
+/* Same as parse_nss_config(), without the Unconfirmed lock, from a per
+ * process snapshot that is only reparsed when the file changes. The lock
+ * is taken by radius_nss_allow_anonymous() when a user may be created.
+ */
+int parse_nss_config_cached(RADIUS_NSS_CONF_B * conf, char * prog,
+    char * file_buf, int file_buf_sz, int * errnop) {
 
-    for ( i = 1; i < RADIUS_MAX_MPL; i++) {
-        if ((conf->rnm)[i].gecos == NULL) {
-            (conf->rnm)[i] = (conf->rnm)[i-1];
-        }
+    struct stat sb;
+    int ncfd = -1;
+    int ret, i;
+
+    if (   (file_buf_sz != sizeof(nss_conf_snapshot_buf))
+        || (stat(RADIUS_NSS_CONF, &sb) == -1)) {
+        ret = read_nss_config(conf, prog, file_buf, file_buf_sz, errnop, &ncfd);
+        if (ncfd != -1)
+            close(ncfd);
+        return ret;
+    }
+
+    pthread_mutex_lock(&radius_nss_state_mutex);
+
+    if (!nss_conf_snapshot_valid || !same_file(&sb, &nss_conf_snapshot_sb)) {
+        nss_conf_snapshot_ret = read_nss_config(&nss_conf_snapshot, prog,
+            nss_conf_snapshot_buf, sizeof(nss_conf_snapshot_buf), errnop,
+            &ncfd);
+
+          /* Stat what was read, a change during the read is seen next time.
+           */
+        nss_conf_snapshot_valid = (ncfd != -1)
+            && (fstat(ncfd, &nss_conf_snapshot_sb) == 0);
+        if (ncfd != -1)
+            close(ncfd);
+    }
+
+    ret = nss_conf_snapshot_ret;
+    memcpy(file_buf, nss_conf_snapshot_buf, file_buf_sz);
+    *conf = nss_conf_snapshot;
+
+    pthread_mutex_unlock(&radius_nss_state_mutex);
+
+      /* Point the strings at the caller's copy of the file.
+       */
+    conf->prog = prog;
+    conf->unconfirmed_regexp = rebase_conf_ptr(conf->unconfirmed_regexp,
+        nss_conf_snapshot_buf, file_buf, file_buf_sz);
+    for ( i = 0; i < RADIUS_MAX_MPL; i++) {
+        (conf->rnm)[i].groups = rebase_conf_ptr((conf->rnm)[i].groups,
+            nss_conf_snapshot_buf, file_buf, file_buf_sz);
+        (conf->rnm)[i].gecos = rebase_conf_ptr((conf->rnm)[i].gecos,
+            nss_conf_snapshot_buf, file_buf, file_buf_sz);
+        (conf->rnm)[i].shell = rebase_conf_ptr((conf->rnm)[i].shell,
+            nss_conf_snapshot_buf, file_buf, file_buf_sz);
     }
 
     return ret;
 }
 
+/* Takes the Unconfirmed lock parse_nss_config() takes, for a caller of
+ * parse_nss_config_cached() about to create a user. Returns whether
+ * anonymous users are allowed. The lock is released by unparse_nss_config().
+ */
+int radius_nss_allow_anonymous(RADIUS_NSS_CONF_B * conf, int * plockfd) {
+
+    if (!conf->allow_anonymous || (*plockfd != -1))
+        return conf->allow_anonymous;
+
+    if ((*plockfd = open(RADIUS_NSS_CONF, O_RDONLY)) == -1)
+        return conf->allow_anonymous;
+
+    if (flock(*plockfd, LOCK_EX|LOCK_NB) == 0) {
+        if (conf->debug)
+            syslog( LOG_DEBUG, "%s: %d: Unconfirmed: lock success",
+                conf->prog, (int) getpid());
+    } else {
+        conf->allow_anonymous = 0;
+        if (conf->debug)
+            syslog( LOG_DEBUG, "%s: %d: Unconfirmed: locked out",
+                conf->prog, (int) getpid());
+        close(*plockfd);
+        *plockfd = -1;
+    }
+
+    return conf->allow_anonymous;
+}
+
 /* Releases any memory.
  * Closes any fds.
  */
@@ -658,7 +790,7 @@ int radius_lookup_cache_cleanup( int status, int rafd) {
     return status;
 }
 
-int radius_lookup_cache( char * prog, const char * nam, int * pmpl) {
+static int radius_lookup_cache_file( char * prog, const char * nam, int * pmpl) {
     int rafd = -1;
     int i;
     char cache_filename[PATH_MAX];
@@ -711,6 +843,281 @@ int radius_lookup_cache( char * prog, const char * nam, int * pmpl) {
     return radius_lookup_cache_cleanup(0, rafd);
 }
 
+static uint32_t radius_user_cache_hash(const char * nam) {
+    uint32_t hash = 2166136261U;    /* FNV-1a */
+
+    for ( ; *nam; nam++) {
+        hash ^= (unsigned char) *nam;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+static void radius_user_cache_unmap(void) {
+    if (user_cache_map)
+        munmap(user_cache_map, user_cache_map_sz);
+    user_cache_map = NULL;
+    user_cache_map_sz = 0;
+}
+
+/* Maps the index again if cache_radius replaced it.
+ * Called with radius_nss_state_mutex held.
+ */
+static int radius_user_cache_map(char * prog) {
+    struct stat sb;
+    int fd;
+    void * map;
+    RADIUS_USER_CACHE_HDR * hdr;
+
+    if (stat(RADIUS_USER_CACHE, &sb) == -1) {
+        radius_user_cache_unmap();
+        return STATUS_ENOENT;
+    }
+
+    if (user_cache_map && same_file(&sb, &user_cache_sb))
+        return 0;
+
+    radius_user_cache_unmap();
+
+    if (((fd = open(RADIUS_USER_CACHE, O_RDONLY)) == -1)
+        || (fstat(fd, &sb) == -1)) {
+        if (fd != -1)
+            close(fd);
+        return STATUS_ENOENT;
+    }
+
+    if (sb.st_size < sizeof(RADIUS_USER_CACHE_HDR)) {
+        close(fd);
+        syslog( LOG_WARNING, "%s: \"%s\": size %ld too small. Ignoring",
+            prog, RADIUS_USER_CACHE, sb.st_size);
+        return STATUS_EINVAL;
+    }
+
+    map = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        syslog( LOG_WARNING, "%s: \"%s\": mmap() failed errno %d. Ignoring",
+            prog, RADIUS_USER_CACHE, errno);
+        return STATUS_EIO;
+    }
+
+    hdr = (RADIUS_USER_CACHE_HDR *) map;
+    if (   (hdr->magic != RADIUS_USER_CACHE_MAGIC)
+        || (hdr->version != RADIUS_USER_CACHE_VERSION)
+        || (hdr->num_buckets != RADIUS_USER_CACHE_BUCKETS)
+        || (hdr->num_users > (sb.st_size - sizeof(RADIUS_USER_CACHE_HDR))
+                / sizeof(RADIUS_USER_CACHE_ENT))) {
+        munmap(map, sb.st_size);
+        syslog( LOG_WARNING, "%s: \"%s\": bad magic, version or size. Ignoring",
+            prog, RADIUS_USER_CACHE);
+        return STATUS_EINVAL;
+    }
+
+    user_cache_map = hdr;
+    user_cache_map_sz = sb.st_size;
+    user_cache_sb = sb;
+
+    return 0;
+}
+
+/* Returns 0 and the MPL if nam is in the index, STATUS_ENOENT if not,
+ * -1 if there is no usable index.
+ */
+static int radius_user_cache_lookup( char * prog, const char * nam, int * pmpl) {
+    RADIUS_USER_CACHE_ENT * ent;
+    uint32_t idx, steps;
+    int status = -1;
+
+    pthread_mutex_lock(&radius_nss_state_mutex);
+
+    if (radius_user_cache_map(prog) == 0) {
+        status = STATUS_ENOENT;
+        ent = (RADIUS_USER_CACHE_ENT *) (user_cache_map + 1);
+        idx = user_cache_map->bucket[radius_user_cache_hash(nam)
+                  % RADIUS_USER_CACHE_BUCKETS];
+
+          /* Bounded walk, the file is not trusted to be well formed.
+           */
+        for ( steps = 0;
+              idx && (idx <= user_cache_map->num_users)
+                  && (steps < user_cache_map->num_users);
+              steps++, idx = ent[idx-1].next) {
+            if (strncmp(ent[idx-1].name, nam, sizeof(ent->name)) == 0) {
+                *pmpl = ent[idx-1].mpl;
+                status = 0;
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&radius_nss_state_mutex);
+
+    return status;
+}
+
+int radius_lookup_cache( char * prog, const char * nam, int * pmpl) {
+    int mpl = RADIUS_MIN_MPL;
+    int status;
+
+    *pmpl = RADIUS_MIN_MPL;
+
+      /* Names too long for the index only live in the per user cache.
+       */
+    if ((strlen(nam) >= RADIUS_USER_NAME_LEN)
+        || ((status = radius_user_cache_lookup(prog, nam, &mpl)) == -1))
+        return radius_lookup_cache_file(prog, nam, pmpl);
+
+    if (status != 0) {
+        syslog( LOG_INFO, "%s: \"%s\": Absent in \"%s\".", prog, nam,
+            RADIUS_USER_CACHE);
+        return status;
+    }
+
+    if (((RADIUS_MIN_MPL <= mpl) && (mpl <= RADIUS_MAX_MPL)))
+        *pmpl = mpl;
+
+    return 0;
+}
+
+int radius_user_cache_usable( char * prog) {
+    int status;
+
+    pthread_mutex_lock(&radius_nss_state_mutex);
+    status = radius_user_cache_map(prog);
+    pthread_mutex_unlock(&radius_nss_state_mutex);
+
+    return status == 0;
+}
+
+static int radius_user_cache_rebuild_cleanup(int status, mode_t mask,
+    int lockfd, DIR * dir, FILE * fp, char * tmpname,
+    RADIUS_USER_CACHE_ENT * ents) {
+
+    umask(mask);
+
+      /* The per user cache may have changed and lookups trust the index,
+       * without an index they fall back to the per user cache.
+       */
+    if (status != 0)
+        unlink(RADIUS_USER_CACHE);
+
+    if (lockfd != -1)
+        close(lockfd);
+
+    if (dir)
+        closedir(dir);
+
+    if (fp) {
+        fclose(fp);
+        unlink(tmpname);
+    }
+
+    free(ents);
+
+    return status;
+}
+
+/* Rebuilds the index from the per user cache directories. Rebuilds are
+ * serialized by a lock on the index directory, so the last rename always
+ * comes from a scan made after every earlier cache update.
+ */
+int radius_user_cache_rebuild( char * prog) {
+    RADIUS_USER_CACHE_HDR hdr;
+    RADIUS_USER_CACHE_ENT * ents = NULL, * grown;
+    uint32_t num_users = 0, max_users = 0, bucket;
+    char tmpname[PATH_MAX];
+    struct dirent * de;
+    DIR * dir = NULL;
+    FILE * fp = NULL;
+    mode_t mask;
+    int lockfd;
+    int mpl;
+
+    mask = umask(022);
+
+    if (   ((lockfd = open(RADIUS_CACHE_DIR, O_RDONLY | O_DIRECTORY)) == -1)
+        || (flock(lockfd, LOCK_EX) != 0)) {
+        syslog( LOG_ERR, "%s: \"%s\": lock fails errno %d",
+            prog, RADIUS_CACHE_DIR, errno);
+        return radius_user_cache_rebuild_cleanup(STATUS_EIO, mask, lockfd,
+            dir, fp, tmpname, ents);
+    }
+
+    memset((char *) &hdr, 0, sizeof(hdr));
+    hdr.magic = RADIUS_USER_CACHE_MAGIC;
+    hdr.version = RADIUS_USER_CACHE_VERSION;
+    hdr.num_buckets = RADIUS_USER_CACHE_BUCKETS;
+
+    pthread_mutex_lock(&radius_nss_state_mutex);
+    if (radius_user_cache_map(prog) == 0)
+        hdr.generation = user_cache_map->generation + 1;
+    pthread_mutex_unlock(&radius_nss_state_mutex);
+
+    if ((dir = opendir(RADIUS_ATTRIBUTE_CACHE_DIR)) == NULL) {
+        syslog( LOG_ERR, "%s: \"%s\": opendir() fails errno %d",
+            prog, RADIUS_ATTRIBUTE_CACHE_DIR, errno);
+        return radius_user_cache_rebuild_cleanup(STATUS_ENOENT, mask, lockfd,
+            dir, fp, tmpname, ents);
+    }
+
+    while ((de = readdir(dir)) != NULL) {
+
+        if (   (de->d_name[0] == '.')
+            || (strlen(de->d_name) >= RADIUS_USER_NAME_LEN)
+            || (radius_lookup_cache_file(prog, de->d_name, &mpl) != 0))
+            continue;
+
+        if (num_users == max_users) {
+            max_users = max_users ? (max_users * 2) : 64;
+            if ((grown = realloc(ents, max_users * sizeof(*ents))) == NULL) {
+                syslog( LOG_ERR, "%s: %u users: realloc() fails",
+                    prog, max_users);
+                return radius_user_cache_rebuild_cleanup(STATUS_E2BIG, mask,
+                    lockfd, dir, fp, tmpname, ents);
+            }
+            ents = grown;
+        }
+
+        memset((char *) &ents[num_users], 0, sizeof(*ents));
+        strcpy(ents[num_users].name, de->d_name);
+        ents[num_users].mpl = mpl;
+
+        bucket = radius_user_cache_hash(de->d_name) % RADIUS_USER_CACHE_BUCKETS;
+        ents[num_users].next = hdr.bucket[bucket];
+        hdr.bucket[bucket] = ++num_users;
+    }
+
+    hdr.num_users = num_users;
+
+      /* Write aside and rename, a reader maps either the old or new file.
+       */
+    snprintf(tmpname, sizeof(tmpname), "%s.%d", RADIUS_USER_CACHE,
+        (int) getpid());
+
+    if (   ((fp = fopen(tmpname, "w")) == NULL)
+        || (fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+        || (num_users
+            && (fwrite(ents, sizeof(*ents), num_users, fp) != num_users))
+        || (fflush(fp) != 0)
+        || (fsync(fileno(fp)) != 0)
+        || (rename(tmpname, RADIUS_USER_CACHE) != 0)) {
+        syslog( LOG_ERR, "%s: \"%s\": write or rename fails. errno %d",
+            prog, RADIUS_USER_CACHE, errno);
+        return radius_user_cache_rebuild_cleanup(STATUS_EIO, mask, lockfd,
+            dir, fp, tmpname, ents);
+    }
+
+    fclose(fp);
+    fp = NULL;
+
+    syslog(LOG_INFO, "%s: \"%s\": generation %u, %u users", prog,
+        RADIUS_USER_CACHE, hdr.generation, num_users);
+
+    return radius_user_cache_rebuild_cleanup(0, mask, lockfd, dir, fp, tmpname,
+        ents);
+}
+
 int radius_copy_pw( RADIUS_NSS_CONF_B * conf, struct passwd * res,
     const char * nam, struct passwd * pwd,
     char * buffer, size_t buflen, int * errnop) {
@@ -25,6 +25,7 @@ The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
 #include <ctype.h>
 #include <netdb.h>
 #include <nss.h>
+#include <stdint.h>
 
 #define RADIUS_MAX_MPL (15)
 #define RADIUS_MIN_MPL (1)
@@ -36,6 +37,15 @@ The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
 #define RADIUS_CACHE_DIR "/var/cache/radius"
 #define RADIUS_ATTR_MPL "Management-Privilege-Level"
 
+/* Index of the per user cache, rebuilt by cache_radius and mapped by the
+ * NSS lookups. Replaced by rename(), so a mapping never sees a partial file.
+ */
+#define RADIUS_USER_CACHE RADIUS_CACHE_DIR "/user_cache.idx"
+#define RADIUS_USER_CACHE_MAGIC   0x52554358    /* "RUCX" */
+#define RADIUS_USER_CACHE_VERSION 1
+#define RADIUS_USER_CACHE_BUCKETS 256
+#define RADIUS_USER_NAME_LEN      33            /* 32 + NULL, see useradd */
+
 #define ETC_PASSWD "/etc/passwd"
 
 #define USERADD "/usr/sbin/useradd"
@@ -94,6 +104,26 @@ typedef struct _radius_nss_mpl {
     char        * shell;
 } RADIUS_NSS_MPL;
 
+/* Index file: the header, then num_users entries. bucket[] and next
+ * hold an entry index + 1, 0 terminates the chain.
+ */
+typedef struct _radius_user_cache_hdr {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    reserved;
+    uint32_t    generation;
+    uint32_t    num_buckets;
+    uint32_t    num_users;
+    uint32_t    bucket[RADIUS_USER_CACHE_BUCKETS];
+} RADIUS_USER_CACHE_HDR;
+
+typedef struct _radius_user_cache_ent {
+    char        name[RADIUS_USER_NAME_LEN];
+    uint8_t     mpl;
+    uint16_t    reserved;
+    uint32_t    next;
+} RADIUS_USER_CACHE_ENT;
+
 typedef struct _radius_nss_conf {
     char * prog;
     int debug;
@@ -109,10 +139,19 @@ typedef struct _radius_nss_conf {
 int parse_nss_config( RADIUS_NSS_CONF_B * conf, char * prog,
     char * file_buf, int file_buf_sz, int * errnop, int * plockfd);
 
+int parse_nss_config_cached( RADIUS_NSS_CONF_B * conf, char * prog,
+    char * file_buf, int file_buf_sz, int * errnop);
+
 int unparse_nss_config( RADIUS_NSS_CONF_B * conf, int * errnop, int * plockfd);
 
+int radius_nss_allow_anonymous( RADIUS_NSS_CONF_B * conf, int * plockfd);
+
 int radius_lookup_cache( char * prog, const char * nam, int * pmpl);
 
+int radius_user_cache_usable( char * prog);
+
+int radius_user_cache_rebuild( char * prog);
+
 int radius_fill_pw( RADIUS_NSS_CONF_B * conf, int mpl,
     const char * nam, struct passwd * pwd,
     char * buffer, size_t buflen, int * errnop);
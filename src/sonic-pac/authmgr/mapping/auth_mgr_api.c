@@ -1331,6 +1331,7 @@ RC_t authmgrUnauthAddrCallBack( uint32 intIfNum,  enetMacAddr_t macAddr,  ushort
 
   memcpy(&parms.macAddr,&macAddr.addr, ENET_MAC_ADDR_LEN);
   parms.vlanId = vlanId;
+  parms.seenTime = osapiUpTimeMillisecondsGet();
 
   /* send the message to the authmgr component */
   return authmgrIssueCmd(authmgrUnauthAddrCallBackEvent,intIfNum,(void *)&parms);
@@ -634,6 +634,11 @@ RC_t authmgrClientStatusSet (authmgrLogicalPortInfo_t * logicalPortInfo,
 
     PacGlobalOperTblSet(&global_info); 
 
+    if ( AUTHMGR_PORT_STATUS_AUTHORIZED == portStatus)
+    {
+      authmgrLatencyClientAuthorized(logicalPortInfo);
+    }
+
     AUTHMGR_EVENT_TRACE (AUTHMGR_TRACE_CLIENT, physPort,
                          "%s:%d Status already set \n", __FUNCTION__, __LINE__);
     return  SUCCESS;
@@ -673,6 +678,7 @@ RC_t authmgrClientStatusSet (authmgrLogicalPortInfo_t * logicalPortInfo,
 
       PacGlobalOperTblSet(&global_info); 
 
+      authmgrLatencyClientAuthorized(logicalPortInfo);
     }
   }
   else
@@ -186,6 +186,7 @@ void authmgrTask ()
   authmgrMsg_t msg;
   authmgrBulkMsg_t bulkMsg;
   authmgrVlanMsg_t vlanMsg;
+  uint32 batchCount;
 
   printf("%s:%d\r\n", __FUNCTION__, __LINE__);
 
@@ -227,14 +228,37 @@ void authmgrTask ()
         (authmgrCB->authmgrQueue, (void *) &msg,
          (uint32) sizeof (authmgrMsg_t),  NO_WAIT) ==  SUCCESS)
     {
-      (void) authmgrDispatchCmd (&msg);
+      /* Service the client events (RADIUS results, timer ticks, ...)
+       * that are already queued before writing out their updates. */
+      batchCount = 0;
+      do
+      {
+        memset(&authmgrCB->processInfo, 0, sizeof(authmgrClientInfo_t));
+        memset(&authmgrCB->oldInfo, 0, sizeof(authmgrClientInfo_t));
+        (void) authmgrDispatchCmd (&msg);
+
+        /* VLAN events keep their priority over the rest of the batch */
+        while (osapiMessageReceive
+               (authmgrCB->authmgrVlanEventQueue, (void *) &vlanMsg,
+                (uint32) sizeof (authmgrVlanMsg_t),  NO_WAIT) ==  SUCCESS)
+        {
+          memset(&authmgrCB->processInfo, 0, sizeof(authmgrClientInfo_t));
+          memset(&authmgrCB->oldInfo, 0, sizeof(authmgrClientInfo_t));
+          (void) authmgrVlanDispatchCmd (&vlanMsg);
+        }
+      } while ((++batchCount < AUTHMGR_DISPATCH_BATCH_MAX) &&
+               (osapiMessageReceive
+                (authmgrCB->authmgrQueue, (void *) &msg,
+                 (uint32) sizeof (authmgrMsg_t),  NO_WAIT) ==  SUCCESS));
     }
     else if (osapiMessageReceive
         (authmgrCB->authmgrBulkQueue, (void *) &bulkMsg,
          (uint32) sizeof (authmgrBulkMsg_t),  NO_WAIT) ==  SUCCESS)
     {
-      (void) authmgrBulkDispatchCmd (&bulkMsg);
+      (void) authmgrBulkBatchDispatch (&bulkMsg);
     }
+
+    authmgrBatchFlush ();
   }
 }
 
@@ -675,7 +699,8 @@ RC_t authmgrBulkDispatchCmd (authmgrBulkMsg_t * msg)
       rc =
         authmgrCtlPortUnauthAddrCallbackProcess (msg->intf,
                                                  msg->data.unauthParms.macAddr,
-                                                 msg->data.unauthParms.vlanId);
+                                                 msg->data.unauthParms.vlanId,
+                                                 msg->data.unauthParms.seenTime);
       break;
     default:
       rc =  FAILURE;
@@ -685,6 +710,96 @@ RC_t authmgrBulkDispatchCmd (authmgrBulkMsg_t * msg)
   return rc;
 }
 
+/*********************************************************************
+* @purpose  Service a batch of bulk messages under one lock acquisition
+*
+* @param    msg   @b{(input)} first authmgr bulk message of the batch
+*
+* @returns   SUCCESS or  FAILURE
+*
+* @comments Drains up to AUTHMGR_DISPATCH_BATCH_MAX messages from the
+*           bulk queue. An unauth address event repeating an earlier
+*           (port, MAC, VLAN) of the same batch is dropped, since the
+*           first one already created or blocked the client.
+*
+* @end
+*********************************************************************/
+RC_t authmgrBulkBatchDispatch (authmgrBulkMsg_t * msg)
+{
+  authmgrBulkMsg_t batch[AUTHMGR_DISPATCH_BATCH_MAX];
+  uint32 count = 0, i = 0;
+   BOOL duplicate =  FALSE;
+  RC_t rc =  SUCCESS;
+
+  (void) osapiWriteLockTake (authmgrCB->authmgrRWLock,  WAIT_FOREVER);
+
+  batch[0] = *msg;
+  do
+  {
+    msg = &batch[count];
+    duplicate =  FALSE;
+    if (authmgrUnauthAddrCallBackEvent == msg->event)
+    {
+      for (i = 0; i < count; i++)
+      {
+        if ((batch[i].intf == msg->intf) &&
+            (batch[i].data.unauthParms.vlanId == msg->data.unauthParms.vlanId) &&
+            (0 == memcmp (batch[i].data.unauthParms.macAddr.addr,
+                          msg->data.unauthParms.macAddr.addr,  MAC_ADDR_LEN)))
+        {
+          duplicate =  TRUE;
+          break;
+        }
+      }
+    }
+
+    if ( TRUE != duplicate)
+    {
+      memset(&authmgrCB->processInfo, 0, sizeof(authmgrClientInfo_t));
+      memset(&authmgrCB->oldInfo, 0, sizeof(authmgrClientInfo_t));
+      switch (msg->event)
+      {
+        case authmgrUnauthAddrCallBackEvent:
+          rc =
+            authmgrCtlPortUnauthAddrCallbackProcess (msg->intf,
+                                                     msg->data.unauthParms.macAddr,
+                                                     msg->data.unauthParms.vlanId,
+                                                     msg->data.unauthParms.seenTime);
+          break;
+        default:
+          rc =  FAILURE;
+      }
+    }
+
+    count++;
+  } while ((count < AUTHMGR_DISPATCH_BATCH_MAX) &&
+           (osapiMessageReceive
+            (authmgrCB->authmgrBulkQueue, (void *) &batch[count],
+             (uint32) sizeof (authmgrBulkMsg_t),  NO_WAIT) ==  SUCCESS));
+
+  (void) osapiWriteLockGive (authmgrCB->authmgrRWLock);
+  return rc;
+}
+
+/*********************************************************************
+* @purpose  Write out the client FDB and STATE_DB updates of a batch
+*
+* @param    none
+*
+* @returns  void
+*
+* @comments Static MAC and oper table updates are buffered while
+*           messages are serviced and written here in one round trip
+*           per database.
+*
+* @end
+*********************************************************************/
+void authmgrBatchFlush (void)
+{
+  pacCfgFlush ();
+  PacOperTblFlush ();
+}
+
 /*********************************************************************
 * @purpose  Route the event to a handling function and grab the parms
 *
@@ -962,6 +1077,8 @@ RC_t authmgrTimerAction ()
 
   appTimerProcess (authmgrCB->globalInfo->authmgrTimerCB);
 
+  authmgrLatencyOperUpdate ();
+
   return  SUCCESS;
 }
 
@@ -1763,6 +1880,7 @@ RC_t authmgrCtlLogicalPortVlanAssignedReset (uint32 lIntIfNum)
 * @param    intIfNum   @b{(input)) internal interface number
 * @param    macAddr   @b{(input)) mac address 
 * @param    vlanId @b{(input)} vlan id
+* @param    seenTime @b{(input)} uptime in ms when the address was reported
 *
 * @returns   SUCCESS
 * @returns   FAILURE
@@ -1773,7 +1891,8 @@ RC_t authmgrCtlLogicalPortVlanAssignedReset (uint32 lIntIfNum)
 *********************************************************************/
 RC_t authmgrCtlPortUnauthAddrCallbackProcess (uint32 intIfNum,
                                                   enetMacAddr_t macAddr,
-                                                  ushort16 vlanId)
+                                                  ushort16 vlanId,
+                                                  uint32 seenTime)
 {
   uint32 lIntIfNum = 0;
    BOOL exists;
@@ -1865,6 +1984,9 @@ RC_t authmgrCtlPortUnauthAddrCallbackProcess (uint32 intIfNum,
     logicalPortInfo->client.vlanType = AUTHMGR_VLAN_DEFAULT;
     logicalPortInfo->client.blockVlanId = vlanId;
 
+    authmgrLatencyStamp (logicalPortInfo, AUTHMGR_STAGE_ADDR_SEEN, seenTime);
+    authmgrLatencyStamp (logicalPortInfo, AUTHMGR_STAGE_ADDR_PROCESSED, 0);
+
     if (!logicalPortInfo->protocol.authenticate)
     {
       AUTHMGR_EVENT_TRACE (AUTHMGR_TRACE_FSM_EVENTS, intIfNum,
@@ -2323,6 +2445,28 @@ RC_t authmgrPortControlForceUnAuthActionSet (uint32 intIfNum)
   return rc;
 }
 
+/*********************************************************************
+* @purpose  Port walk callback to clean up one client of a port
+*
+* @param    logicalPortInfo  @b{(input)) logical port node
+* @param    arg              @b{(input)) unused
+*
+* @returns   SUCCESS
+*
+* @comments
+*
+* @end
+*********************************************************************/
+static RC_t authmgrPortInfoCleanupWalk (authmgrLogicalPortInfo_t *logicalPortInfo,
+                                        void *arg)
+{
+  if (0 != logicalPortInfo->key.keyNum)
+  {
+    authmgrClientInfoCleanup (logicalPortInfo);
+  }
+  return  SUCCESS;
+}
+
 /*********************************************************************
 * @purpose function to clean up authmgr port oper info
 *
@@ -2338,9 +2482,7 @@ RC_t authmgrPortControlForceUnAuthActionSet (uint32 intIfNum)
 RC_t authmgrPortInfoCleanup (uint32 intIfNum)
 {
   RC_t rc =  SUCCESS;
-  uint32 lIntIfNum;
   authmgrPortCfg_t *pCfg;
-  authmgrLogicalPortInfo_t *logicalPortInfo;
 /*   BOOL valid =  FALSE; */
 
   if (authmgrIntfIsConfigurable (intIfNum, &pCfg) !=  TRUE)
@@ -2349,16 +2491,8 @@ RC_t authmgrPortInfoCleanup (uint32 intIfNum)
   }
 
   /* reset all the clients associated with the port */
-  lIntIfNum = AUTHMGR_LOGICAL_PORT_ITERATE;
-  while ( NULLPTR !=
-         (logicalPortInfo =
-          authmgrLogicalPortInfoGetNextNode (intIfNum, &lIntIfNum)))
-  {
-    if (0 != logicalPortInfo->key.keyNum)
-    {
-      authmgrClientInfoCleanup (logicalPortInfo);
-    }
-  }
+  (void) authmgrLogicalPortInfoPortWalk (intIfNum, authmgrPortInfoCleanupWalk,
+                                         NULLPTR);
   return rc;
 }
 
@@ -3135,6 +3269,31 @@ RC_t authmgrStatusSuccessAction (uint32 lIntIfNum,
   return authmgrGenerateEvents (lIntIfNum);
 }
 
+/*********************************************************************
+* @purpose  Port walk callback to purge a client authenticated by a method
+*
+* @param    logicalPortInfo  @b{(input)) logical port node
+* @param    arg              @b{(input)) pointer to the AUTHMGR_METHOD_t
+*
+* @returns   SUCCESS
+*
+* @comments
+*
+* @end
+*********************************************************************/
+static RC_t authmgrClientsByMethodDeleteWalk (authmgrLogicalPortInfo_t *logicalPortInfo,
+                                              void *arg)
+{
+  AUTHMGR_METHOD_t method = *(AUTHMGR_METHOD_t *) arg;
+
+  if (logicalPortInfo->client.authenticatedMethod == method)
+  {
+    /* cleanup the client */
+    authmgrClientInfoCleanup (logicalPortInfo); 
+  }
+  return  SUCCESS;
+}
+
 /*********************************************************************
 * @purpose deletes all the authenticated clients using the method
 *
@@ -3153,9 +3312,6 @@ RC_t authmgrClientsByMethodDelete (uint32 intIfNum,
 {
   /* This function purges all the clients who are
      authenticated using this method */
-  uint32 lIndex;
-  authmgrLogicalPortInfo_t *logicalPortInfo;
-
   if (authmgrIsValidIntf (intIfNum) !=  TRUE)
   {
     return  FAILURE;
@@ -3165,16 +3321,9 @@ RC_t authmgrClientsByMethodDelete (uint32 intIfNum,
                        "%s:Deleting clients authenticated with method %d on Physical port-%d \n",
                        __FUNCTION__, method, intIfNum);
 
-  lIndex = AUTHMGR_LOGICAL_PORT_ITERATE;
-  while ((logicalPortInfo =
-          authmgrLogicalPortInfoGetNextNode (intIfNum, &lIndex)) !=  NULLPTR)
-  {
-    if (logicalPortInfo->client.authenticatedMethod == method)
-    {
-      /* cleanup the client */
-      authmgrClientInfoCleanup (logicalPortInfo); 
-    }
-  }
+  (void) authmgrLogicalPortInfoPortWalk (intIfNum,
+                                         authmgrClientsByMethodDeleteWalk,
+                                         &method);
 
   return  SUCCESS;
 }
@@ -3613,6 +3762,9 @@ RC_t authmgrClientCallbackEventProcess (uint32 intIfNum,
 
       return  SUCCESS;
     }
+
+    /* the method has the server answer (or gave up waiting for it) */
+    authmgrLatencyStamp (logicalPortInfo, AUTHMGR_STAGE_METHOD_RESULT, 0);
   }
 
   memset (&entry, 0, sizeof (authmgrStatusMap_t));
@@ -4634,6 +4786,7 @@ RC_t authmgrAuthenticationTrigger (authmgrLogicalPortInfo_t *
       authmgrCB->globalInfo->authmgrCallbacks[logicalPortInfo->client.
                                               currentMethod].eventNotifyFn))
   {
+    authmgrLatencyStamp (logicalPortInfo, AUTHMGR_STAGE_METHOD_START, 0);
     rc =
       authmgrCB->globalInfo->authmgrCallbacks[logicalPortInfo->client.
                                               currentMethod].eventNotifyFn
@@ -5378,10 +5531,34 @@ void authmgrGlobalInfoPopulate()
 }
 
 
+/*********************************************************************
+* @purpose  Port walk callback to clean up a client on a given vlan
+*
+* @param    logicalPortInfo  @b{(input)) logical port node
+* @param    arg              @b{(input)) pointer to the vlan id
+*
+* @returns   SUCCESS
+*
+* @comments
+*
+* @end
+*********************************************************************/
+static RC_t authmgrVlanClientsCleanupWalk (authmgrLogicalPortInfo_t *logicalPortInfo,
+                                           void *arg)
+{
+  uint32 vlanId = *(uint32 *) arg;
+
+  if (vlanId == logicalPortInfo->client.vlanId)
+  {
+    authmgrClientInfoCleanup(logicalPortInfo);
+  }
+  return  SUCCESS;
+}
+
+
 RC_t authmgrVlanClientsCleanup(uint32 vlanId)
 {
-  uint32 intIfNum = 0, lIntIfNum = 0;
-  authmgrLogicalPortInfo_t *logicalPortInfo =  NULLPTR;
+  uint32 intIfNum = 0;
   RC_t nimRc =  SUCCESS;
 
   nimRc = authmgrFirstValidIntfNumber (&intIfNum);
@@ -5391,16 +5568,9 @@ RC_t authmgrVlanClientsCleanup(uint32 vlanId)
         && ( AUTHMGR_PORT_AUTO ==
           authmgrCB->globalInfo->authmgrPortInfo[intIfNum].portControlMode))
     {
-      lIntIfNum = AUTHMGR_LOGICAL_PORT_ITERATE;
-      while ((logicalPortInfo =
-            authmgrLogicalPortInfoGetNextNode (intIfNum,
-              &lIntIfNum)) !=  NULLPTR)
-      {
-        if (vlanId == logicalPortInfo->client.vlanId)
-        {
-          authmgrClientInfoCleanup(logicalPortInfo);
-        }
-      }
+      (void) authmgrLogicalPortInfoPortWalk (intIfNum,
+                                             authmgrVlanClientsCleanupWalk,
+                                             &vlanId);
     }
     nimRc = authmgrNextValidIntf (intIfNum, &intIfNum);
   }
@@ -1407,3 +1407,65 @@ void authmgrUserCountDump(uint32 intIfNum)
   return;
 }
 
+
+/*********************************************************************
+* @purpose  Show the authentication pipeline latency histograms
+*
+* @param    none
+*
+* @returns  void
+*
+* @comments devshell command. Bucket i counts samples below 2^i ms.
+*
+* @end
+*********************************************************************/
+void authmgrDebugLatencyShow (void)
+{
+  authmgrLatencyHist_t hist;
+  uint32 seg, idx;
+
+  SYSAPI_PRINTF ("AUTHMGR authentication latency (ms):\r\n");
+  SYSAPI_PRINTF ("-----------------------------------\r\n");
+
+  for (seg = 0; seg < AUTHMGR_LATENCY_SEGMENT_LAST; seg++)
+  {
+    if ( SUCCESS != authmgrLatencyHistGet (seg, &hist))
+    {
+      continue;
+    }
+
+    SYSAPI_PRINTF ("%-8s count = %u avg = %u max = %u\r\n",
+                   authmgrLatencySegmentNameGet (seg), hist.count,
+                   (0 != hist.count) ? (uint32)(hist.sumMs / hist.count) : 0,
+                   hist.maxMs);
+
+    for (idx = 0; idx < AUTHMGR_LATENCY_BUCKETS; idx++)
+    {
+      if (0 != hist.bucket[idx])
+      {
+        SYSAPI_PRINTF ("         %s %6u : %u\r\n",
+                       (idx < (AUTHMGR_LATENCY_BUCKETS - 1)) ? "<" : ">=",
+                       (idx < (AUTHMGR_LATENCY_BUCKETS - 1)) ? (1 << idx) : (1 << (idx - 1)),
+                       hist.bucket[idx]);
+      }
+    }
+  }
+}
+
+/*********************************************************************
+* @purpose  Clear the authentication pipeline latency histograms
+*
+* @param    none
+*
+* @returns  void
+*
+* @comments devshell command
+*
+* @end
+*********************************************************************/
+void authmgrDebugLatencyClear (void)
+{
+  (void) osapiWriteLockTake (authmgrCB->authmgrRWLock,  WAIT_FOREVER);
+  authmgrLatencyStatsClear ();
+  (void) osapiWriteLockGive (authmgrCB->authmgrRWLock);
+}
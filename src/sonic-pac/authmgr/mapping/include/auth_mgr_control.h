@@ -139,6 +139,7 @@ typedef struct authmgrUnauthCallbackParms_s
 {
    enetMacAddr_t  macAddr;
    ushort16       vlanId;
+   uint32         seenTime; /* uptime in ms when the address was reported */
 } authmgrUnauthCallbackParms_t;
 
 typedef struct authmgrMgmtTimePeriod_s
@@ -186,6 +187,7 @@ typedef struct authmgrVlanMsg_s
 #define AUTHMGR_MSG_COUNT       FD_AUTHMGR_MSG_COUNT
 #define AUTHMGR_VLAN_MSG_COUNT  (16 * 1024)
 #define AUTHMGR_TIMER_TICK      1000 /*in milliseconds*/
+#define AUTHMGR_DISPATCH_BATCH_MAX  64 /* messages serviced per task wakeup */
 
 typedef RC_t(*authmgrStatusMapFn_t) (uint32 lIntIfNum, authmgrAuthRespParams_t *params);
 
@@ -217,6 +219,8 @@ extern RC_t authmgrVlanFillMsg (void *data, authmgrVlanMsg_t * msg);
 extern RC_t authmgrIssueCmd(uint32 event, uint32 intIfNum, void *data);
 extern RC_t authmgrDispatchCmd(authmgrMsg_t *msg);
 extern RC_t authmgrBulkDispatchCmd(authmgrBulkMsg_t *msg);
+extern RC_t authmgrBulkBatchDispatch(authmgrBulkMsg_t *msg);
+extern void authmgrBatchFlush(void);
 extern RC_t authmgrVlanDispatchCmd (authmgrVlanMsg_t * msg);
 extern RC_t authmgrTimerAction();
 
@@ -254,7 +258,8 @@ extern RC_t authmgrVlanPVIDChangeEventProcess(uint32 intIfNum,uint32 vlanId);
 
 extern RC_t authmgrCtlLogicalPortVlanAssignedReset(uint32 lIntIfNum);
 extern RC_t authmgrCtlLogicalPortVlanAssignmentDisable(authmgrLogicalPortInfo_t *logicalPortInfo);
-extern RC_t authmgrCtlPortUnauthAddrCallbackProcess(uint32 intIfNum, enetMacAddr_t macAddr, ushort16 vlanId);
+extern RC_t authmgrCtlPortUnauthAddrCallbackProcess(uint32 intIfNum, enetMacAddr_t macAddr, ushort16 vlanId,
+                                                    uint32 seenTime);
 
 /*MAB*/
 extern RC_t authmgrCtlLogicalPortMABTimerStart(uint32 lIntIfNum);
@@ -137,6 +137,8 @@ void authmgrDebugLogicalPortInfoShow(uint32 intIfNum, uint32 lIntIfNum);
 
 RC_t authmgrLportPortGet(uint32 *intIfNum, uint32 *lIntIfNum);
 void authmgrUserCountDump(uint32 intIfNum);
+void authmgrDebugLatencyShow(void);
+void authmgrDebugLatencyClear(void);
 RC_t authmgrDebugLogicalPortInfoNextGet (uint32 intIfNum, uint32 *lIntIfNum, 
                                             authmgrLogicalPortDebugInfo_t *debugInfo);
   /* USE C Declarations */
@@ -61,6 +61,10 @@ typedef struct authmgrGlobalInfo_s
   VLAN_MASK_t authmgrVlanMask;
   int32 eap_socket;
   uint32 reservedVlan;
+
+  /* authentication pipeline latency histograms */
+  authmgrLatencyHist_t authmgrLatency[AUTHMGR_LATENCY_SEGMENT_LAST];
+  BOOL authmgrLatencyChanged;
 }authmgrGlobalInfo_t;
 
 typedef struct authmgrCB_s
@@ -364,6 +364,47 @@ authmgrLogicalPortInfo_t *authmgrLogicalPortInfoGetNext (uint32 lIntIfNum)
   return entry;
 }
 
+/*********************************************************************
+* @purpose  To get the next Logical Port Info Node of a physical interface
+*
+* @param    intIfNum  @b{(input)} The internal interface
+* @param    keyNum    @b{(input)} The logical key to start the search from
+*
+* @returns  Logical Internal Interface node
+*
+* @comments Uses a single AVL_NEXT search instead of probing every
+*           logical port slot. Returns NULLPTR once the search moves
+*           past the logical ports of intIfNum.
+*
+* @end
+*********************************************************************/
+static authmgrLogicalPortInfo_t *authmgrLogicalPortInfoPortNextGet (uint32 intIfNum,
+                                                                    uint32 keyNum)
+{
+  authmgrLogicalNodeKey_t key;
+  uint32 physPort = 0, lPort = 0, type = 0;
+  authmgrLogicalPortInfo_t *entry =  NULLPTR;
+
+  key.keyNum = keyNum;
+  entry =
+    (authmgrLogicalPortInfo_t *) avlSearch (&authmgrCB->globalInfo->
+                                                authmgrLogicalPortTreeDb,
+                                                &key, AVL_NEXT);
+  if (entry ==  NULLPTR)
+  {
+    return  NULLPTR;
+  }
+
+  AUTHMGR_LPORT_KEY_UNPACK (physPort, lPort, type, entry->key.keyNum);
+  if ((physPort != intIfNum) || (AUTHMGR_LOGICAL != type) ||
+      (lPort >= AUTHMGR_LOGICAL_PORT_END))
+  {
+    return  NULLPTR;
+  }
+
+  return entry;
+}
+
 /*********************************************************************
 * @purpose  To get First logical interfaces for dynamically allocated nodes
 *
@@ -382,21 +423,27 @@ authmgrLogicalPortInfo_t *authmgrDynamicLogicalPortInfoFirstGet (uint32
                                                                  lIntIfNum)
 {
   authmgrLogicalPortInfo_t *node;
-  uint32 maxintf = AUTHMGR_LOGICAL_PORT_END;
-  uint32 lPort = 0;
   uint32 temp = 0;
 
-  lPort = AUTHMGR_LOGICAL_PORT_START;
-  AUTHMGR_LPORT_KEY_PACK (intIfNum, lPort, AUTHMGR_LOGICAL, temp);
-  while ((node = authmgrLogicalPortInfoGet (temp)) ==  NULLPTR &&
-         lPort < maxintf)
+  AUTHMGR_LPORT_KEY_PACK (intIfNum, AUTHMGR_LOGICAL_PORT_START,
+                          AUTHMGR_LOGICAL, temp);
+  node = authmgrLogicalPortInfoGet (temp);
+  if (node ==  NULLPTR)
   {
-    lPort = lPort + 1;
-    temp = 0;
-    AUTHMGR_LPORT_KEY_PACK (intIfNum, lPort, AUTHMGR_LOGICAL, temp);
+    node = authmgrLogicalPortInfoPortNextGet (intIfNum, temp);
   }
 
-  *lIntIfNum = temp;
+  if (node !=  NULLPTR)
+  {
+    *lIntIfNum = node->key.keyNum;
+  }
+  else
+  {
+    temp = 0;
+    AUTHMGR_LPORT_KEY_PACK (intIfNum, AUTHMGR_LOGICAL_PORT_END,
+                            AUTHMGR_LOGICAL, temp);
+    *lIntIfNum = temp;
+  }
   return node;
 }
 
@@ -432,20 +479,96 @@ authmgrLogicalPortInfo_t *authmgrDynamicLogicalPortInfoGetNextNode (uint32
     return  NULLPTR;
   }
 
-  lPort = lPort + 1;
   AUTHMGR_LPORT_KEY_PACK (intIfNum, lPort, AUTHMGR_LOGICAL, temp);
-  while ((node = authmgrLogicalPortInfoGet (temp)) ==  NULLPTR &&
-         lPort < AUTHMGR_LOGICAL_PORT_END)
+  node = authmgrLogicalPortInfoPortNextGet (intIfNum, temp);
+  if (node !=  NULLPTR)
+  {
+    *lIntIfNum = node->key.keyNum;
+  }
+  else
   {
-    lPort = lPort + 1;
     temp = 0;
-    AUTHMGR_LPORT_KEY_PACK (intIfNum, lPort, AUTHMGR_LOGICAL, temp);
+    AUTHMGR_LPORT_KEY_PACK (intIfNum, AUTHMGR_LOGICAL_PORT_END,
+                            AUTHMGR_LOGICAL, temp);
+    *lIntIfNum = temp;
   }
-
-  *lIntIfNum = temp;
   return node;
 }
 
+/*********************************************************************
+* @purpose  To visit all the logical interfaces of a physical interface
+*
+* @param    intIfNum  @b{(input)} The internal interface
+* @param    walkFn    @b{(input)} Function invoked for every logical node
+* @param    arg       @b{(input)} Opaque argument passed to walkFn
+*
+* @returns   SUCCESS or  FAILURE
+*
+* @comments The logical keys of the port are collected in one pass over
+*           the tree with the logical port lock held. walkFn is invoked
+*           after the lock is released, so it may delete the node it is
+*           handed (or any other node). Nodes deleted before their turn
+*           are skipped. The walk stops at the first walkFn failure.
+*
+* @end
+*********************************************************************/
+RC_t authmgrLogicalPortInfoPortWalk (uint32 intIfNum,
+                                     authmgrLogicalPortWalkFn_t walkFn,
+                                     void *arg)
+{
+  uint32 keys[AUTHMGR_LOGICAL_PORT_END];
+  uint32 count = 0, i = 0, temp = 0;
+  authmgrLogicalPortInfo_t *node =  NULLPTR;
+   BOOL valid =  FALSE;
+  RC_t rc =  SUCCESS;
+
+  if (walkFn ==  NULLPTR)
+  {
+    return  FAILURE;
+  }
+
+  authmgrHostIsDynamicNodeAllocCheck (authmgrCB->globalInfo->
+                                      authmgrPortInfo[intIfNum].hostMode,
+                                      &valid);
+  if ( TRUE != valid)
+  {
+    return  SUCCESS;
+  }
+
+  AUTHMGR_LPORT_KEY_PACK (intIfNum, AUTHMGR_LOGICAL_PORT_START,
+                          AUTHMGR_LOGICAL, temp);
+
+  (void) authmgrLogicalPortInfoTakeLock ();
+  node = authmgrLogicalPortInfoGet (temp);
+  if (node ==  NULLPTR)
+  {
+    node = authmgrLogicalPortInfoPortNextGet (intIfNum, temp);
+  }
+  while ((node !=  NULLPTR) && (count < AUTHMGR_LOGICAL_PORT_END))
+  {
+    keys[count++] = node->key.keyNum;
+    node = authmgrLogicalPortInfoPortNextGet (intIfNum, node->key.keyNum);
+  }
+  (void) authmgrLogicalPortInfoGiveLock ();
+
+  for (i = 0; i < count; i++)
+  {
+    node = authmgrLogicalPortInfoGet (keys[i]);
+    if (node ==  NULLPTR)
+    {
+      continue;
+    }
+
+    rc = walkFn (node, arg);
+    if (rc !=  SUCCESS)
+    {
+      break;
+    }
+  }
+
+  return rc;
+}
+
 /*********************************************************************
 * @purpose  Debug Info of the Logical Port DB
 *
@@ -515,7 +638,7 @@ authmgrLogicalPortInfo_t *authmgrLogicalPortInfoGetNextNode (uint32 intIfNum,
                                                              uint32 *
                                                              lIntIfNum)
 {
-  authmgrLogicalPortInfo_t *node;
+  authmgrLogicalPortInfo_t *node =  NULLPTR;
    BOOL valid =  FALSE;
 
   authmgrHostIsDynamicNodeAllocCheck (authmgrCB->globalInfo->
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "auth_mgr_include.h"
+#include "auth_mgr_struct.h"
+#include "auth_mgr_latency.h"
+#include "pacoper_common.h"
+
+extern authmgrCB_t *authmgrCB;
+
+static const char8 *authmgrLatencySegmentNames[AUTHMGR_LATENCY_SEGMENT_LAST] =
+{
+  "queue", "start", "server", "program", "total"
+};
+
+/* start and end stage of each latency segment */
+static const authmgrLatencyStage_t authmgrLatencySegmentStages[AUTHMGR_LATENCY_SEGMENT_LAST][2] =
+{
+  { AUTHMGR_STAGE_ADDR_SEEN,      AUTHMGR_STAGE_ADDR_PROCESSED },
+  { AUTHMGR_STAGE_ADDR_PROCESSED, AUTHMGR_STAGE_METHOD_START },
+  { AUTHMGR_STAGE_METHOD_START,   AUTHMGR_STAGE_METHOD_RESULT },
+  { AUTHMGR_STAGE_METHOD_RESULT,  AUTHMGR_STAGE_AUTHORIZED },
+  { AUTHMGR_STAGE_ADDR_SEEN,      AUTHMGR_STAGE_AUTHORIZED }
+};
+
+/*********************************************************************
+ * @purpose  Add a sample to a latency histogram
+ *
+ * @param    hist     @b{(input)} histogram
+ * @param    deltaMs  @b{(input)} latency in ms
+ *
+ * @returns  none
+ *
+ * @end
+ *********************************************************************/
+static void authmgrLatencyHistAdd(authmgrLatencyHist_t *hist, uint32 deltaMs)
+{
+  uint32 idx = 0;
+
+  while ((idx < (AUTHMGR_LATENCY_BUCKETS - 1)) && ((deltaMs >> idx) != 0))
+  {
+    idx++;
+  }
+
+  hist->count++;
+  hist->sumMs += deltaMs;
+  if (deltaMs > hist->maxMs)
+  {
+    hist->maxMs = deltaMs;
+  }
+  hist->bucket[idx]++;
+}
+
+/*********************************************************************
+ * @purpose  Record the time a client reached a pipeline stage
+ *
+ * @param    logicalPortInfo @b{(input)} logical port node
+ * @param    stage           @b{(input)} pipeline stage
+ * @param    stampMs         @b{(input)} uptime in ms, 0 for now
+ *
+ * @returns  none
+ *
+ * @comments Reaching ADDR_SEEN or METHOD_START again discards the
+ *           later stamps so a retried attempt is measured afresh.
+ *
+ * @end
+ *********************************************************************/
+void authmgrLatencyStamp(authmgrLogicalPortInfo_t *logicalPortInfo,
+                         authmgrLatencyStage_t stage, uint32 stampMs)
+{
+  authmgrLatencyTrace_t *trace;
+  uint32 idx;
+
+  if (( NULLPTR == logicalPortInfo) || (stage >= AUTHMGR_STAGE_LAST))
+  {
+    return;
+  }
+
+  trace = &logicalPortInfo->client.latencyTrace;
+
+  if (0 == stampMs)
+  {
+    stampMs = osapiUpTimeMillisecondsGet();
+  }
+
+  if ((AUTHMGR_STAGE_ADDR_SEEN == stage) ||
+      (AUTHMGR_STAGE_METHOD_START == stage))
+  {
+    for (idx = stage + 1; idx < AUTHMGR_STAGE_LAST; idx++)
+    {
+      trace->stamp[idx] = 0;
+    }
+  }
+
+  /* 0 marks a stage as not reached */
+  trace->stamp[stage] = (0 != stampMs) ? stampMs : 1;
+}
+
+/*********************************************************************
+ * @purpose  Stamp a client authorized and fold its trace into the
+ *           latency histograms
+ *
+ * @param    logicalPortInfo @b{(input)} logical port node
+ *
+ * @returns  none
+ *
+ * @comments Only segments with both end points stamped are counted.
+ *
+ * @end
+ *********************************************************************/
+void authmgrLatencyClientAuthorized(authmgrLogicalPortInfo_t *logicalPortInfo)
+{
+  authmgrLatencyTrace_t *trace;
+  uint32 seg, start, end;
+
+  if ( NULLPTR == logicalPortInfo)
+  {
+    return;
+  }
+
+  authmgrLatencyStamp(logicalPortInfo, AUTHMGR_STAGE_AUTHORIZED, 0);
+
+  trace = &logicalPortInfo->client.latencyTrace;
+
+  for (seg = 0; seg < AUTHMGR_LATENCY_SEGMENT_LAST; seg++)
+  {
+    start = trace->stamp[authmgrLatencySegmentStages[seg][0]];
+    end = trace->stamp[authmgrLatencySegmentStages[seg][1]];
+
+    if ((0 == start) || (0 == end))
+    {
+      continue;
+    }
+
+    /* unsigned difference is wrap safe */
+    authmgrLatencyHistAdd(&authmgrCB->globalInfo->authmgrLatency[seg],
+                          end - start);
+    authmgrCB->globalInfo->authmgrLatencyChanged =  TRUE;
+  }
+
+  /* re-authentication restarts from METHOD_START */
+  memset(trace, 0, sizeof(*trace));
+}
+
+/*********************************************************************
+ * @purpose  Publish the latency histograms to STATE_DB if they
+ *           changed since the last call
+ *
+ * @returns  none
+ *
+ * @comments Called from the authmgr timer tick.
+ *
+ * @end
+ *********************************************************************/
+void authmgrLatencyOperUpdate(void)
+{
+  pac_auth_latency_oper_table_t info;
+  authmgrLatencyHist_t *hist;
+  uint32 seg;
+
+  if ( TRUE != authmgrCB->globalInfo->authmgrLatencyChanged)
+  {
+    return;
+  }
+  authmgrCB->globalInfo->authmgrLatencyChanged =  FALSE;
+
+  for (seg = 0; seg < AUTHMGR_LATENCY_SEGMENT_LAST; seg++)
+  {
+    hist = &authmgrCB->globalInfo->authmgrLatency[seg];
+
+    memset(&info, 0, sizeof(info));
+    info.count = hist->count;
+    info.avgMs = (0 != hist->count) ? (uint32)(hist->sumMs / hist->count) : 0;
+    info.maxMs = hist->maxMs;
+    memcpy(info.bucket, hist->bucket, sizeof(info.bucket));
+
+    PacAuthLatencyOperTblSet(authmgrLatencySegmentNames[seg], &info);
+  }
+}
+
+/*********************************************************************
+ * @purpose  Get a copy of a latency histogram
+ *
+ * @param    segment @b{(input)}  latency segment
+ * @param    hist    @b{(output)} histogram
+ *
+ * @returns  SUCCESS
+ * @returns  FAILURE  invalid segment
+ *
+ * @end
+ *********************************************************************/
+RC_t authmgrLatencyHistGet(authmgrLatencySegment_t segment,
+                           authmgrLatencyHist_t *hist)
+{
+  if ((segment >= AUTHMGR_LATENCY_SEGMENT_LAST) || ( NULLPTR == hist))
+  {
+    return  FAILURE;
+  }
+
+  *hist = authmgrCB->globalInfo->authmgrLatency[segment];
+  return  SUCCESS;
+}
+
+/*********************************************************************
+ * @purpose  Get the display name of a latency segment
+ *
+ * @param    segment @b{(input)}  latency segment
+ *
+ * @returns  segment name
+ *
+ * @end
+ *********************************************************************/
+const char8 *authmgrLatencySegmentNameGet(authmgrLatencySegment_t segment)
+{
+  if (segment >= AUTHMGR_LATENCY_SEGMENT_LAST)
+  {
+    return "unknown";
+  }
+  return authmgrLatencySegmentNames[segment];
+}
+
+/*********************************************************************
+ * @purpose  Reset all latency histograms
+ *
+ * @returns  none
+ *
+ * @end
+ *********************************************************************/
+void authmgrLatencyStatsClear(void)
+{
+  memset(authmgrCB->globalInfo->authmgrLatency, 0,
+         sizeof(authmgrCB->globalInfo->authmgrLatency));
+  authmgrCB->globalInfo->authmgrLatencyChanged =  TRUE;
+}
@@ -29,6 +29,7 @@ extern "C" {
 #include "auth_mgr_sm.h"
 #include "auth_mgr_vlan.h"
 #include "auth_mgr_util.h"
+#include "auth_mgr_latency.h"
 #include "avl_api.h"
 
 
@@ -143,6 +144,9 @@ typedef struct authmgrClientInfo_s
    AUTHMGR_PORT_MAB_AUTH_TYPE_t mabAuthType; /* Authentication type used by MAB. To be filled in only if isMABClient is  TRUE */
 
   uint32 attrCreateMask;
+
+  /* authentication pipeline stage time stamps */
+  authmgrLatencyTrace_t latencyTrace;
 }authmgrClientInfo_t;
 
 typedef struct authmgrLogicalNodeKey_s
@@ -312,6 +316,8 @@ typedef struct authmgrStatsMap_s
 
 typedef RC_t(*authmgrHwCleanupEventFn_t) (authmgrLogicalPortInfo_t *logicalPortInfo);
 
+typedef RC_t(*authmgrLogicalPortWalkFn_t) (authmgrLogicalPortInfo_t *logicalPortInfo, void *arg);
+
 typedef struct authmgrHwCleanupEventMap_s
 {
   uint32  event;
@@ -371,6 +377,10 @@ authmgrLogicalPortInfo_t *authmgrLogicalPortInfoFirstGet(uint32 intIfNum,
 authmgrLogicalPortInfo_t *authmgrLogicalPortInfoGetNextNode(uint32 intIfNum,
                                                         uint32 *lIntIfNum);
 
+RC_t authmgrLogicalPortInfoPortWalk(uint32 intIfNum,
+                                    authmgrLogicalPortWalkFn_t walkFn,
+                                    void *arg);
+
 /* USE C Declarations */
 #ifdef __cplusplus
 }
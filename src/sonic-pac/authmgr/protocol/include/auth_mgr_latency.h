@@ -0,0 +1,150 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INCLUDE_AUTHMGR_LATENCY_H
+#define INCLUDE_AUTHMGR_LATENCY_H
+
+/* USE C Declarations */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "datatypes.h"
+
+/* Points of the authentication pipeline a client is time stamped at */
+typedef enum authmgrLatencyStage_s
+{
+  AUTHMGR_STAGE_ADDR_SEEN = 0,  /* unauth source MAC reported by pacmgr */
+  AUTHMGR_STAGE_ADDR_PROCESSED, /* address serviced by the authmgr task */
+  AUTHMGR_STAGE_METHOD_START,   /* auth start handed to dot1x/MAB */
+  AUTHMGR_STAGE_METHOD_RESULT,  /* method reported the server result */
+  AUTHMGR_STAGE_AUTHORIZED,     /* client authorized and oper table set */
+  AUTHMGR_STAGE_LAST
+}authmgrLatencyStage_t;
+
+/* Latency segments aggregated from the stage time stamps */
+typedef enum authmgrLatencySegment_s
+{
+  AUTHMGR_LATENCY_QUEUE = 0,   /* ADDR_SEEN     -> ADDR_PROCESSED */
+  AUTHMGR_LATENCY_START,       /* ADDR_PROCESSED -> METHOD_START */
+  AUTHMGR_LATENCY_SERVER,      /* METHOD_START  -> METHOD_RESULT */
+  AUTHMGR_LATENCY_PROGRAM,     /* METHOD_RESULT -> AUTHORIZED */
+  AUTHMGR_LATENCY_TOTAL,       /* ADDR_SEEN     -> AUTHORIZED */
+  AUTHMGR_LATENCY_SEGMENT_LAST
+}authmgrLatencySegment_t;
+
+/* Bucket i counts samples below 2^i ms, the last one is open ended */
+#define AUTHMGR_LATENCY_BUCKETS   16
+
+typedef struct authmgrLatencyHist_s
+{
+  uint32 count;
+  uint32 maxMs;
+  uint64 sumMs;
+  uint32 bucket[AUTHMGR_LATENCY_BUCKETS];
+}authmgrLatencyHist_t;
+
+typedef struct authmgrLatencyTrace_s
+{
+  /* osapiUpTimeMillisecondsGet() at each stage, 0 if not reached */
+  uint32 stamp[AUTHMGR_STAGE_LAST];
+}authmgrLatencyTrace_t;
+
+struct authmgrLogicalPortInfo_s;
+
+/*********************************************************************
+ * @purpose  Record the time a client reached a pipeline stage
+ *
+ * @param    logicalPortInfo @b{(input)} logical port node
+ * @param    stage           @b{(input)} pipeline stage
+ * @param    stampMs         @b{(input)} uptime in ms, 0 for now
+ *
+ * @returns  none
+ *
+ * @comments Reaching ADDR_SEEN or METHOD_START again discards the
+ *           later stamps so a retried attempt is measured afresh.
+ *
+ * @end
+ *********************************************************************/
+void authmgrLatencyStamp(struct authmgrLogicalPortInfo_s *logicalPortInfo,
+                         authmgrLatencyStage_t stage, uint32 stampMs);
+
+/*********************************************************************
+ * @purpose  Stamp a client authorized and fold its trace into the
+ *           latency histograms
+ *
+ * @param    logicalPortInfo @b{(input)} logical port node
+ *
+ * @returns  none
+ *
+ * @comments Only segments with both end points stamped are counted.
+ *
+ * @end
+ *********************************************************************/
+void authmgrLatencyClientAuthorized(struct authmgrLogicalPortInfo_s *logicalPortInfo);
+
+/*********************************************************************
+ * @purpose  Publish the latency histograms to STATE_DB if they
+ *           changed since the last call
+ *
+ * @returns  none
+ *
+ * @comments Called from the authmgr timer tick.
+ *
+ * @end
+ *********************************************************************/
+void authmgrLatencyOperUpdate(void);
+
+/*********************************************************************
+ * @purpose  Get a copy of a latency histogram
+ *
+ * @param    segment @b{(input)}  latency segment
+ * @param    hist    @b{(output)} histogram
+ *
+ * @returns  SUCCESS
+ * @returns  FAILURE  invalid segment
+ *
+ * @end
+ *********************************************************************/
+RC_t authmgrLatencyHistGet(authmgrLatencySegment_t segment,
+                           authmgrLatencyHist_t *hist);
+
+/*********************************************************************
+ * @purpose  Get the display name of a latency segment
+ *
+ * @param    segment @b{(input)}  latency segment
+ *
+ * @returns  segment name
+ *
+ * @end
+ *********************************************************************/
+const char8 *authmgrLatencySegmentNameGet(authmgrLatencySegment_t segment);
+
+/*********************************************************************
+ * @purpose  Reset all latency histograms
+ *
+ * @returns  none
+ *
+ * @end
+ *********************************************************************/
+void authmgrLatencyStatsClear(void);
+
+/* USE C Declarations */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_AUTHMGR_LATENCY_H */
@@ -234,6 +234,9 @@ extern  BOOL pacCfgIntfClientBlock(char *interface,  uchar8 *mac_addr, int vlan)
 /* Unblock a client's traffic */
 extern  BOOL pacCfgIntfClientUnblock(char *interface,  uchar8 *mac_addr, int vlan);
 
+/* Write out buffered client updates */
+extern void pacCfgFlush(void);
+
 /* Set port PVID */
 extern RC_t pacCfgPortPVIDSet(char *interface, int pvid);
 
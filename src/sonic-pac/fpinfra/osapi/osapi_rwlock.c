@@ -24,12 +24,20 @@
 #include "osapi.h"
 #include "osapi_priv.h"
 
+/*
+ * Readers are counted in an atomic state word and only fall back to the
+ * mutex and wait queues when a writer holds or waits for the lock (or the
+ * lock is being deleted). Writers always go through the mutex. A waiting
+ * writer blocks new readers, and a releasing writer hands the lock to the
+ * next waiting writer before readers, i.e. writers are preferred.
+ */
 typedef struct osapi_rwlock_s
 {
   volatile uint32 flags;
   pthread_mutex_t lock;
-  volatile uint32 rcount;
-  volatile uint32 wcount;
+  volatile uint32 state;        /* reader count and RWSTATE_ bits */
+  volatile uint32 wcount;       /* writers holding the lock, 0 or 1 */
+  volatile uint32 wpending;     /* writers waiting for the lock */
   osapi_waitq_t rqueue;
   osapi_waitq_t wqueue;
   struct osapi_rwlock_s *chain_prev, *chain_next;
@@ -40,6 +48,13 @@ typedef struct osapi_rwlock_s
 #define RWLOCK_Q_FIFO      0x00000004
 #define RWLOCK_Q_PRIO      0x00000008
 
+#define RWSTATE_READERS    0x3FFFFFFF
+#define RWSTATE_WRITER     0x40000000   /* writer holds or waits for the lock */
+#define RWSTATE_DELETED    0x80000000
+
+#define RWSTATE_GET(_l)    __atomic_load_n (&(_l)->state, __ATOMIC_ACQUIRE)
+#define RWSTATE_RCOUNT(_l) (RWSTATE_GET (_l) & RWSTATE_READERS)
+
 static pthread_mutex_t rwlock_list_lock = PTHREAD_MUTEX_INITIALIZER;
 static osapi_rwlock_t *rwlock_list_head = NULL;
 
@@ -83,8 +98,9 @@ RC_t osapiRWLockCreate (osapiRWLock_t * rwlock, osapiRWLockOptions_t options)
     q_options = WAITQ_PRIO;
   }
 
-  newRWLock->rcount = 0;
+  newRWLock->state = 0;
   newRWLock->wcount = 0;
+  newRWLock->wpending = 0;
   osapi_waitq_create (&(newRWLock->rqueue), &(newRWLock->lock), q_options);
   osapi_waitq_create (&(newRWLock->wqueue), &(newRWLock->lock), q_options);
 
@@ -108,7 +124,7 @@ static int osapi_rwlock_r_waitq_remove_check (void *rwlock)
 {
   osapi_rwlock_t *osapiRWLock = (osapi_rwlock_t *) rwlock;
 
-  if (osapiRWLock->wcount == 0)
+  if ((RWSTATE_GET (osapiRWLock) & RWSTATE_WRITER) == 0)
   {
     return WAITQ_REMOVE_OK;
   }
@@ -132,7 +148,7 @@ static int osapi_rwlock_r_waitq_remove_check (void *rwlock)
  * @returns   SUCCESS
  * @returns   FAILURE if timeout or if lock does not exist
  *
- * @comments None.
+ * @comments Uncontended readers only update the atomic reader count.
  *
  * @end
  *
@@ -141,17 +157,37 @@ RC_t osapiReadLockTake (osapiRWLock_t rwlock,  int32 timeout)
 {
   RC_t rc =  SUCCESS;
   osapi_rwlock_t *osapiRWLock = (osapi_rwlock_t *) rwlock.handle;
+  uint32 state;
+
+  /* no writer active or waiting, just count the reader */
+  state = __atomic_load_n (&osapiRWLock->state, __ATOMIC_RELAXED);
+  while ((state & (RWSTATE_WRITER | RWSTATE_DELETED)) == 0)
+  {
+    if (__atomic_compare_exchange_n (&osapiRWLock->state, &state, state + 1,
+                                     1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+      return  SUCCESS;
+    }
+  }
 
   /* Timeout is already in milliseconds, which is what
      osapi_waitq_enqueue() needs */
 
   pthread_mutex_lock (&(osapiRWLock->lock));
 
-  if ((osapiRWLock->flags & RWLOCK_DELETED) == 0)
+  for (;;)
   {
-    /* wait for writes to complete */
-    while (osapiRWLock->wcount > 0)
+    state = RWSTATE_GET (osapiRWLock);
+
+    if ((state & RWSTATE_DELETED) != 0)
+    {
+      rc =  FAILURE;
+      break;
+    }
+
+    if ((state & RWSTATE_WRITER) != 0)
     {
+      /* wait for pending and active writes to complete */
       rc = osapi_waitq_enqueue (&(osapiRWLock->rqueue), timeout,
                                 osapi_rwlock_r_waitq_remove_check,
                                 (void *) osapiRWLock, __FP_CALLER__);
@@ -161,17 +197,17 @@ RC_t osapiReadLockTake (osapiRWLock_t rwlock,  int32 timeout)
         rc =  FAILURE;
         break;
       }
+      continue;
     }
 
-    if (rc ==  SUCCESS)
+    /* writer bits only change under the mutex, so only fast path
+       readers can make this fail */
+    if (__atomic_compare_exchange_n (&osapiRWLock->state, &state, state + 1,
+                                     0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
     {
-      osapiRWLock->rcount++;
+      break;
     }
   }
-  else
-  {
-    rc =  FAILURE;
-  }
 
   pthread_mutex_unlock (&(osapiRWLock->lock));
 
@@ -194,32 +230,40 @@ RC_t osapiReadLockTake (osapiRWLock_t rwlock,  int32 timeout)
  *************************************************************************/
 RC_t osapiReadLockGive (osapiRWLock_t rwlock)
 {
-  RC_t rc =  SUCCESS;
   osapi_rwlock_t *osapiRWLock = (osapi_rwlock_t *) rwlock.handle;
+  uint32 state;
 
-  pthread_mutex_lock (&(osapiRWLock->lock));
-
-  if (osapiRWLock->rcount == 0)
-  {
-    rc =  ERROR;
-  }
-  else
+  state = __atomic_load_n (&osapiRWLock->state, __ATOMIC_RELAXED);
+  do
   {
-    if (--osapiRWLock->rcount == 0)
+    if ((state & RWSTATE_READERS) == 0)
     {
-      osapi_waitq_dequeue (&(osapiRWLock->wqueue));
+      return  ERROR;
     }
   }
-  pthread_mutex_unlock (&(osapiRWLock->lock));
+  while (!__atomic_compare_exchange_n (&osapiRWLock->state, &state, state - 1,
+                                       1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+  state--;
+
+  /* The last reader out wakes a waiting writer (or the deleting task).
+     Writers test the reader count under the mutex before waiting, so
+     taking it here cannot miss one. */
+  if (((state & RWSTATE_READERS) == 0) &&
+      ((state & (RWSTATE_WRITER | RWSTATE_DELETED)) != 0))
+  {
+    pthread_mutex_lock (&(osapiRWLock->lock));
+    osapi_waitq_dequeue (&(osapiRWLock->wqueue));
+    pthread_mutex_unlock (&(osapiRWLock->lock));
+  }
 
-  return rc;
+  return  SUCCESS;
 }
 
 static int osapi_rwlock_w_waitq_remove_check (void *rwlock)
 {
   osapi_rwlock_t *osapiRWLock = (osapi_rwlock_t *) rwlock;
 
-  if ((osapiRWLock->rcount == 0) && (osapiRWLock->wcount == 0))
+  if ((RWSTATE_RCOUNT (osapiRWLock) == 0) && (osapiRWLock->wcount == 0))
   {
     return WAITQ_REMOVE_OK;
   }
@@ -243,7 +287,7 @@ static int osapi_rwlock_w_waitq_remove_check (void *rwlock)
  * @returns   SUCCESS
  * @returns   FAILURE if timeout or if lock does not exist
  *
- * @comments None.
+ * @comments A waiting writer keeps new readers out.
  *
  * @end
  *
@@ -260,11 +304,14 @@ RC_t osapiWriteLockTake (osapiRWLock_t rwlock,  int32 timeout)
 
   if ((osapiRWLock->flags & RWLOCK_DELETED) == 0)
   {
-    /* indicate pending write */
+    /* indicate pending write, this stops new readers */
+    osapiRWLock->wpending++;
     osapiRWLock->flags |= RWLOCK_W_PENDING;
+    (void) __atomic_fetch_or (&osapiRWLock->state, RWSTATE_WRITER,
+                              __ATOMIC_SEQ_CST);
 
-    /* wait for reads to complete */
-    while ((osapiRWLock->rcount > 0) || (osapiRWLock->wcount > 0))
+    /* wait for reads and the current write to complete */
+    while ((RWSTATE_RCOUNT (osapiRWLock) > 0) || (osapiRWLock->wcount > 0))
     {
       rc = osapi_waitq_enqueue (&(osapiRWLock->wqueue), timeout,
                                 osapi_rwlock_w_waitq_remove_check,
@@ -272,16 +319,27 @@ RC_t osapiWriteLockTake (osapiRWLock_t rwlock,  int32 timeout)
 
       if ((rc !=  SUCCESS) || ((osapiRWLock->flags & RWLOCK_DELETED) != 0))
       {
-        osapiRWLock->flags &= ~(RWLOCK_W_PENDING);
         rc =  FAILURE;
         break;
       }
     }
 
+    osapiRWLock->wpending--;
+    if (osapiRWLock->wpending == 0)
+    {
+      osapiRWLock->flags &= ~(RWLOCK_W_PENDING);
+    }
+
     if (rc ==  SUCCESS)
     {
       osapiRWLock->wcount++;    /* result should always equal 1 */
-      osapiRWLock->flags &= ~(RWLOCK_W_PENDING);
+    }
+    else if ((osapiRWLock->wpending == 0) && (osapiRWLock->wcount == 0))
+    {
+      /* gave up, let the readers held off by this writer in */
+      (void) __atomic_fetch_and (&osapiRWLock->state, ~RWSTATE_WRITER,
+                                 __ATOMIC_SEQ_CST);
+      osapi_waitq_dequeue_all (&(osapiRWLock->rqueue));
     }
   }
   else
@@ -323,8 +381,13 @@ RC_t osapiWriteLockGive (osapiRWLock_t rwlock)
   {
     osapiRWLock->wcount--;      /* result should always equal 0 */
     osapi_waitq_dequeue (&(osapiRWLock->wqueue));
-    /* Wake up _all_ waiting readers */
-    osapi_waitq_dequeue_all (&(osapiRWLock->rqueue));
+    if (osapiRWLock->wpending == 0)
+    {
+      /* no other writer waiting, wake up _all_ waiting readers */
+      (void) __atomic_fetch_and (&osapiRWLock->state, ~RWSTATE_WRITER,
+                                 __ATOMIC_SEQ_CST);
+      osapi_waitq_dequeue_all (&(osapiRWLock->rqueue));
+    }
   }
   pthread_mutex_unlock (&(osapiRWLock->lock));
   return rc;
@@ -354,8 +417,10 @@ RC_t osapiRWLockDelete (osapiRWLock_t rwlock)
   /* mark rwlock as deleted and wait for current readers and writers */
 
   osapiRWLock->flags |= RWLOCK_DELETED;
+  (void) __atomic_fetch_or (&osapiRWLock->state, RWSTATE_DELETED,
+                            __ATOMIC_SEQ_CST);
 
-  while ((osapiRWLock->rcount > 0) || (osapiRWLock->wcount > 0))
+  while ((RWSTATE_RCOUNT (osapiRWLock) > 0) || (osapiRWLock->wcount > 0))
   {
     /* wait for reads and writes to complete */
     rc = osapi_waitq_enqueue (&(osapiRWLock->wqueue),  WAIT_FOREVER,
@@ -451,7 +516,7 @@ RC_t osapiDebugRWLockPrint (void)
   {
     sysapiPrintf ("%p ",  rwlock);
     sysapiPrintf ("%08x ", rwlock->flags);
-    sysapiPrintf ("%8d ", rwlock->rcount);
+    sysapiPrintf ("%8d ", RWSTATE_RCOUNT (rwlock));
     sysapiPrintf ("%8d ", rwlock->wcount);
     osapiAddressStringify (rwlock->rqueue.taken, addrstr, sizeof (addrstr));
     sysapiPrintf ("%s ", addrstr);
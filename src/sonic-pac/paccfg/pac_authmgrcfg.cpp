@@ -25,8 +25,9 @@ using namespace swss;
 
 // PAC SONIC config engine 
 PacCfg::PacCfg(DBConnector *db, DBConnector *cfgDb, DBConnector *stateDb) :
+    m_statePipeline(stateDb),
     m_cfgFdbTable(cfgDb, CFG_FDB_TABLE_NAME),
-    m_stateOperFdbTable(stateDb, STATE_OPER_FDB_TABLE_NAME),
+    m_stateOperFdbTable(&m_statePipeline, STATE_OPER_FDB_TABLE_NAME, true),
     m_stateOperPortTable(stateDb, STATE_OPER_PORT_TABLE_NAME)
 {
     Logger::linkToDbNative("paccfg");
@@ -98,6 +99,13 @@ void PacCfg::intfStaticMacCleanup(void)
    {
       m_stateOperFdbTable.del(key);
    }
+   m_stateOperFdbTable.flush();
+}
+
+// Write out static MAC updates buffered since the last flush.
+void PacCfg::flush(void)
+{
+   m_stateOperFdbTable.flush();
 }
 
 // Acquire/Release port. 
@@ -21,6 +21,7 @@
 #include <swss/dbconnector.h>
 #include <swss/schema.h>
 #include <swss/table.h>
+#include <swss/redispipeline.h>
 #include <swss/macaddress.h>
 #include <swss/notificationproducer.h>
 #include <swss/subscriberstatetable.h>
@@ -74,7 +75,13 @@ namespace swss {
             /* Send notification to FDB mgr. */
             bool sendFdbNotification(std::string op, std::string port);
 
+            /* Write out buffered static MAC updates. */
+            void flush(void);
+
         private:
+        /* Pipeline batching static MAC updates until flush() */
+        RedisPipeline m_statePipeline;
+
         /* Tables for writing config */
         Table m_cfgFdbTable;
         Table m_stateOperFdbTable;
@@ -190,6 +190,11 @@ extern "C" {
        return cfg.intfStaticMacCleanup();
     }
 
+    void pacCfgFlush(void)
+    {
+       cfg.flush();
+    }
+
     bool pacCfgIntfClientBlock(char *interface, unsigned char *macaddr, int vlan)
     {
         string port(interface);
@@ -49,6 +49,9 @@ bool pacCfgIntfClientUnBlock(char *interface, unsigned char *m_mac, int vlan);
 /* Send a notification to remove/add static MAC entries on a port. */
 RC_t pacCfgFdbSendCfgNotification(authMgrFdbCfgType_t type, char *interface);
 
+/* Write out buffered client updates. */
+void pacCfgFlush(void);
+
 /* USE C Declarations */
 #ifdef __cplusplus
 }
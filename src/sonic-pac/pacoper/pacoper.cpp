@@ -32,9 +32,11 @@ std::vector<std::string> vlanType {"Unassigned", "RADIUS",
                                    "Default", "Blocked"};
 
 FpDbAdapter::FpDbAdapter( DBConnector *stateDb, DBConnector *configDb, DBConnector *appDb) :
-                                    m_PacGlobalOperTbl(stateDb, STATE_PAC_GLOBAL_OPER_TABLE),
+                                    m_statePipeline(stateDb),
+                                    m_PacGlobalOperTbl(&m_statePipeline, STATE_PAC_GLOBAL_OPER_TABLE, true),
                                     m_PacPortOperTbl(stateDb, STATE_PAC_PORT_OPER_TABLE),
-                                    m_PacAuthClientOperTbl(stateDb, STATE_PAC_AUTHENTICATED_CLIENT_OPER_TABLE)
+                                    m_PacAuthClientOperTbl(&m_statePipeline, STATE_PAC_AUTHENTICATED_CLIENT_OPER_TABLE, true),
+                                    m_PacAuthLatencyOperTbl(&m_statePipeline, STATE_PAC_AUTH_LATENCY_OPER_TABLE, true)
 {
 }
 
@@ -165,20 +167,54 @@ void PacAuthClientOperTblCleanup(void)
    {
       Fp->m_PacAuthClientOperTbl.del(key);
    }
+   Fp->m_PacAuthClientOperTbl.flush();
 }
 
+static pac_global_oper_table_t lastGlobalInfo;
+static bool lastGlobalInfoValid = false;
+
 void PacGlobalOperTblSet(pac_global_oper_table_t *info)
 {
   vector<FieldValueTuple> fvs;
   
   SWSS_LOG_NOTICE("----- PacOperTbl API called from AuthMgr -----");
 
+  /* Every client status change rewrites the global counters;
+   * skip the write when nothing changed since the last one. */
+  if (lastGlobalInfoValid &&
+      (0 == memcmp(&lastGlobalInfo, info, sizeof(lastGlobalInfo))))
+  {
+    return;
+  }
+  lastGlobalInfo = *info;
+  lastGlobalInfoValid = true;
+
   fvs.emplace_back("num_clients_authenticated", to_string(info->authCount));
   fvs.emplace_back("num_clients_authenticated_monitor", to_string(info->authCountMonMode));
 
   Fp->m_PacGlobalOperTbl.set("GLOBAL", fvs);
 }
 
+void PacAuthLatencyOperTblSet(const char8 *segment,
+                              pac_auth_latency_oper_table_t *info)
+{
+  vector<FieldValueTuple> fvs;
+  uint32 idx;
+
+  fvs.emplace_back("count", to_string(info->count));
+  fvs.emplace_back("avg_ms", to_string(info->avgMs));
+  fvs.emplace_back("max_ms", to_string(info->maxMs));
+
+  /* bucket_<N>ms counts samples below N ms, the last one is open ended */
+  for (idx = 0; idx < PAC_AUTH_LATENCY_BUCKETS - 1; idx++)
+  {
+    fvs.emplace_back("bucket_" + to_string(1u << idx) + "ms", to_string(info->bucket[idx]));
+  }
+  fvs.emplace_back("bucket_inf", to_string(info->bucket[idx]));
+
+  Fp->m_PacAuthLatencyOperTbl.set(segment, fvs);
+}
+
 void PacGlobalOperTblCleanup(void)
 {
    vector<string> keys;
@@ -187,6 +223,8 @@ void PacGlobalOperTblCleanup(void)
    {
       Fp->m_PacGlobalOperTbl.del(key);
    }
+   Fp->m_PacGlobalOperTbl.flush();
+   lastGlobalInfoValid = false;
 }
 
 void PacPortOperTblSet(uint32 intIfNum,  AUTHMGR_METHOD_t *enabledMethods, 
@@ -265,10 +303,27 @@ void PacPortOperTblCleanup(void)
 }
 
 
+void PacAuthLatencyOperTblCleanup(void)
+{
+   vector<string> keys;
+   Fp->m_PacAuthLatencyOperTbl.getKeys(keys);
+   for (const auto key : keys)
+   {
+      Fp->m_PacAuthLatencyOperTbl.del(key);
+   }
+   Fp->m_PacAuthLatencyOperTbl.flush();
+}
+
 void PacOperTblCleanup(void)
 {
    PacAuthClientOperTblCleanup();
    PacGlobalOperTblCleanup();
+   PacAuthLatencyOperTblCleanup();
+}
+
+void PacOperTblFlush(void)
+{
+   Fp->m_statePipeline.flush();
 }
 
 
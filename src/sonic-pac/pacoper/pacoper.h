@@ -20,6 +20,7 @@
 #include <swss/dbconnector.h>
 #include <swss/schema.h>
 #include <swss/table.h>
+#include <swss/redispipeline.h>
 #include <swss/macaddress.h>
 #include <swss/producerstatetable.h>
 #include <swss/table.h>
@@ -33,12 +34,19 @@ using namespace std;
 
 #define AUTHMGR_MAX_HISTENT_PER_INTERFACE   48
 
+#ifndef STATE_PAC_AUTH_LATENCY_OPER_TABLE
+#define STATE_PAC_AUTH_LATENCY_OPER_TABLE "PAC_AUTH_LATENCY_OPER_TABLE"
+#endif
+
 class FpDbAdapter {
 public:
     FpDbAdapter(DBConnector *stateDb, DBConnector *configDb, DBConnector *appDb);
+    /* Buffers client and global oper updates until PacOperTblFlush() */
+    RedisPipeline m_statePipeline;
     Table m_PacGlobalOperTbl;
     Table m_PacPortOperTbl;
     Table m_PacAuthClientOperTbl;
+    Table m_PacAuthLatencyOperTbl;
 
 private:
 };
@@ -48,6 +48,17 @@ typedef struct pac_authenticated_clients_oper_table_s
 }pac_authenticated_clients_oper_table_t;
 
 
+/* log2 ms buckets, see authmgrLatencyHist_t */
+#define PAC_AUTH_LATENCY_BUCKETS   16
+
+typedef struct pac_auth_latency_oper_table_s
+{
+  uint32         count;
+  uint32         avgMs;
+  uint32         maxMs;
+  uint32         bucket[PAC_AUTH_LATENCY_BUCKETS];
+}pac_auth_latency_oper_table_t;
+
 void PacAuthClientOperTblSet(uint32 intIfNum,  enetMacAddr_t macAddr, 
                             pac_authenticated_clients_oper_table_t *client_info);
 void PacAuthClientOperTblDel(uint32 intIfNum,  enetMacAddr_t macAddr);
@@ -57,8 +68,13 @@ void PacGlobalOperTblSet(pac_global_oper_table_t *info);
 void PacPortOperTblSet(uint32 intIfNum,  AUTHMGR_METHOD_t *enabledMethods, 
                         AUTHMGR_METHOD_t *enabledPriority);
 
+void PacAuthLatencyOperTblSet(const char8 *segment,
+                              pac_auth_latency_oper_table_t *info);
+
 void PacOperTblCleanup(void);
 
+void PacOperTblFlush(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* MAB side of the authmgr scale test. Started by pac_scale_test, it
+ * runs MAB on the same ports as the driver and answers its RADIUS
+ * requests from a loopback server, until it is terminated. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "datatypes.h"
+#include "osapi.h"
+#include "mab_include.h"
+#include "mab_api.h"
+#include "pac_scale_nim.h"
+#include "pac_scale_radius.h"
+
+static void pacScaleMabUsage(const char *prog)
+{
+  fprintf(stderr, "Usage: %s -p ports [-r radius_port] [-f ready_fd]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+  uint32 intIfNum[PAC_SCALE_PORTS_MAX];
+  uint32 numPorts = 0, i;
+  unsigned short radiusPort = 0;
+  char portStr[8];
+  int readyFd = -1;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "p:r:f:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'p':
+        numPorts = strtoul(optarg, NULL, 0);
+        break;
+      case 'r':
+        radiusPort = strtoul(optarg, NULL, 0);
+        break;
+      case 'f':
+        readyFd = atoi(optarg);
+        break;
+      default:
+        pacScaleMabUsage(argv[0]);
+        return 2;
+    }
+  }
+
+  if ((0 == numPorts) || (numPorts > PAC_SCALE_PORTS_MAX))
+  {
+    pacScaleMabUsage(argv[0]);
+    return 2;
+  }
+
+  if (pacScaleNimInit() !=  SUCCESS)
+  {
+    fprintf(stderr, "NIM initialization failed\n");
+    return 1;
+  }
+
+  if ((mabInit() !=  SUCCESS) ||
+      (osapiWaitForTaskInit( MAB_DB_TASK_SYNC,  WAIT_FOREVER) !=  SUCCESS))
+  {
+    fprintf(stderr, "MAB initialization failed\n");
+    return 1;
+  }
+
+  if (pacScaleNimPortsCreate(numPorts, intIfNum) !=  SUCCESS)
+  {
+    return 1;
+  }
+
+  /* without -r the server takes any free port, MAB is pointed at it */
+  if (pacScaleRadiusStart(&radiusPort, PAC_SCALE_RADIUS_SECRET) != 0)
+  {
+    fprintf(stderr, "Unable to start the RADIUS server on port %u\n", radiusPort);
+    return 1;
+  }
+
+  snprintf(portStr, sizeof(portStr), "%u", radiusPort);
+  if ((mabRadiusServerUpdate(RADIUS_MAB_SERVER_ADD, "auth", "127.0.0.1", "1",
+                             PAC_SCALE_RADIUS_SECRET, portStr) !=  SUCCESS) ||
+      (mabRadiusServerUpdate(RADIUS_MAB_SERVERS_RELOAD, "auth",
+                             NULL, NULL, NULL, NULL) !=  SUCCESS))
+  {
+    fprintf(stderr, "Unable to configure the RADIUS server\n");
+    return 1;
+  }
+
+  for (i = 0; i < numPorts; i++)
+  {
+    if ((mabPortMABEnableSet(intIfNum[i],  ENABLE) !=  SUCCESS) ||
+        (mabPortMABAuthTypeSet(intIfNum[i],  AUTHMGR_PORT_MAB_AUTH_TYPE_PAP) !=  SUCCESS))
+    {
+      fprintf(stderr, "Unable to enable MAB on Ethernet%u\n", i);
+      return 1;
+    }
+  }
+
+  if (readyFd >= 0)
+  {
+    if (write(readyFd, "1", 1) != 1)
+    {
+      return 1;
+    }
+    close(readyFd);
+  }
+
+  for (;;)
+  {
+    pause();
+  }
+  return 0;
+}
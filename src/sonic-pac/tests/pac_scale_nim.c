@@ -0,0 +1,128 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "datatypes.h"
+#include "commdefs.h"
+#include "pacinfra_common.h"
+#include "log.h"
+#include "osapi.h"
+#include "resources.h"
+#include "nim_cnfgr.h"
+#include "sysapi.h"
+#include "sysapi_hpc.h"
+#include "nim_events.h"
+#include "nimapi.h"
+#include "osapi_priv.h"
+#include "nim_startup.h"
+#include "pac_scale_nim.h"
+
+#define PAC_SCALE_NIM_UNIT  1
+#define PAC_SCALE_NIM_SLOT  0
+
+RC_t pacScaleNimInit(void)
+{
+  (void)sysapiSystemInit();
+
+  if ((nimPhaseOneInit() !=  SUCCESS) ||
+      (nimPhaseTwoInit() !=  SUCCESS) ||
+      (nimPhaseThreeInit() !=  SUCCESS) ||
+      (nimPhaseExecInit() !=  SUCCESS))
+  {
+    return  FAILURE;
+  }
+  return  SUCCESS;
+}
+
+RC_t pacScaleNimPortsCreate(uint32 numPorts, uint32 *intIfNum)
+{
+  SYSAPI_HPC_PORT_DESCRIPTOR_t portData =
+  {
+     IANA_GIGABIT_ETHERNET,
+     PORTCTRL_PORTSPEED_FULL_10GSX,
+     PHY_CAP_PORTSPEED_ALL,
+     PORT_FEC_DISABLE,
+     CAP_FEC_NONE
+  };
+   enetMacAddr_t macAddr;
+  NIM_EVENT_NOTIFY_INFO_t eventInfo;
+  NIM_HANDLE_t handle;
+  nimStartUpTreeData_t startupData;
+  nimUSP_t usp;
+  char alias[16];
+  uint32 i;
+
+  if (numPorts > PAC_SCALE_PORTS_MAX)
+  {
+    return  FAILURE;
+  }
+
+  memset(&macAddr, 0, sizeof(macAddr));
+  macAddr.addr[0] = 0x02;
+
+  usp.unit = PAC_SCALE_NIM_UNIT;
+  usp.slot = PAC_SCALE_NIM_SLOT;
+
+  for (i = 0; i < numPorts; i++)
+  {
+    /* FP ports start from 1, Ethernet0 is port 1 */
+    usp.port = i + 1;
+    macAddr.addr[5] = usp.port;
+    if (nimCmgrNewIntfChangeCallback(usp.unit, usp.slot, usp.port, 0,  CREATE,
+                                     &portData, &macAddr) !=  SUCCESS)
+    {
+      fprintf(stderr, "Failed to create port %u\n", usp.port);
+      return  FAILURE;
+    }
+
+    if (nimGetIntIfNumFromUSP(&usp, &intIfNum[i]) !=  SUCCESS)
+    {
+      fprintf(stderr, "Failed to get IntIfNum for port %u\n", usp.port);
+      return  FAILURE;
+    }
+    snprintf(alias, sizeof(alias), "Ethernet%u", i);
+    nimSetIntfifAlias(intIfNum[i], ( uchar8 *) alias);
+
+    memset(&eventInfo, 0, sizeof(eventInfo));
+    eventInfo.component =  CARDMGR_COMPONENT_ID;
+    eventInfo.pCbFunc = NULL;
+    eventInfo.event =  ATTACH;
+    eventInfo.intIfNum = intIfNum[i];
+    if (nimEventIntfNotify(eventInfo, &handle) !=  SUCCESS)
+    {
+      fprintf(stderr, "Failed to attach %s\n", alias);
+      return  FAILURE;
+    }
+  }
+
+  /* Wait till the component registers with NIM */
+  while (nimStartUpFirstGet(&startupData) !=  SUCCESS)
+  {
+    sleep(1);
+  }
+  nimStartupCallbackInvoke(NIM_INTERFACE_CREATE_STARTUP);
+  nimStartupCallbackInvoke(NIM_INTERFACE_ACTIVATE_STARTUP);
+
+  for (i = 0; i < numPorts; i++)
+  {
+    usp.port = i + 1;
+    nimSetIntfAdminState(intIfNum[i],  ENABLE);
+    nimDtlIntfChangeCallback(&usp,  UP, NULL);
+  }
+  return  SUCCESS;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PAC_SCALE_NIM_H
+#define PAC_SCALE_NIM_H
+
+#include "datatypes.h"
+
+/* Ports are created as Ethernet0..N-1, the aliases pacd and mabd use */
+#define PAC_SCALE_PORTS_MAX   64
+
+/*********************************************************************
+ * @purpose  Initialize sysapi and NIM without the redis and netlink
+ *           backed port sync of fpinfraInit()
+ *
+ * @returns  SUCCESS
+ * @returns  FAILURE
+ *
+ * @end
+ *********************************************************************/
+RC_t pacScaleNimInit(void);
+
+/*********************************************************************
+ * @purpose  Create, attach and bring up the test ports
+ *
+ * @param    numPorts  @b{(input)}  number of ports
+ * @param    intIfNum  @b{(output)} internal interface number of each port
+ *
+ * @returns  SUCCESS
+ * @returns  FAILURE
+ *
+ * @comments Call after the component registered with NIM, the
+ *           startup callbacks are invoked before the ports go up.
+ *           Both test processes create the ports in the same order
+ *           and so agree on the interface numbers.
+ *
+ * @end
+ *********************************************************************/
+RC_t pacScaleNimPortsCreate(uint32 numPorts, uint32 *intIfNum);
+
+#endif /* PAC_SCALE_NIM_H */
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Kept apart from the fpinfra headers, hostap's common.h defines its
+ * own basic types. */
+
+#include "includes.h"
+#include <pthread.h>
+
+#include "common.h"
+#include "wpabuf.h"
+#include "radius.h"
+#include "pac_scale_radius.h"
+
+static int pacScaleRadiusSock = -1;
+static const char *pacScaleRadiusSecret;
+
+static void *pacScaleRadiusTask(void *arg)
+{
+  u8 buf[4096];
+  struct sockaddr_in from;
+  socklen_t fromlen;
+  struct radius_msg *req, *resp;
+  struct radius_hdr *hdr;
+  struct wpabuf *out;
+  ssize_t len;
+
+  for (;;)
+  {
+    fromlen = sizeof(from);
+    len = recvfrom(pacScaleRadiusSock, buf, sizeof(buf), 0,
+                   (struct sockaddr *)&from, &fromlen);
+    if (len < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      perror("recvfrom");
+      break;
+    }
+
+    req = radius_msg_parse(buf, len);
+    if (req == NULL)
+    {
+      continue;
+    }
+
+    hdr = radius_msg_get_hdr(req);
+    if (hdr->code != RADIUS_CODE_ACCESS_REQUEST)
+    {
+      radius_msg_free(req);
+      continue;
+    }
+
+    resp = radius_msg_new(RADIUS_CODE_ACCESS_ACCEPT, hdr->identifier);
+    if ((resp != NULL) &&
+        (radius_msg_finish_srv(resp, (const u8 *)pacScaleRadiusSecret,
+                               strlen(pacScaleRadiusSecret),
+                               hdr->authenticator) == 0))
+    {
+      out = radius_msg_get_buf(resp);
+      if (sendto(pacScaleRadiusSock, wpabuf_head(out), wpabuf_len(out), 0,
+                 (struct sockaddr *)&from, fromlen) < 0)
+      {
+        perror("sendto");
+      }
+    }
+    radius_msg_free(resp);
+    radius_msg_free(req);
+  }
+  return NULL;
+}
+
+int pacScaleRadiusStart(unsigned short *port, const char *secret)
+{
+  struct sockaddr_in addr;
+  socklen_t addrLen = sizeof(addr);
+  pthread_t tid;
+
+  pacScaleRadiusSock = socket(AF_INET, SOCK_DGRAM, 0);
+  if (pacScaleRadiusSock < 0)
+  {
+    perror("socket");
+    return -1;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(*port);
+  if ((bind(pacScaleRadiusSock, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+      (getsockname(pacScaleRadiusSock, (struct sockaddr *)&addr, &addrLen) != 0))
+  {
+    perror("bind");
+    close(pacScaleRadiusSock);
+    pacScaleRadiusSock = -1;
+    return -1;
+  }
+
+  *port = ntohs(addr.sin_port);
+  pacScaleRadiusSecret = secret;
+  if (pthread_create(&tid, NULL, pacScaleRadiusTask, NULL) != 0)
+  {
+    close(pacScaleRadiusSock);
+    pacScaleRadiusSock = -1;
+    return -1;
+  }
+  pthread_detach(tid);
+  return 0;
+}
+
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PAC_SCALE_RADIUS_H
+#define PAC_SCALE_RADIUS_H
+
+/* Shared secret of the loopback RADIUS server */
+#define PAC_SCALE_RADIUS_SECRET  "pacscale"
+
+/*********************************************************************
+ * @purpose  Start a RADIUS server on 127.0.0.1 that accepts every
+ *           Access-Request
+ *
+ * @param    port    @b{(inout)} UDP port, 0 for any free port; set
+ *                   to the port bound
+ * @param    secret  @b{(input)} shared secret
+ *
+ * @returns  0 on success, -1 otherwise
+ *
+ * @comments The responses carry no attributes, so clients are
+ *           authorized on the port PVID.
+ *
+ * @end
+ *********************************************************************/
+int pacScaleRadiusStart(unsigned short *port, const char *secret);
+
+#endif /* PAC_SCALE_RADIUS_H */
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Stand-ins for libpaccfg and libpacoper. Those connect to redis when
+ * they are loaded, the scale test only counts what authmgr would write. */
+
+#include "auth_mgr_include.h"
+#include "auth_mgr_vlan_db.h"
+#include "pacoper_common.h"
+#include "pac_scale_stubs.h"
+
+pacScaleStubCounters_t pacScaleStubCounters;
+
+static int pacScaleStubPvid = 1;
+
+void pacScaleStubPvidSet(int pvid)
+{
+  pacScaleStubPvid = pvid;
+}
+
+RC_t pacCfgIntfLearningModeSet(char *interface,  AUTHMGR_PORT_LEARNING_t learning)
+{
+  return  SUCCESS;
+}
+
+ BOOL pacCfgIntfViolationPolicySet(char *interface,  BOOL enable)
+{
+  return  TRUE;
+}
+
+ BOOL pacCfgIntfClientAdd(char *interface,  uchar8 *mac_addr, int vlan)
+{
+  __sync_fetch_and_add(&pacScaleStubCounters.clientAdd, 1);
+  return  TRUE;
+}
+
+ BOOL pacCfgIntfClientRemove(char *interface,  uchar8 *mac_addr, int vlan)
+{
+  __sync_fetch_and_add(&pacScaleStubCounters.clientRemove, 1);
+  return  TRUE;
+}
+
+ BOOL pacCfgIntfClientBlock(char *interface,  uchar8 *mac_addr, int vlan)
+{
+  __sync_fetch_and_add(&pacScaleStubCounters.clientBlock, 1);
+  return  TRUE;
+}
+
+ BOOL pacCfgIntfClientUnblock(char *interface,  uchar8 *mac_addr, int vlan)
+{
+  __sync_fetch_and_add(&pacScaleStubCounters.clientUnblock, 1);
+  return  TRUE;
+}
+
+void pacCfgFlush(void)
+{
+  __sync_fetch_and_add(&pacScaleStubCounters.flush, 1);
+}
+
+RC_t pacCfgIntfAcquireSet(char *interface,  BOOL acquire)
+{
+  return  SUCCESS;
+}
+
+RC_t pacCfgPortPVIDSet(char *interface, int pvid)
+{
+  return  SUCCESS;
+}
+
+RC_t pacCfgPortPVIDGet(char *interface, int *pvid)
+{
+  *pvid = pacScaleStubPvid;
+  return  SUCCESS;
+}
+
+RC_t pacCfgVlanMemberAdd(int vlan, char *interface, dot1qTaggingMode_t mode)
+{
+  return  SUCCESS;
+}
+
+RC_t pacCfgVlanMemberRemove(int vlan, char *interface)
+{
+  return  SUCCESS;
+}
+
+RC_t pacCfgVlanAdd(int vlan)
+{
+  return  SUCCESS;
+}
+
+RC_t pacCfgVlanRemove(int vlan)
+{
+  return  SUCCESS;
+}
+
+RC_t pacCfgVlanSendPVIDNotification(char *interface, int pvid)
+{
+  return  SUCCESS;
+}
+
+RC_t pacCfgVlanSendCfgNotification(authMgrVlanPortCfgType_t type,
+                                   char *interface, authMgrVlanPortData_t *cfg)
+{
+  return  SUCCESS;
+}
+
+void PacAuthClientOperTblSet(uint32 intIfNum,  enetMacAddr_t macAddr,
+                             pac_authenticated_clients_oper_table_t *client_info)
+{
+  __sync_fetch_and_add(&pacScaleStubCounters.operSet, 1);
+}
+
+void PacAuthClientOperTblDel(uint32 intIfNum,  enetMacAddr_t macAddr)
+{
+  __sync_fetch_and_add(&pacScaleStubCounters.operDel, 1);
+}
+
+void PacGlobalOperTblSet(pac_global_oper_table_t *info)
+{
+}
+
+void PacPortOperTblSet(uint32 intIfNum,  AUTHMGR_METHOD_t *enabledMethods,
+                       AUTHMGR_METHOD_t *enabledPriority)
+{
+}
+
+void PacAuthLatencyOperTblSet(const char8 *segment,
+                              pac_auth_latency_oper_table_t *info)
+{
+}
+
+void PacOperTblCleanup(void)
+{
+}
+
+void PacOperTblFlush(void)
+{
+}
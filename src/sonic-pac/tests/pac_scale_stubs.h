@@ -0,0 +1,39 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PAC_SCALE_STUBS_H
+#define PAC_SCALE_STUBS_H
+
+#include "datatypes.h"
+
+/* Calls the stubbed CONFIG_DB/STATE_DB writers received */
+typedef struct pacScaleStubCounters_s
+{
+  uint32 clientAdd;
+  uint32 clientRemove;
+  uint32 clientBlock;
+  uint32 clientUnblock;
+  uint32 operSet;
+  uint32 operDel;
+  uint32 flush;
+} pacScaleStubCounters_t;
+
+extern pacScaleStubCounters_t pacScaleStubCounters;
+
+/* VLAN returned as the PVID of every port */
+void pacScaleStubPvidSet(int pvid);
+
+#endif /* PAC_SCALE_STUBS_H */
@@ -0,0 +1,453 @@
+/*
+ * Copyright 2024 Broadcom Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* authmgr scale test. Runs authmgr against stubbed CONFIG_DB/STATE_DB
+ * writers and a MAB peer process (pac_scale_mab) that answers from a
+ * loopback RADIUS server, injects MAC addresses the way pacmgr reports
+ * unlearnt sources and reports how fast they get authorized.
+ *
+ * Both processes use the fixed authmgr and MAB localhost ports, so the
+ * test cannot run next to pacd or mabd. */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/wait.h>
+#include "auth_mgr_include.h"
+#include "auth_mgr_struct.h"
+#include "auth_mgr_latency.h"
+#include "auth_mgr_debug.h"
+#include "pac_scale_nim.h"
+#include "pac_scale_stubs.h"
+
+extern authmgrCB_t *authmgrCB;
+
+#define PAC_SCALE_PORTS_DEF         8
+#define PAC_SCALE_VLAN_DEF          10
+#define PAC_SCALE_TIMEOUT_DEF       120
+#define PAC_SCALE_RADIUS_PORT_DEF   0   /* any free port */
+#define PAC_SCALE_MAB_PEER_DEF      "./pac_scale_mab"
+
+typedef struct pacScaleRun_s
+{
+  uint32 numPorts;
+  uint32 intIfNum[PAC_SCALE_PORTS_MAX];
+  uint32 startTime;
+  uint32 injected;
+  uint32 dropped;
+} pacScaleRun_t;
+
+static pacScaleRun_t pacScaleRun;
+
+/*********************************************************************
+* @purpose  Sum the authorized client count of the test ports
+*
+* @param    none
+*
+* @returns  authorized clients
+*
+* @comments none
+*
+* @end
+*********************************************************************/
+static uint32 pacScaleAuthCountGet (void)
+{
+  uint32 i, count = 0;
+
+  for (i = 0; i < pacScaleRun.numPorts; i++)
+  {
+    count += authmgrCB->globalInfo->authmgrPortInfo[pacScaleRun.intIfNum[i]].authCount;
+  }
+  return count;
+}
+
+/*********************************************************************
+* @purpose  Upper bound of the bucket holding a latency percentile
+*
+* @param    hist     @b{(input)} latency histogram
+* @param    percent  @b{(input)} percentile (1-100)
+*
+* @returns  bucket upper bound in ms, 0 if there are no samples
+*
+* @comments none
+*
+* @end
+*********************************************************************/
+static uint32 pacScaleLatencyPercentileGet (authmgrLatencyHist_t *hist,
+                                            uint32 percent)
+{
+  uint32 idx, sum = 0, target;
+
+  if (0 == hist->count)
+  {
+    return 0;
+  }
+
+  target = ((hist->count * percent) + 99) / 100;
+  for (idx = 0; idx < AUTHMGR_LATENCY_BUCKETS - 1; idx++)
+  {
+    sum += hist->bucket[idx];
+    if (sum >= target)
+    {
+      return (1 << idx);
+    }
+  }
+  return hist->maxMs;
+}
+
+/*********************************************************************
+* @purpose  Start the MAB peer and wait until it serves the ports
+*
+* @param    peer        @b{(input)} path of pac_scale_mab
+* @param    numPorts    @b{(input)} number of ports
+* @param    radiusPort  @b{(input)} loopback RADIUS server port, 0 lets
+*                                   the peer pick a free one
+* @param    timeout     @b{(input)} seconds to wait for the peer
+*
+* @returns  peer pid, -1 on failure
+*
+* @comments none
+*
+* @end
+*********************************************************************/
+static pid_t pacScaleMabPeerStart (const char *peer, uint32 numPorts,
+                                   uint32 radiusPort, uint32 timeout)
+{
+  char portsArg[16], radiusArg[16], fdArg[16];
+  struct timeval tv;
+  fd_set readFds;
+  int fds[2];
+  char ready;
+  pid_t pid;
+
+  if (pipe(fds) != 0)
+  {
+    perror("pipe");
+    return -1;
+  }
+
+  pid = fork();
+  if (pid < 0)
+  {
+    perror("fork");
+    close(fds[0]);
+    close(fds[1]);
+    return -1;
+  }
+
+  if (0 == pid)
+  {
+    close(fds[0]);
+    snprintf(portsArg, sizeof(portsArg), "%u", numPorts);
+    snprintf(radiusArg, sizeof(radiusArg), "%u", radiusPort);
+    snprintf(fdArg, sizeof(fdArg), "%d", fds[1]);
+    execl(peer, peer, "-p", portsArg, "-r", radiusArg, "-f", fdArg, (char *)NULL);
+    perror(peer);
+    _exit(127);
+  }
+
+  close(fds[1]);
+  FD_ZERO(&readFds);
+  FD_SET(fds[0], &readFds);
+  tv.tv_sec = timeout;
+  tv.tv_usec = 0;
+  if ((select(fds[0] + 1, &readFds, NULL, NULL, &tv) <= 0) ||
+      (read(fds[0], &ready, 1) != 1))
+  {
+    fprintf(stderr, "MAB peer %s did not come up\n", peer);
+    close(fds[0]);
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+    return -1;
+  }
+  close(fds[0]);
+  return pid;
+}
+
+/*********************************************************************
+* @purpose  Enable MAB only, multi auth on the test ports and make
+*           them members of the test VLAN
+*
+* @param    vlanId  @b{(input)} VLAN the addresses are seen on
+*
+* @returns   SUCCESS
+* @returns   FAILURE
+*
+* @comments none
+*
+* @end
+*********************************************************************/
+static RC_t pacScalePortsConfigure (uint32 vlanId)
+{
+  dot1qNotifyData_t vlanData;
+  uint32 i, intIfNum;
+
+  memset(&vlanData, 0, sizeof(vlanData));
+  vlanData.data.vlanId = vlanId;
+  if ( SUCCESS != authmgrVlanChangeCallback(&vlanData, 0, VLAN_ADD_NOTIFY))
+  {
+    fprintf(stderr, "Unable to add VLAN %u\n", vlanId);
+    return  FAILURE;
+  }
+
+  for (i = 0; i < pacScaleRun.numPorts; i++)
+  {
+    intIfNum = pacScaleRun.intIfNum[i];
+    if (( SUCCESS != authmgrVlanChangeCallback(&vlanData, intIfNum, VLAN_ADD_PORT_NOTIFY)) ||
+        ( SUCCESS != authmgrPortAuthMethodSet( AUTHMGR_TYPE_ORDER, intIfNum,
+                                               AUTHMGR_METHOD_START,  AUTHMGR_METHOD_MAB)) ||
+        ( SUCCESS != authmgrPortAuthMethodSet( AUTHMGR_TYPE_PRIORITY, intIfNum,
+                                               AUTHMGR_METHOD_START,  AUTHMGR_METHOD_MAB)) ||
+        ( SUCCESS != authmgrPortMaxUsersSet(intIfNum,  AUTHMGR_PORT_MAX_MAC_USERS)) ||
+        ( SUCCESS != authmgrHostControlModeSet(intIfNum,  AUTHMGR_MULTI_AUTH_MODE)) ||
+        ( SUCCESS != authmgrPortControlModeSet(intIfNum,  AUTHMGR_PORT_AUTO)))
+    {
+      fprintf(stderr, "Unable to configure Ethernet%u\n", i);
+      return  FAILURE;
+    }
+  }
+  return  SUCCESS;
+}
+
+/*********************************************************************
+* @purpose  Inject synthetic unlearnt MAC addresses
+*
+* @param    numMacs  @b{(input)} number of MAC addresses to inject
+* @param    vlanId   @b{(input)} VLAN the addresses are seen on
+*
+* @returns  void
+*
+* @comments Addresses are locally administered (02:5a:xx:xx:xx:xx)
+*           and spread round robin across the ports.
+*
+* @end
+*********************************************************************/
+static void pacScaleInject (uint32 numMacs, uint32 vlanId)
+{
+   enetMacAddr_t macAddr;
+  uint32 i, intIfNum;
+
+  memset (&macAddr, 0, sizeof (macAddr));
+  macAddr.addr[0] = 0x02;
+  macAddr.addr[1] = 0x5a;
+
+  pacScaleRun.startTime = osapiUpTimeMillisecondsGet ();
+
+  for (i = 0; i < numMacs; i++)
+  {
+    intIfNum = pacScaleRun.intIfNum[i % pacScaleRun.numPorts];
+    macAddr.addr[2] = (i >> 24) & 0xff;
+    macAddr.addr[3] = (i >> 16) & 0xff;
+    macAddr.addr[4] = (i >> 8) & 0xff;
+    macAddr.addr[5] = i & 0xff;
+
+    if ( SUCCESS != authmgrUnauthAddrCallBack (intIfNum, macAddr, vlanId))
+    {
+      /* bulk queue full, give the authmgr task a chance and retry once */
+      osapiSleepMSec (1);
+      if ( SUCCESS != authmgrUnauthAddrCallBack (intIfNum, macAddr, vlanId))
+      {
+        pacScaleRun.dropped++;
+        continue;
+      }
+    }
+    pacScaleRun.injected++;
+  }
+
+  printf ("Injected %u MACs on %u ports in %u ms, %u dropped\n",
+          pacScaleRun.injected, pacScaleRun.numPorts,
+          osapiUpTimeMillisecondsGet () - pacScaleRun.startTime,
+          pacScaleRun.dropped);
+}
+
+/*********************************************************************
+* @purpose  Print the scale run results
+*
+* @param    authorized  @b{(input)} authorized clients
+* @param    elapsed     @b{(input)} ms from the first injection
+*
+* @returns  void
+*
+* @comments Percentiles are bucket upper bounds of the time-to-authorize
+*           histogram.
+*
+* @end
+*********************************************************************/
+static void pacScaleReport (uint32 authorized, uint32 elapsed)
+{
+  authmgrLatencyHist_t hist;
+  authmgrLogicalPortInfo_t *node;
+  uint32 lIntIfNum = 0;
+  uint32 clients = 0, timers = 0, noRespTimers = 0;
+
+  (void) osapiReadLockTake (authmgrCB->authmgrRWLock,  WAIT_FOREVER);
+  while ( NULLPTR != (node = authmgrLogicalPortInfoGetNext (lIntIfNum)))
+  {
+    lIntIfNum = node->key.keyNum;
+    clients++;
+    if ( NULLPTR != node->authmgrTimer.handle.timer)
+    {
+      timers++;
+    }
+    if ( NULLPTR != node->authmgrMethodNoRespTimer.handle.timer)
+    {
+      noRespTimers++;
+    }
+  }
+  (void) osapiReadLockGive (authmgrCB->authmgrRWLock);
+
+  (void) authmgrLatencyHistGet (AUTHMGR_LATENCY_TOTAL, &hist);
+
+  printf ("AUTHMGR scale run:\n");
+  printf ("------------------\n");
+  printf ("injected MACs           = %u (%u dropped)\n",
+          pacScaleRun.injected, pacScaleRun.dropped);
+  printf ("authorized clients      = %u\n", authorized);
+  printf ("elapsed ms              = %u\n", elapsed);
+  printf ("authorizations/s        = %u\n",
+          (0 != elapsed) ? (uint32)(((uint64)authorized * 1000) / elapsed) : 0);
+  printf ("time to authorize ms    = p50 < %u, p90 < %u, p99 < %u, max %u\n",
+          pacScaleLatencyPercentileGet (&hist, 50),
+          pacScaleLatencyPercentileGet (&hist, 90),
+          pacScaleLatencyPercentileGet (&hist, 99),
+          hist.maxMs);
+  printf ("logical ports in use    = %u\n", clients);
+  printf ("client timers running   = %u\n", timers);
+  printf ("no response timers      = %u\n", noRespTimers);
+  printf ("logical port memory     = %zu bytes\n",
+          clients * sizeof (authmgrLogicalPortInfo_t));
+  printf ("FDB client adds         = %u\n", pacScaleStubCounters.clientAdd);
+  printf ("oper table writes       = %u\n", pacScaleStubCounters.operSet);
+  printf ("batched flushes         = %u\n", pacScaleStubCounters.flush);
+  authmgrDebugMsgQueue ();
+}
+
+static void pacScaleUsage (const char *prog)
+{
+  fprintf (stderr, "Usage: %s [-p ports] [-n macs] [-v vlan] [-t timeout_s]"
+           " [-r radius_port] [-m mab_peer]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+  uint32 numMacs = 0, vlanId = PAC_SCALE_VLAN_DEF;
+  uint32 timeout = PAC_SCALE_TIMEOUT_DEF;
+  uint32 radiusPort = PAC_SCALE_RADIUS_PORT_DEF;
+  const char *peer = PAC_SCALE_MAB_PEER_DEF;
+  uint32 authorized = 0, elapsed = 0;
+  pid_t peerPid;
+  int opt, rc = 1;
+
+  pacScaleRun.numPorts = PAC_SCALE_PORTS_DEF;
+
+  while ((opt = getopt(argc, argv, "p:n:v:t:r:m:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'p':
+        pacScaleRun.numPorts = strtoul(optarg, NULL, 0);
+        break;
+      case 'n':
+        numMacs = strtoul(optarg, NULL, 0);
+        break;
+      case 'v':
+        vlanId = strtoul(optarg, NULL, 0);
+        break;
+      case 't':
+        timeout = strtoul(optarg, NULL, 0);
+        break;
+      case 'r':
+        radiusPort = strtoul(optarg, NULL, 0);
+        break;
+      case 'm':
+        peer = optarg;
+        break;
+      default:
+        pacScaleUsage(argv[0]);
+        return 2;
+    }
+  }
+
+  /* fill every port up to the per port client limit by default */
+  if (0 == numMacs)
+  {
+    numMacs = pacScaleRun.numPorts * AUTHMGR_PORT_MAX_MAC_USERS;
+  }
+
+  if ((0 == pacScaleRun.numPorts) || (pacScaleRun.numPorts > PAC_SCALE_PORTS_MAX) ||
+      (numMacs > pacScaleRun.numPorts * AUTHMGR_PORT_MAX_MAC_USERS))
+  {
+    fprintf(stderr, "1 to %u ports and at most %u MACs per port\n",
+            PAC_SCALE_PORTS_MAX, AUTHMGR_PORT_MAX_MAC_USERS);
+    return 2;
+  }
+
+  if (pacScaleNimInit() !=  SUCCESS)
+  {
+    fprintf(stderr, "NIM initialization failed\n");
+    return 1;
+  }
+
+  if ((authmgrInit () !=  SUCCESS) ||
+      (osapiWaitForTaskInit ( AUTHMGR_DB_TASK_SYNC,  WAIT_FOREVER) !=  SUCCESS))
+  {
+    fprintf(stderr, "authmgr initialization failed\n");
+    return 1;
+  }
+
+  if (pacScaleNimPortsCreate(pacScaleRun.numPorts, pacScaleRun.intIfNum) !=  SUCCESS)
+  {
+    return 1;
+  }
+  pacScaleStubPvidSet(vlanId);
+
+  peerPid = pacScaleMabPeerStart(peer, pacScaleRun.numPorts, radiusPort, timeout);
+  if (peerPid < 0)
+  {
+    return 1;
+  }
+
+  if (pacScalePortsConfigure(vlanId) ==  SUCCESS)
+  {
+    pacScaleInject(numMacs, vlanId);
+
+    do
+    {
+      osapiSleepMSec(100);
+      authorized = pacScaleAuthCountGet();
+      elapsed = osapiUpTimeMillisecondsGet() - pacScaleRun.startTime;
+    } while ((authorized < pacScaleRun.injected) && (elapsed < timeout * 1000));
+
+    pacScaleReport(authorized, elapsed);
+
+    if ((0 == pacScaleRun.dropped) && (authorized == numMacs))
+    {
+      rc = 0;
+    }
+    else
+    {
+      fprintf(stderr, "FAIL: %u of %u MACs authorized\n", authorized, numMacs);
+    }
+  }
+
+  kill(peerPid, SIGTERM);
+  waitpid(peerPid, NULL, 0);
+  return rc;
+}
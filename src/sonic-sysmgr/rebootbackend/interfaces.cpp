@@ -24,17 +24,28 @@ DBus::Connection& HostServiceDbus::getConnection(void) {
   return *connPtr;
 }
 
+DbusReboot& HostServiceDbus::getRebootClient(void) {
+  if (m_reboot_client == nullptr) {
+    m_reboot_client = std::make_unique<DbusReboot>(
+        getConnection(), kRebootBusName, kRebootPath);
+  }
+  return *m_reboot_client;
+}
+
+void HostServiceDbus::resetRebootClient(void) { m_reboot_client.reset(); }
+
 DbusInterface::DbusResponse HostServiceDbus::Reboot(
     const std::string& jsonRebootRequest) {
   int32_t status;
 
-  DbusReboot reboot_client(getConnection(), kRebootBusName, kRebootPath);
+  const std::lock_guard<std::mutex> lock(m_reboot_client_mutex);
   std::string retString;
   std::vector<std::string> options;
   options.push_back(jsonRebootRequest);
   try {
-    reboot_client.issue_reboot(options, status, retString);
+    getRebootClient().issue_reboot(options, status, retString);
   } catch (DBus::Error& ex) {
+    resetRebootClient();
     return DbusResponse{
         DbusStatus::DBUS_FAIL,
         "HostServiceDbus::Reboot: failed to call reboot host service"};
@@ -50,13 +61,14 @@ DbusInterface::DbusResponse HostServiceDbus::Reboot(
 
 DbusInterface::DbusResponse HostServiceDbus::RebootStatus(
     const std::string& jsonStatusRequest) {
-  DbusReboot reboot_client(getConnection(), kRebootBusName, kRebootPath);
   int32_t status;
   std::string retString;
 
+  const std::lock_guard<std::mutex> lock(m_reboot_client_mutex);
   try {
-    reboot_client.get_reboot_status(status, retString);
+    getRebootClient().get_reboot_status(status, retString);
   } catch (DBus::Error& ex) {
+    resetRebootClient();
     return DbusResponse{
         DbusStatus::DBUS_FAIL,
         "HostServiceDbus::RebootStatus: failed to call reboot status "
@@ -1,6 +1,8 @@
 #pragma once
 #include <dbus-c++/dbus.h>
 
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include "reboot_dbus.h"  // auto generated reboot_proxy
@@ -24,4 +26,13 @@ class HostServiceDbus : public DbusInterface {
 
  private:
   static DBus::Connection& getConnection(void);
+
+  // Proxy to the reboot host service, built on first use and kept for
+  // later calls. Dropped after a D-Bus error so the next call rebuilds it.
+  DbusReboot& getRebootClient(void);
+  void resetRebootClient(void);
+
+  // Reboot and RebootStatus are called from different threads.
+  std::mutex m_reboot_client_mutex;
+  std::unique_ptr<DbusReboot> m_reboot_client;
 };
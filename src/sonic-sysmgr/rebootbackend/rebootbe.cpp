@@ -3,6 +3,7 @@
 #include <google/protobuf/util/json_util.h>
 #include <unistd.h>
 
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -118,6 +119,15 @@ void RebootBE::SendNotificationResponse(const std::string key,
 NotificationResponse RebootBE::RequestRebootStatus(
     const std::string &jsonStatusRequest) {
   SWSS_LOG_ENTER();
+
+  // Status pollers ask far more often than the platform status changes:
+  // answer from the last platform response while it is fresh enough.
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  if (m_PlatformStatusValid &&
+      now - m_PlatformStatusTime < m_PlatformStatusMaxAge) {
+    return m_PlatformStatus;
+  }
+
   SWSS_LOG_NOTICE("Sending reboot status request to platform");
 
   NotificationResponse response = {.status = swss::StatusCode::SWSS_RC_SUCCESS,
@@ -137,9 +147,16 @@ NotificationResponse RebootBE::RequestRebootStatus(
   response.json_string = dbus_response.json_string;
   SWSS_LOG_NOTICE("Received reboot status response from platform: %s",
                   response.json_string.c_str());
+
+  // Only successful responses are reused, a failure is retried next time.
+  m_PlatformStatus = response;
+  m_PlatformStatusTime = now;
+  m_PlatformStatusValid = true;
   return response;
 }
 
+void RebootBE::InvalidatePlatformStatus() { m_PlatformStatusValid = false; }
+
 NotificationResponse RebootBE::HandleRebootRequest(
     const std::string &jsonRebootRequest) {
   using namespace gpu;
@@ -196,6 +213,8 @@ NotificationResponse RebootBE::HandleRebootRequest(
                   request.DebugString().c_str());
   response = m_RebootThread.Start(request);
   if (response.status == swss::StatusCode::SWSS_RC_SUCCESS) {
+    // A status from before this reboot must not be reported for it.
+    InvalidatePlatformStatus();
     if (request.method() == gnoi::system::RebootMethod::COLD) {
       SetCurrentStatus(RebManagerStatus::COLD_REBOOT_IN_PROGRESS);
     } else if (request.method() == gnoi::system::RebootMethod::HALT) {
@@ -306,6 +325,7 @@ void RebootBE::HandleRebootFinish() {
       "something is wrong");
   m_RebootThread.Join();
   SetCurrentStatus(RebManagerStatus::IDLE);
+  InvalidatePlatformStatus();
 }
 
 void RebootBE::HandleDone() {
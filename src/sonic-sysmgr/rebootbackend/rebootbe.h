@@ -1,4 +1,6 @@
 #pragma once
+#include <chrono>
+
 #include "dbconnector.h"
 #include "notificationconsumer.h"
 #include "notificationproducer.h"
@@ -54,6 +56,14 @@ class RebootBE {
 
   DbusInterface &m_dbus;
 
+  // Last platform reboot status, reused for requests within
+  // m_PlatformStatusMaxAge instead of another D-Bus round trip.
+  static constexpr uint32_t kPlatformStatusMaxAgeMs = 1000;
+  std::chrono::milliseconds m_PlatformStatusMaxAge{kPlatformStatusMaxAgeMs};
+  bool m_PlatformStatusValid = false;
+  std::chrono::steady_clock::time_point m_PlatformStatusTime;
+  NotificationResponse m_PlatformStatus;
+
   // Signalled by reboot thread when thread completes.
   swss::SelectableEvent m_RebootThreadFinished;
   RebootThread m_RebootThread;
@@ -71,6 +81,7 @@ class RebootBE {
                                 NotificationRequest &request);
   NotificationResponse RequestRebootStatus(
       const std::string &jsonStatusRequest);
+  void InvalidatePlatformStatus();
   NotificationResponse HandleRebootRequest(
       const std::string &jsonRebootRequest);
   NotificationResponse HandleStatusRequest(
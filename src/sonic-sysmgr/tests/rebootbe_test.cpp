@@ -180,6 +180,14 @@ class RebootBETestWithoutStop : public ::testing::Test {
     return m_rebootbe.HandleRebootRequest(json_request);
   }
 
+  NotificationResponse handle_status_request(std::string &json_request) {
+    return m_rebootbe.HandleStatusRequest(json_request);
+  }
+
+  void force_current_status(RebootBE::RebManagerStatus status) {
+    m_rebootbe.SetCurrentStatus(status);
+  }
+
   // Mock interfaces.
   NiceMock<MockDbusInterface> m_dbus_interface;
 
@@ -556,6 +564,50 @@ TEST_P(RebootBEAutoStartTest, ColdbootInProgressBlocksNewHaltboot) {
   EXPECT_THAT(response2.json_string.c_str(), StrEq("Reboot not allowed at this time. Cold Reboot in progress"));
 }
 
+TEST_P(RebootBEAutoStartTest, HaltStatusAnsweredFromCache) {
+  DbusInterface::DbusResponse dbus_response{
+      DbusInterface::DbusStatus::DBUS_SUCCESS, "{\"active\":true}"};
+  EXPECT_CALL(m_dbus_interface, RebootStatus(_))
+      .Times(2)
+      .WillRepeatedly(Return(dbus_response));
+
+  force_current_status(RebootBE::RebManagerStatus::HALT_REBOOT_IN_PROGRESS);
+  std::string json_request = "json status request";
+
+  // Second request within the staleness bound doesn't reach the platform.
+  NotificationResponse response1 = handle_status_request(json_request);
+  NotificationResponse response2 = handle_status_request(json_request);
+  EXPECT_EQ(response1.status, swss::StatusCode::SWSS_RC_SUCCESS);
+  EXPECT_THAT(response1.json_string, StrEq("{\"active\":true}"));
+  EXPECT_EQ(response2.status, swss::StatusCode::SWSS_RC_SUCCESS);
+  EXPECT_THAT(response2.json_string, StrEq("{\"active\":true}"));
+
+  // Stale cache: ask the platform again.
+  sleep(TWO_SECONDS);
+  NotificationResponse response3 = handle_status_request(json_request);
+  EXPECT_THAT(response3.json_string, StrEq("{\"active\":true}"));
+
+  force_current_status(RebootBE::RebManagerStatus::IDLE);
+}
+
+TEST_P(RebootBEAutoStartTest, HaltStatusFailureNotCached) {
+  DbusInterface::DbusResponse dbus_response{
+      DbusInterface::DbusStatus::DBUS_FAIL, "dbus error"};
+  EXPECT_CALL(m_dbus_interface, RebootStatus(_))
+      .Times(2)
+      .WillRepeatedly(Return(dbus_response));
+
+  force_current_status(RebootBE::RebManagerStatus::HALT_REBOOT_IN_PROGRESS);
+  std::string json_request = "json status request";
+
+  NotificationResponse response1 = handle_status_request(json_request);
+  NotificationResponse response2 = handle_status_request(json_request);
+  EXPECT_EQ(response1.status, swss::StatusCode::SWSS_RC_INTERNAL);
+  EXPECT_EQ(response2.status, swss::StatusCode::SWSS_RC_INTERNAL);
+
+  force_current_status(RebootBE::RebManagerStatus::IDLE);
+}
+
 INSTANTIATE_TEST_SUITE_P(TestWithStartupWarmbootEnabledState,
                          RebootBEAutoStartTest, testing::Values(true, false));
 
@@ -803,6 +803,24 @@ TEST_F(SsgMainTest, ssg_main_smart_switch_double_execution) {
     ssg_main_test(cfg);
 }
 
+/* TEST ssg_main() leaves unit files it already rendered untouched */
+TEST_F(SsgMainTest, ssg_main_unchanged_units_not_rewritten) {
+    SsgMainConfig cfg;
+    struct stat st_first, st_second;
+    std::string test_service = TEST_UNIT_FILE_PREFIX + "test.service";
+
+    /* Rendering settles after the second run, later runs change nothing */
+    cfg.num_asics = 10;
+    ssg_main_test(cfg);
+    ssg_main_test(cfg);
+    ASSERT_EQ(stat(test_service.c_str(), &st_first), 0);
+
+    /* A rewrite replaces the file, so the inode would change */
+    ssg_main_test(cfg);
+    ASSERT_EQ(stat(test_service.c_str(), &st_second), 0);
+    EXPECT_EQ(st_first.st_ino, st_second.st_ino);
+}
+
 }
 
 int main(int argc, char** argv) {
@@ -14,12 +14,19 @@
 #include <fstream>
 #include <unordered_map>
 #include <regex>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <system_error>
 
 #define MAX_NUM_TARGETS 48
 #define MAX_NUM_INSTALL_LINES 48
 #define MAX_NUM_UNITS 128
 #define MAX_BUF_SIZE 512
 #define MAX_PLATFORM_NAME_LEN 64
+#define MAX_NUM_WORKERS 8
 
 
 
@@ -77,8 +84,7 @@ const char* get_platform_conf_format() {
 const char* get_platform();
 
 static int num_asics;
-static char** multi_instance_services;
-static int num_multi_inst;
+static std::unordered_set<std::string> multi_instance_services;
 static bool smart_switch_npu;
 static bool smart_switch_dpu;
 static bool smart_switch;
@@ -169,54 +175,100 @@ static bool is_devnull(const char* path)
 }
 
 
-static int get_target_lines(const char* unit_file, char* target_lines[]) {
+/**
+ * Reads a whole unit file into memory.
+ *
+ * @param path The path of the unit file.
+ * @param content Receives the file content.
+ * @return true on success, false if the file can't be read.
+ */
+static bool read_unit_file(const std::string& path, std::string& content) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    content = ss.str();
+    return true;
+}
+
+
+/**
+ * Replaces a unit file with new content, unless it already has it.
+ *
+ * Units rendered on a previous boot usually don't change, skipping the
+ * rewrite keeps the boot path free of needless writes.
+ *
+ * @param path The path of the unit file.
+ * @param old_content The content the file was read with.
+ * @param new_content The rendered content.
+ * @return 1 if the file was written, 0 if unchanged, -1 on error.
+ */
+static int write_unit_file(const std::string& path, const std::string& old_content,
+                           const std::string& new_content) {
+    if (old_content == new_content) {
+        return 0;
+    }
+
+    std::string tmp_path = path + ".tmp";
+    std::ofstream tmp_file(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!tmp_file.is_open()) {
+        fprintf(stderr, "Failed to open %s\n", tmp_path.c_str());
+        return -1;
+    }
+    tmp_file << new_content;
+    tmp_file.close();
+    if (tmp_file.fail()) {
+        fprintf(stderr, "Failed to write %s\n", tmp_path.c_str());
+        remove(tmp_path.c_str());
+        return -1;
+    }
+
+    /* remove the unit file, rename the .tmp file as the unit file. */
+    remove(path.c_str());
+    rename(tmp_path.c_str(), path.c_str());
+    return 1;
+}
+
+
+static int get_target_lines(const std::string& unit_file, const std::string& content, char* target_lines[]) {
     /***
     Gets installation information for a given unit file
 
-    Returns lines in the [Install] section of a unit file
+    Returns lines in the [Install] section of the unit file content
     ***/
-    FILE *fp;
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t nread;
+    std::istringstream ss(content);
+    std::string line;
     bool found_install;
     int num_target_lines;
 
-
-    fp = fopen(unit_file, "r");
-
-    if (fp == NULL) {
-        fprintf(stderr, "Failed to open file %s\n", unit_file);
-        return -1;
-    }
-
     found_install = false;
     num_target_lines = 0;
 
-    while ((nread = getline(&line, &len, fp)) != -1 ) {
+    while (std::getline(ss, line)) {
+        if (!ss.eof()) {
+            line += "\n";
+        }
         // Assumes that [Install] is the last section of the unit file
-        if (strstr(line, "[Install]") != NULL) {
+        if (line.find("[Install]") != std::string::npos) {
              found_install = true;
         }
         else if (found_install) {
             if (num_target_lines >= MAX_NUM_INSTALL_LINES) {
-                fprintf(stderr, "Number of lines in [Install] section of %s exceeds MAX_NUM_INSTALL_LINES\n", unit_file);
+                fprintf(stderr, "Number of lines in [Install] section of %s exceeds MAX_NUM_INSTALL_LINES\n", unit_file.c_str());
                 fputs("Extra [Install] lines will be ignored\n", stderr);
                 break;
             }
-            target_lines[num_target_lines] = strdup(line);
+            target_lines[num_target_lines] = strdup(line.c_str());
             num_target_lines++;
         }
     }
 
-    free(line);
-
-    fclose(fp);
-
     return num_target_lines;
 }
 
-static bool is_multi_instance_service(std::string service_file, std::unordered_set<std::string> service_list=std::unordered_set<std::string>()){
+static bool is_multi_instance_service(const std::string& service_file, const std::unordered_set<std::string>& service_list=multi_instance_services){
     /*
         * The service name may contain @.service or .service. Remove these
         * postfixes and extract service name. Compare service name for absolute
@@ -233,19 +285,7 @@ static bool is_multi_instance_service(std::string service_file, std::unordered_s
     }
     std::string service_name = service_file.substr(0, service_file.find(delimiter));
 
-    if (service_list.empty()) {
-        for(int i=0; i < num_multi_inst; i++){
-
-            if (service_name == multi_instance_services[i]) {
-                return true;
-            }
-        }
-    } else {
-        if (service_list.count(service_name) > 0) {
-            return true;
-        }
-    }
-    return false;
+    return service_list.count(service_name) > 0;
 
 }
 
@@ -261,7 +301,7 @@ static bool is_multi_instance_service_for_dpu(const std::string& service_name) {
         return false;
     }
 
-    std::unordered_set<std::string> multi_instance_services_for_dpu = {"database", "dash-ha"};
+    static const std::unordered_set<std::string> multi_instance_services_for_dpu = {"database", "dash-ha"};
     return is_multi_instance_service(service_name, multi_instance_services_for_dpu);
 }
 
@@ -302,9 +342,11 @@ static int get_install_targets_from_line(std::string target_string, std::string
     return num_targets;
 }
 
-static void replace_multi_inst_dep(const char *src) {
+static std::string replace_multi_inst_dep(const std::string& content) {
     FILE *fp_src;
     FILE *fp_tmp;
+    char *tmp_buf = NULL;
+    size_t tmp_size = 0;
     char buf[MAX_BUF_SIZE];
     char* line = NULL;
     int i;
@@ -318,7 +360,6 @@ static void replace_multi_inst_dep(const char *src) {
     char *save_ptr2 = NULL;
     ssize_t nread;
     bool section_done = false;
-    char tmp_file_path[PATH_MAX];
 
     /* Assumes that the service files has 3 sections,
      * in the order: Unit, Service and Install.
@@ -328,9 +369,15 @@ static void replace_multi_inst_dep(const char *src) {
      * sections, replace if dependent on multi instance
      * service.
      */
-    fp_src = fopen(src, "r");
-    snprintf(tmp_file_path, PATH_MAX, "%s.tmp", src);
-    fp_tmp = fopen(tmp_file_path, "w");
+    if (content.empty()) {
+        return content;
+    }
+    fp_src = fmemopen((void *)content.data(), content.size(), "r");
+    fp_tmp = open_memstream(&tmp_buf, &tmp_size);
+    if (fp_src == NULL || fp_tmp == NULL) {
+        fprintf(stderr, "Failed to allocate memory for unit file\n");
+        exit(EXIT_FAILURE);
+    }
 
     while ((nread = getline(&line, &len, fp_src)) != -1 ) {
         if ((strstr(line, "[Service]") != NULL) ||
@@ -381,17 +428,16 @@ static void replace_multi_inst_dep(const char *src) {
     fclose(fp_src);
     fclose(fp_tmp);
     free(line);
-    /* remove the .service file, rename the .service.tmp file
-     * as .service.
-     */
-    remove(src);
-    rename(tmp_file_path, src);
+
+    std::string rendered(tmp_buf, tmp_size);
+    free(tmp_buf);
+    return rendered;
 }
 
-static void update_environment(const std::string &src)
+static std::string update_environment(const std::string &content)
 {
-    std::ifstream src_file(src);
-    std::ofstream tmp_file(src + ".tmp");
+    std::istringstream src_file(content);
+    std::ostringstream tmp_file;
     bool has_service_section = false;
     std::string line;
 
@@ -431,21 +477,29 @@ static void update_environment(const std::string &src)
         }
     }
 
-    src_file.close();
-    tmp_file.close();
-    // remove the original file and rename the temporary file
-    remove(src.c_str());
-    rename((src + ".tmp").c_str(), src.c_str());
+    return tmp_file.str();
 }
 
-int get_install_targets(std::string unit_file, char* targets[]) {
+static std::string render_multi_inst_dep(const std::string& unit_file, const std::string& content) {
     /***
-    Returns install targets for a unit file
+    Expands dependencies on multi instance services in a unit file,
+    unless the unit itself is one of them
+    ***/
+    std::string instance_name = unit_file.substr(0, unit_file.find('.'));
+
+    if(((num_asics > 1) && (!is_multi_instance_service(instance_name)))
+        || ((num_dpus > 0) && (!is_multi_instance_service_for_dpu(instance_name)))) {
+        return replace_multi_inst_dep(content);
+    }
+    return content;
+}
 
-    Parses the information in the [Install] section of a given
-    unit file to determine which directories to install the unit in
+
+static int get_install_targets_from_content(const std::string& unit_file, const std::string& content, char* targets[]) {
+    /***
+    Parses the information in the [Install] section of the unit file
+    content to determine which directories to install the unit in
     ***/
-    std::string file_path;
     char *target_lines[MAX_NUM_INSTALL_LINES];
     int num_target_lines;
     int num_targets;
@@ -454,22 +508,8 @@ int get_install_targets(std::string unit_file, char* targets[]) {
     char* line = NULL;
     bool first;
     std::string target_suffix;
-    std::string instance_name;
 
-    file_path = get_unit_file_prefix() + unit_file;
-
-    instance_name = unit_file.substr(0, unit_file.find('.'));
-
-    if(((num_asics > 1) && (!is_multi_instance_service(instance_name)))
-        || ((num_dpus > 0) && (!is_multi_instance_service_for_dpu(instance_name)))) {
-        replace_multi_inst_dep(file_path.c_str());
-    }
-
-    num_target_lines = get_target_lines(file_path.c_str(), target_lines);
-    if (num_target_lines < 0) {
-        fprintf(stderr, "Error parsing targets for %s\n", unit_file.c_str());
-        return -1;
-    }
+    num_target_lines = get_target_lines(unit_file, content, target_lines);
 
     num_targets = 0;
 
@@ -501,6 +541,31 @@ int get_install_targets(std::string unit_file, char* targets[]) {
 }
 
 
+int get_install_targets(std::string unit_file, char* targets[]) {
+    /***
+    Returns install targets for a unit file
+
+    Renders the multi instance dependencies of the unit file and
+    returns the targets from its [Install] section
+    ***/
+    std::string file_path = get_unit_file_prefix() + unit_file;
+    std::string content;
+
+    if (!read_unit_file(file_path, content)) {
+        fprintf(stderr, "Failed to open file %s\n", file_path.c_str());
+        fprintf(stderr, "Error parsing targets for %s\n", unit_file.c_str());
+        return -1;
+    }
+
+    std::string rendered = render_multi_inst_dep(unit_file, content);
+    if (write_unit_file(file_path, content, rendered) < 0) {
+        return -1;
+    }
+
+    return get_install_targets_from_content(unit_file, rendered, targets);
+}
+
+
 int get_unit_files(const char* config_file, char* unit_files[], int unit_files_size) {
     /***
     Reads a list of unit files to be installed from config_file
@@ -520,11 +585,6 @@ int get_unit_files(const char* config_file, char* unit_files[], int unit_files_s
 
     int num_unit_files = 0;
 
-    if (!multi_instance_services) {
-        num_multi_inst = 0;
-        multi_instance_services = (char**) calloc(MAX_NUM_UNITS, sizeof(char *));
-    }
-
     while ((read = getline(&line, &len, fp)) != -1) {
         if (num_unit_files >= unit_files_size) {
             fprintf(stderr, "Maximum number of units exceeded, ignoring extras\n");
@@ -535,9 +595,7 @@ int get_unit_files(const char* config_file, char* unit_files[], int unit_files_s
         /* Get the multi-instance services */
         pos = strchr(line, '@');
         if (pos != NULL) {
-            multi_instance_services[num_multi_inst] = (char*) calloc(pos-line+1, sizeof(char));
-            snprintf(multi_instance_services[num_multi_inst], pos-line+1, "%s", line);
-            num_multi_inst++;
+            multi_instance_services.insert(std::string(line, pos - line));
         }
 
         /* topology service to be started only for multiasic VS platform */
@@ -598,6 +656,12 @@ std::string insert_instance_number(const std::string& unit_file, int instance, c
 }
 
 
+// Serializes target directory setup between the unit workers, which may
+// share a target. Unlocked, one worker could remove a file in the way of
+// a directory that another worker has just created in its place.
+static std::mutex target_dir_mutex;
+
+
 static int create_symlink(const std::string& unit, const std::string& target, const std::string& install_dir, int instance,  const std::string& instance_prefix) {
     struct stat st;
     std::string src_path;
@@ -618,6 +682,7 @@ static int create_symlink(const std::string& unit, const std::string& target, co
     final_install_dir = install_dir + std::string(target);
     dest_path = final_install_dir + "/" + unit_instance;
 
+    std::unique_lock<std::mutex> target_dir_lock(target_dir_mutex);
     if (stat(final_install_dir.c_str(), &st) == -1) {
         // If doesn't exist, create
         r = mkdir(final_install_dir.c_str(), 0755);
@@ -648,6 +713,7 @@ static int create_symlink(const std::string& unit, const std::string& target, co
             return -1;
         }
     }
+    target_dir_lock.unlock();
 
     if (is_devnull(dest_path.c_str())) {
         if (remove(dest_path.c_str()) != 0) {
@@ -1142,15 +1208,64 @@ static int install_network_service_for_smart_switch() {
 }
 
 
+/**
+ * Renders a unit file and installs it to its targets.
+ *
+ * The unit file is read once, its multi instance dependencies and
+ * environment are rendered in memory, and it is written back only if
+ * that changed it.
+ *
+ * @param unit_file The name of the unit file.
+ * @param install_dir The generator output directory.
+ * @return 1 if the unit file was rewritten, 0 if unchanged, -1 on error.
+ */
+static int generate_unit(const std::string& unit_file, const std::string& install_dir) {
+    char* targets[MAX_NUM_TARGETS];
+    std::string file_path = get_unit_file_prefix() + unit_file;
+    std::string content;
+    int num_targets;
+    int r;
+
+    if (!read_unit_file(file_path, content)) {
+        fprintf(stderr, "Failed to open file %s\n", file_path.c_str());
+        fprintf(stderr, "Error parsing %s\n", unit_file.c_str());
+        return -1;
+    }
+
+    std::string rendered = render_multi_inst_dep(unit_file, content);
+
+    num_targets = get_install_targets_from_content(unit_file, rendered, targets);
+    for (int j = 0; j < num_targets; j++) {
+        if (install_unit_file(unit_file, targets[j], install_dir) != 0)
+            fprintf(stderr, "Error installing %s to target directory %s\n", unit_file.c_str(), targets[j]);
+
+        free(targets[j]);
+    }
+
+    rendered = update_environment(rendered);
+
+    r = write_unit_file(file_path, content, rendered);
+    if (r < 0) {
+        fprintf(stderr, "Error writing %s\n", unit_file.c_str());
+    }
+    return r;
+}
+
+
 int ssg_main(int argc, char **argv) {
     char* unit_files[MAX_NUM_UNITS];
     std::string install_dir;
-    char* targets[MAX_NUM_TARGETS];
     std::string unit_instance;
     std::string prefix;
     std::string suffix;
     int num_unit_files;
-    int num_targets;
+    std::vector<std::string> units;
+    std::unordered_set<std::string> seen_units;
+    std::atomic<size_t> next_unit(0);
+    std::atomic<int> num_written(0);
+    std::vector<std::thread> workers;
+    unsigned int num_workers;
+    auto start_time = std::chrono::steady_clock::now();
 
 #ifdef _SSG_UNITTEST
     clean_up_cache();
@@ -1182,7 +1297,8 @@ int ssg_main(int argc, char **argv) {
         }
     }
 
-    // For each unit file, get the installation targets and install the unit
+    // Index the unit files to install. A template and its single
+    // instance form map to the same file, which must be rendered once.
     for (int i = 0; i < num_unit_files; i++) {
         unit_instance = unit_files[i];
         if ((num_asics == 1 &&
@@ -1194,36 +1310,54 @@ int ssg_main(int argc, char **argv) {
             unit_instance = prefix + suffix;
         }
 
-        num_targets = get_install_targets(unit_instance, targets);
-        if (num_targets < 0) {
-            fprintf(stderr, "Error parsing %s\n", unit_instance.c_str());
-            free(unit_files[i]);
-            continue;
+        if (seen_units.insert(unit_instance).second) {
+            units.push_back(unit_instance);
         }
+        free(unit_files[i]);
+    }
 
-        for (int j = 0; j < num_targets; j++) {
-            if (install_unit_file(unit_instance, targets[j], install_dir) != 0)
-                fprintf(stderr, "Error installing %s to target directory %s\n", unit_instance.c_str(), targets[j]);
-
-            free(targets[j]);
+    // Each unit only touches its own file and symlinks, so the units are
+    // rendered and installed by a pool of workers.
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next_unit++) < units.size()) {
+            if (generate_unit(units[i], install_dir) > 0) {
+                num_written++;
+            }
         }
+    };
 
-        update_environment(get_unit_file_prefix() + unit_instance);
-
-        free(unit_files[i]);
+    num_workers = std::thread::hardware_concurrency();
+    if (num_workers > MAX_NUM_WORKERS) {
+        num_workers = MAX_NUM_WORKERS;
     }
-
-    for (int i = 0; i < num_multi_inst; i++) {
-        free(multi_instance_services[i]);
+    if (num_workers > units.size()) {
+        num_workers = units.size();
+    }
+    for (unsigned int i = 1; i < num_workers; i++) {
+        try {
+            workers.emplace_back(worker);
+        } catch (const std::system_error &e) {
+            // The calling thread still works through all the units
+            break;
+        }
+    }
+    worker();
+    for (auto &t : workers) {
+        t.join();
     }
-    free(multi_instance_services);
-    multi_instance_services = NULL;
-    num_multi_inst = 0;
+
+    multi_instance_services.clear();
 
     if (is_valid_pointer(platform_info)) {
         json_object_put(platform_info);
     }
 
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time);
+    fprintf(stderr, "systemd-sonic-generator: %zu units, %d rewritten, %zu workers, %lld ms\n",
+            units.size(), num_written.load(), workers.size() + 1, (long long) elapsed.count());
+
     return 0;
 }
 
@@ -0,0 +1,954 @@
+#include <errno.h>
+#include <limits.h>
+#include <pwd.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Remote user gecos prefix, which been assigned by nss_tacplus */
+#define REMOTE_USER_GECOS_PREFIX      "remote_user"
+
+/* Default value for getpwent */
+#define DEFAULT_GETPWENT_SIZE_MAX     4096
+
+/* Remote IP address size */
+#define REMOTE_ADDRESS_SIZE     64
+
+/* Return value for is_local_user method */
+#define IS_LOCAL_USER              0
+#define IS_REMOTE_USER             1
+#define ERROR_CHECK_LOCAL_USER     2
+
+/* Tacacs+ lib */
+#include <libtac/libtac.h>
+
+/* Tacacs+ support lib */
+#include <libtac/support.h>
+
+/* Output syslog to mock method when build with UT */
+#if defined (BASH_PLUGIN_UT)
+#define syslog mock_syslog
+#define getpwent_r mock_getpwent_r
+#endif
+
+/* Tacacs+ log format */
+#define  TACACS_LOG_FORMAT "TACACS+: %s"
+
+/* Tacacs+ config file timestamp string format */
+#define  CONFIG_FILE_TIME_STAMP_FORMAT "%d.%m.%Y %H:%M:%S"
+
+/* Tacacs+ config file timestamp string length */
+#define  CONFIG_FILE_TIME_STAMP_LEN  100
+
+#define GET_ENV_VARIABLE_OK                 0
+#define GET_ENV_VARIABLE_NOT_FOUND          1
+#define GET_ENV_VARIABLE_INCORRECT_FORMAT   2
+#define GET_ENV_VARIABLE_NOT_ENOUGH_BUFFER  3
+#define GET_REMOTE_ADDRESS_OK               0
+#define GET_REMOTE_ADDRESS_FAILED           1
+
+/* Authorization cache entry count */
+#define AUTHORIZATION_CACHE_SIZE            64
+
+/* Authorization cache key size, commands with a longer key are not cached */
+#define AUTHORIZATION_CACHE_KEY_SIZE        1024
+
+/* Max authorization cache TTL in seconds */
+#define AUTHORIZATION_CACHE_TTL_MAX         300
+
+/* Authorization cache TTL setting in plugin config file */
+#define AUTHORIZATION_CACHE_TTL_SETTING     "authorization_cache_ttl="
+
+/* Seconds a server that failed to connect is tried after the other servers */
+#define SERVER_HOLD_DOWN_TIME               30
+
+/*
+    Convert log to a string because va args resoursive issue:
+    http://www.c-faq.com/varargs/handoff.html
+*/
+#define GENERATE_LOG_FROM_VA(logBufferName)                 \
+    char logBufferName[512];                                \
+    va_list args;                                           \
+    va_start(args, format);                                 \
+    vsnprintf(logBufferName, sizeof(logBufferName), format, args);  \
+    va_end(args);
+
+/* Config file path */
+const char *tacacs_config_file = "/etc/tacplus_nss.conf";
+
+/* Unknown user name */
+const char *unknown_username = "UNKNOWN";
+
+/* Plugin config file path */
+const char *plugin_config_file = "/etc/bash_tacplus.conf";
+
+/* Config file attribute */
+struct stat config_file_attr;
+
+/* Plugin config file attribute, zero when the file is missing */
+struct stat plugin_config_file_attr;
+
+/* Positive authorization cache TTL in seconds, 0 for disabled */
+int authorization_cache_ttl = 0;
+
+/* Tacacs server config data */
+typedef struct {
+    struct addrinfo *address;
+    const char *key;
+} tacacs_server_t;
+
+/* Tacacs control flag */
+int tacacs_ctrl;
+
+/* Authorization cache entry */
+typedef struct {
+    uint64_t hash;
+    time_t expire;
+    uint16_t key_len;
+    char key[AUTHORIZATION_CACHE_KEY_SIZE];
+} authorization_cache_entry_t;
+
+/*
+    State shared by all commands of the current shell.
+    The plugin runs in the forked child just before execve, so per process
+    memory is lost after every command. The state is mapped shared and
+    anonymous in plugin_init, every child inherits the mapping and execve drops it,
+    so only the shell and the plugin can access it.
+*/
+typedef struct {
+    pthread_mutex_t lock;
+    time_t config_mtime;
+    time_t plugin_config_mtime;
+    time_t server_failed_time[TAC_PLUS_MAXSERVERS];
+    authorization_cache_entry_t cache[AUTHORIZATION_CACHE_SIZE];
+} shared_state_t;
+
+shared_state_t *shared_state = NULL;
+
+/*
+ * Output error message.
+ */
+void output_error(const char *format, ...)
+{
+    GENERATE_LOG_FROM_VA(logBuffer);
+
+    if (tacacs_ctrl & PAM_TAC_DEBUG) {
+        fprintf(stderr, TACACS_LOG_FORMAT, logBuffer);
+    }
+
+    syslog(LOG_ERR, TACACS_LOG_FORMAT, logBuffer);
+}
+
+/*
+ * Output debug message.
+ */
+void output_debug(const char *format, ...)
+{
+    if ((tacacs_ctrl & PAM_TAC_DEBUG) == 0) {
+        return;
+    }
+
+    GENERATE_LOG_FROM_VA(logBuffer);
+    fprintf(stderr, TACACS_LOG_FORMAT, logBuffer);
+    syslog(LOG_DEBUG, TACACS_LOG_FORMAT, logBuffer);
+}
+
+
+/*
+ * Get monotonic time in seconds.
+ */
+time_t get_monotonic_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec;
+}
+
+/*
+ * Create state shared by the shell and all its commands.
+ */
+void initialize_shared_state()
+{
+    pthread_mutexattr_t attr;
+    void *state = mmap(NULL, sizeof(shared_state_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (state == MAP_FAILED) {
+        output_error("failed to create shared state: %s\n", strerror(errno));
+        return;
+    }
+
+    shared_state = (shared_state_t *)state;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    // a command may be killed while holding the lock
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&shared_state->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+/*
+ * Release shared state.
+ */
+void release_shared_state()
+{
+    if (shared_state == NULL) {
+        return;
+    }
+
+    munmap(shared_state, sizeof(shared_state_t));
+    shared_state = NULL;
+}
+
+/*
+ * Lock shared state, flush it when tacacs config changed.
+ */
+int lock_shared_state()
+{
+    if (shared_state == NULL) {
+        return -1;
+    }
+
+    int result = pthread_mutex_lock(&shared_state->lock);
+    if (result == EOWNERDEAD) {
+        // previous owner died, the state may be half written
+        output_debug("shared state owner died, reset shared state.\n");
+        memset(shared_state->server_failed_time, 0, sizeof(shared_state->server_failed_time));
+        memset(shared_state->cache, 0, sizeof(shared_state->cache));
+        pthread_mutex_consistent(&shared_state->lock);
+        result = 0;
+    }
+
+    if (result) {
+        output_error("failed to lock shared state: %s\n", strerror(result));
+        return -1;
+    }
+
+    if (shared_state->config_mtime != config_file_attr.st_mtime) {
+        // server list or server policy may changed
+        shared_state->config_mtime = config_file_attr.st_mtime;
+        memset(shared_state->server_failed_time, 0, sizeof(shared_state->server_failed_time));
+        memset(shared_state->cache, 0, sizeof(shared_state->cache));
+    }
+
+    if (shared_state->plugin_config_mtime != plugin_config_file_attr.st_mtime) {
+        // cache TTL may changed, drop results cached with the old one
+        shared_state->plugin_config_mtime = plugin_config_file_attr.st_mtime;
+        memset(shared_state->cache, 0, sizeof(shared_state->cache));
+    }
+
+    return 0;
+}
+
+/*
+ * Unlock shared state.
+ */
+void unlock_shared_state()
+{
+    pthread_mutex_unlock(&shared_state->lock);
+}
+
+/*
+ * Append a '\0' terminated part to authorization cache key.
+ */
+int append_authorization_cache_key(char *key, int key_len, const char *part)
+{
+    int part_len = strlen(part) + 1;
+    if (key_len < 0 || key_len + part_len > AUTHORIZATION_CACHE_KEY_SIZE) {
+        return -1;
+    }
+
+    memcpy(key + key_len, part, part_len);
+    return key_len + part_len;
+}
+
+/*
+ * Build authorization cache key, return key length or -1 when key too long.
+ */
+int build_authorization_cache_key(
+    char *key,
+    const char *user,
+    const char *tty,
+    const char *remote,
+    const char *cmd,
+    char **args,
+    int argc)
+{
+    int key_len = 0;
+    int i;
+
+    key_len = append_authorization_cache_key(key, key_len, user);
+    key_len = append_authorization_cache_key(key, key_len, tty);
+    key_len = append_authorization_cache_key(key, key_len, remote);
+    key_len = append_authorization_cache_key(key, key_len, cmd);
+    for(i=1; i<argc; i++) {
+        // full argument, server only get first 247 bytes but same prefix not means same command
+        key_len = append_authorization_cache_key(key, key_len, args[i]);
+    }
+
+    return key_len;
+}
+
+/*
+ * FNV-1a hash of authorization cache key.
+ */
+uint64_t hash_authorization_cache_key(const char *key, int key_len)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    int i;
+    for (i = 0; i < key_len; i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/*
+ * Check if command authorized by a cached server response.
+ */
+int check_authorization_cache(const char *key, int key_len)
+{
+    int authorized = 0;
+    int i;
+
+    if (authorization_cache_ttl <= 0 || key_len < 0 || lock_shared_state()) {
+        return 0;
+    }
+
+    uint64_t hash = hash_authorization_cache_key(key, key_len);
+    time_t now = get_monotonic_time();
+    for (i = 0; i < AUTHORIZATION_CACHE_SIZE; i++) {
+        authorization_cache_entry_t *entry = &shared_state->cache[i];
+        if (entry->hash == hash
+            && entry->key_len == key_len
+            && entry->expire > now
+            && memcmp(entry->key, key, key_len) == 0) {
+            authorized = 1;
+            break;
+        }
+    }
+
+    unlock_shared_state();
+    return authorized;
+}
+
+/*
+ * Cache a successful authorization.
+ */
+void update_authorization_cache(const char *key, int key_len)
+{
+    int i;
+
+    if (authorization_cache_ttl <= 0 || key_len < 0 || lock_shared_state()) {
+        return;
+    }
+
+    // reuse same key, or replace the entry expire first
+    uint64_t hash = hash_authorization_cache_key(key, key_len);
+    authorization_cache_entry_t *victim = &shared_state->cache[0];
+    for (i = 0; i < AUTHORIZATION_CACHE_SIZE; i++) {
+        authorization_cache_entry_t *entry = &shared_state->cache[i];
+        if (entry->hash == hash
+            && entry->key_len == key_len
+            && memcmp(entry->key, key, key_len) == 0) {
+            victim = entry;
+            break;
+        }
+
+        if (entry->expire < victim->expire) {
+            victim = entry;
+        }
+    }
+
+    victim->hash = hash;
+    victim->expire = get_monotonic_time() + authorization_cache_ttl;
+    victim->key_len = key_len;
+    memcpy(victim->key, key, key_len);
+
+    unlock_shared_state();
+}
+
+/*
+ * Get server try order, servers failed to connect recently are tried last.
+ */
+void get_server_order(int *order)
+{
+    int i, count = 0;
+
+    if (lock_shared_state()) {
+        for (i = 0; i < tac_srv_no; i++) {
+            order[i] = i;
+        }
+        return;
+    }
+
+    time_t now = get_monotonic_time();
+    for (i = 0; i < tac_srv_no; i++) {
+        time_t failed_time = shared_state->server_failed_time[i];
+        if (failed_time == 0 || now - failed_time >= SERVER_HOLD_DOWN_TIME) {
+            order[count++] = i;
+        }
+    }
+
+    for (i = 0; i < tac_srv_no; i++) {
+        time_t failed_time = shared_state->server_failed_time[i];
+        if (failed_time != 0 && now - failed_time < SERVER_HOLD_DOWN_TIME) {
+            order[count++] = i;
+        }
+    }
+
+    unlock_shared_state();
+}
+
+/*
+ * Record server connect result.
+ */
+void update_server_state(int server_idx, int connected)
+{
+    if (lock_shared_state()) {
+        return;
+    }
+
+    // 0 means connected
+    shared_state->server_failed_time[server_idx] = connected ? 0 : get_monotonic_time();
+    unlock_shared_state();
+}
+
+/*
+ * Send authorization message.
+ * This method based on send_auth_msg in https://github.com/daveolson53/tacplus-auth/blob/master/tacplus-auth.c
+ */
+int send_authorization_message(
+    int tac_fd,
+    const char *user,
+    const char *tty,
+    const char *remote,
+    uint16_t taskid,
+    const char *cmd,
+    char **args,
+    int argc)
+{
+    char buf[128];
+    struct tac_attrib *attr;
+    int retval;
+    struct areply re;
+    int i;
+
+    attr=(struct tac_attrib *)xcalloc(1, sizeof(struct tac_attrib));
+
+    snprintf(buf, sizeof buf, "%hu", taskid);
+    tac_add_attrib(&attr, "task_id", buf);
+    tac_add_attrib(&attr, "protocol", "ssh");
+    tac_add_attrib(&attr, "service", "shell");
+
+    tac_add_attrib(&attr, "cmd", (char*)cmd);
+
+    for(i=1; i<argc; i++) {
+        // TACACS protocol allow max 255 bytes per argument. 'cmd-arg' will take 7 bytes.
+        char tbuf[248];
+        const char *arg;
+        if(strlen(args[i]) >= sizeof(tbuf)) {
+            snprintf(tbuf, sizeof tbuf, "%s", args[i]);
+            arg = tbuf;
+        }
+        else {
+            arg = args[i];
+        }
+
+        tac_add_attrib(&attr, "cmd-arg", (char *)arg);
+    }
+
+    re.msg = NULL;
+    output_debug("send authorizatiom message with user: %s, tty: %s, remote: %s\n", user, tty, remote);
+    retval = tac_author_send(tac_fd, (char *)user, (char *)tty, (char *)remote, attr);
+    output_debug("authorization result: %d\n", retval);
+
+    if(retval < 0) {
+        output_error("send of authorization message failed: %s\n", strerror(errno));
+    }
+    else {
+        retval = tac_author_read(tac_fd, &re);
+        if (retval < 0) {
+            output_debug("authorization response failed: %d\n", retval);
+        }
+        else if(re.status == AUTHOR_STATUS_PASS_ADD ||
+                    re.status == AUTHOR_STATUS_PASS_REPL) {
+            retval = 0;
+        }
+        else  {
+            output_debug("command not authorized (%d)\n", re.status);
+            retval = 1;
+        }
+    }
+
+    tac_free_attrib(&attr);
+    if(re.msg != NULL) {
+        free(re.msg);
+    }
+
+    return retval;
+}
+
+/*
+ * Send tacacs authorization request.
+ * This method based on send_tacacs_auth in https://github.com/daveolson53/tacplus-auth/blob/master/tacplus-auth.c
+ */
+int tacacs_authorization(
+    const char *user,
+    const char *tty,
+    const char *remote,
+    const char *cmd,
+    char **args,
+    int argc)
+{
+    int result = 1, server_idx, server_fd, connected_servers=0;
+    uint16_t task_id = (uint16_t)getpid();
+    int server_order[TAC_PLUS_MAXSERVERS];
+    int i;
+
+    char cache_key[AUTHORIZATION_CACHE_KEY_SIZE];
+    int cache_key_len = -1;
+    if (authorization_cache_ttl > 0) {
+        cache_key_len = build_authorization_cache_key(cache_key, user, tty, remote, cmd, args, argc);
+        if (check_authorization_cache(cache_key, cache_key_len)) {
+            output_debug("%s authorized from cache\n", cmd);
+            return 0;
+        }
+    }
+
+    get_server_order(server_order);
+    for(i = 0; i < tac_srv_no; i++) {
+        server_idx = server_order[i];
+        server_fd = tac_connect_single(tac_srv[server_idx].addr, tac_srv[server_idx].key, tac_source_addr, tac_timeout, __vrfname);
+        if(server_fd < 0) {
+            // connect to tacacs server failed
+            output_error("Failed to connecting to %s to request authorization for %s: %s\n", tac_ntop(tac_srv[server_idx].addr->ai_addr), cmd, strerror(errno));
+            update_server_state(server_idx, 0);
+            continue;
+        }
+
+        // increase connected servers
+        connected_servers++;
+        update_server_state(server_idx, 1);
+        result = send_authorization_message(server_fd, user, tty, remote, task_id, cmd, args, argc);
+        close(server_fd);
+        if(result) {
+            // authorization failed
+            output_debug("%s not authorized from %s\n", cmd, tac_ntop(tac_srv[server_idx].addr->ai_addr));
+        }
+        else {
+            // authorization successed
+            output_debug("%s authorized from %s\n", cmd, tac_ntop(tac_srv[server_idx].addr->ai_addr));
+            update_authorization_cache(cache_key, cache_key_len);
+            break;
+        }
+    }
+
+    // can't connect to any server
+    if(!connected_servers) {
+        result = -2;
+        output_error("Failed to connect to TACACS server(s)\n");
+    }
+
+    return result;
+}
+
+/*
+ * Get environment variable first part by name and delimiters
+ */
+int get_environment_variable_first_part(char* dst, socklen_t size, const char* name, const char* delimiters)
+{
+    memset(dst, 0, size);
+
+    const char* variable = getenv(name);
+    if (variable == NULL) {
+        output_debug("Can't get environment variable %s, errno=%d", name, errno);
+        return GET_ENV_VARIABLE_NOT_FOUND;
+    }
+
+    char* context = NULL;
+    char* first_part = strtok_r((char *)variable, delimiters, &context);
+    if (first_part == NULL) {
+        output_debug("Can't split %s by delimiters %s", variable, delimiters);
+        return GET_ENV_VARIABLE_INCORRECT_FORMAT;
+    }
+
+    int first_part_len = strlen(first_part);
+    if (first_part_len >= size) {
+        output_debug("Dest buffer size %d not enough for %s", size, first_part);
+        return GET_ENV_VARIABLE_NOT_ENOUGH_BUFFER;
+    }
+
+    snprintf(dst, size, "%s", first_part);
+    output_debug("Remote address=%s", dst);
+    return GET_ENV_VARIABLE_OK;
+}
+
+/*
+ * Get current SSH session remote address from environment variable
+ */
+int get_remote_address(char* dst, socklen_t size)
+{
+    // SSHD will create environment variable SSH_CONNECTION after user session created.
+    if (get_environment_variable_first_part(dst, size, "SSH_CONNECTION", " ") == GET_ENV_VARIABLE_OK) {
+        return GET_REMOTE_ADDRESS_OK;
+    }
+
+    // Before user session created, SSHD will create environment variable SSH_CLIENT_IPADDR_PORT.
+    if (get_environment_variable_first_part(dst, size, "SSH_CLIENT_IPADDR_PORT", " ") == GET_ENV_VARIABLE_OK) {
+        return GET_REMOTE_ADDRESS_OK;
+    }
+
+    return GET_REMOTE_ADDRESS_FAILED;
+}
+
+/*
+ * Send authorization request.
+ * This method based on build_auth_req in https://github.com/daveolson53/tacplus-auth/blob/master/tacplus-auth.c
+ */
+int authorization_with_host_and_tty(const char *user, const char *cmd, char **argv, int argc)
+{
+    // try get host name
+    char remote_addr[REMOTE_ADDRESS_SIZE];
+    memset(&remote_addr, 0, sizeof(remote_addr));
+
+    int result = get_remote_address(remote_addr, sizeof(remote_addr));
+    if ((result != GET_REMOTE_ADDRESS_OK)) {
+        snprintf(remote_addr, sizeof(remote_addr), "UNK");
+        output_error("Failed to determine remote address, passing %s\n", remote_addr);
+    }
+
+    // try get tty name
+    char ttyname[64];
+    memset(&ttyname, 0, sizeof(ttyname));
+
+    int i;
+    for(i=0; i<3; i++) {
+        int result;
+        if (isatty(i)) {
+            result = ttyname_r(i, ttyname, sizeof(ttyname) -1);
+            if (result) {
+                output_error("Failed to get tty name for fd %d: %s\n", i, strerror(result));
+            }
+            break;
+        }
+    }
+
+    if (!ttyname[0]) {
+        snprintf(ttyname, sizeof(ttyname), "UNK");
+        output_error("Failed to determine tty, passing %s\n", ttyname);
+    }
+
+    // send tacacs authorization request
+    return tacacs_authorization(user, ttyname, remote_addr, cmd, argv, argc);
+}
+
+/*
+ * Load plugin config, only trust file owned by root and not writable by other users.
+ */
+void load_plugin_config()
+{
+    char line_buffer[256];
+    struct stat attr;
+    FILE *config_file;
+
+    authorization_cache_ttl = 0;
+    memset(&plugin_config_file_attr, 0, sizeof(plugin_config_file_attr));
+    config_file = fopen(plugin_config_file, "r");
+    if (config_file == NULL) {
+        return;
+    }
+
+    if (fstat(fileno(config_file), &attr)) {
+        output_error("failed to stat plugin config file %s\n", plugin_config_file);
+        fclose(config_file);
+        return;
+    }
+
+    // remember the file even when it is ignored
+    plugin_config_file_attr = attr;
+    if (attr.st_uid != 0 || (attr.st_mode & (S_IWGRP | S_IWOTH))) {
+        output_error("ignore plugin config file %s: not owned by root or writable by other users\n", plugin_config_file);
+        fclose(config_file);
+        return;
+    }
+
+    while (fgets(line_buffer, sizeof(line_buffer), config_file)) {
+        if (strncmp(line_buffer, AUTHORIZATION_CACHE_TTL_SETTING, strlen(AUTHORIZATION_CACHE_TTL_SETTING)) == 0) {
+            authorization_cache_ttl = atoi(line_buffer + strlen(AUTHORIZATION_CACHE_TTL_SETTING));
+            if (authorization_cache_ttl < 0) {
+                authorization_cache_ttl = 0;
+            }
+            else if (authorization_cache_ttl > AUTHORIZATION_CACHE_TTL_MAX) {
+                authorization_cache_ttl = AUTHORIZATION_CACHE_TTL_MAX;
+            }
+        }
+    }
+
+    fclose(config_file);
+}
+
+/*
+ * Load tacacs config.
+ */
+void load_tacacs_config()
+{
+    // load config file: tacacs_config_file
+    tacacs_ctrl = parse_config_file (tacacs_config_file);
+
+    // load plugin config file: plugin_config_file
+    load_plugin_config();
+
+    output_debug("tacacs config updated:\n");
+    int server_idx;
+    for(server_idx = 0; server_idx < tac_srv_no; server_idx++) {
+        output_debug("Server %d, address:%s, key length:%d\n", server_idx, tac_ntop(tac_srv[server_idx].addr->ai_addr),strlen(tac_srv[server_idx].key));
+    }
+
+    output_debug("TACACS+ control flag: 0x%x\n", tacacs_ctrl);
+
+    if (tacacs_ctrl & AUTHORIZATION_FLAG_TACACS) {
+        output_debug("TACACS+ per-command authorization enabled.\n");
+    }
+
+    if (tacacs_ctrl & AUTHORIZATION_FLAG_LOCAL) {
+        output_debug("Local per-command authorization enabled.\n");
+    }
+
+    if (tacacs_ctrl & PAM_TAC_DEBUG) {
+        output_debug("TACACS+ debug enabled.\n");
+    }
+
+    if (authorization_cache_ttl > 0) {
+        output_debug("TACACS+ authorization cache enabled, TTL: %d seconds.\n", authorization_cache_ttl);
+    }
+}
+
+/*
+ * Load tacacs config.
+ */
+void check_and_load_changed_tacacs_config()
+{
+    struct stat attr;
+    // get config file stat, check if file changed
+    stat(tacacs_config_file, &attr);
+    char date[CONFIG_FILE_TIME_STAMP_LEN];
+    strftime(date, sizeof(date), CONFIG_FILE_TIME_STAMP_FORMAT, localtime(&(attr.st_mtime)));
+    if (difftime(attr.st_mtime, config_file_attr.st_mtime) == 0) {
+        output_debug("tacacs config file not change: last modified time: %s.\n", date);
+        return;
+    }
+
+    output_debug("tacacs config file changed: last modified time: %s.\n", date);
+
+    // config file changed, update file stat and reload config.
+    config_file_attr = attr;
+
+    // load config file
+    load_tacacs_config();
+}
+
+/*
+ * Load plugin config when it changed, so a cache TTL change reaches open shells.
+ */
+void check_and_load_changed_plugin_config()
+{
+    struct stat attr;
+    // missing file has zero attribute, same as load_plugin_config
+    if (stat(plugin_config_file, &attr)) {
+        memset(&attr, 0, sizeof(attr));
+    }
+
+    if (difftime(attr.st_mtime, plugin_config_file_attr.st_mtime) == 0) {
+        return;
+    }
+
+    output_debug("plugin config file changed.\n");
+    load_plugin_config();
+}
+
+/*
+ * Tacacs plugin initialization.
+ */
+void plugin_init()
+{
+    // get config file stat, will use this to check config file changed
+    stat(tacacs_config_file, &config_file_attr);
+
+    // load config file: tacacs_config_file
+    load_tacacs_config();
+
+    // plugin_init runs in the shell process, commands inherit the shared state
+    initialize_shared_state();
+
+    output_debug("tacacs plugin initialized.\n");
+}
+
+/*
+ * Tacacs plugin release.
+ */
+void plugin_uninit()
+{
+    output_debug("tacacs plugin un-initialize.\n");
+
+    release_shared_state();
+}
+
+/*
+ * Check if current user is local user.
+ */
+int is_local_user(const char *user)
+{
+    if (user == unknown_username) {
+        // for unknown user name, when tacacs enabled, always authorization with tacacs.
+        return IS_REMOTE_USER;
+    }
+
+    struct passwd pwd;
+    struct passwd *ppwd;
+    char buf[DEFAULT_GETPWENT_SIZE_MAX];
+    int pwdresult;
+    int result = ERROR_CHECK_LOCAL_USER;
+    setpwent();
+    while (1) {
+        pwdresult = getpwent_r(&pwd, buf, sizeof(buf), &ppwd);
+        if (pwdresult) {
+            // no more pw entry
+            break;
+        }
+
+        if (strcmp(ppwd->pw_name, user) != 0) {
+            continue;
+        }
+
+        // compare passwd entry, for remote user pw_gecos will start as 'remote_user'
+        if (strncmp(ppwd->pw_gecos, REMOTE_USER_GECOS_PREFIX, strlen(REMOTE_USER_GECOS_PREFIX)) == 0) {
+            output_debug("user: %s, UID: %d, GECOS: %s is remote user.\n", user, ppwd->pw_uid, ppwd->pw_gecos);
+            result = IS_REMOTE_USER;
+        }
+        else {
+            output_debug("user: %s, UID: %d, GECOS: %s is local user.\n", user, ppwd->pw_uid, ppwd->pw_gecos);
+            result = IS_LOCAL_USER;
+        }
+        break;
+    }
+    endpwent();
+
+    if (result == ERROR_CHECK_LOCAL_USER) {
+        output_error("get user information user failed, user: %s not found\n", user);
+    }
+
+    return result;
+}
+
+/*
+ * Get user name.
+ */
+const char* get_user_name(char *user)
+{
+    if (user != NULL && strlen(user) != 0) {
+        return user;
+    }
+
+    // uid is the real user id: https://man7.org/linux/man-pages/man2/geteuid.2.html
+    output_debug("Login user name is empty, try get user name by euid.\n");
+    uid_t uid = getuid();
+    struct passwd* userwd = getpwuid(uid);
+    if (userwd != NULL && userwd->pw_name != NULL) {
+        return userwd->pw_name;
+    }
+
+    // euid is the effective user name, may not match real user id: https://man7.org/linux/man-pages/man2/geteuid.2.html
+    output_debug("Login user name is empty, try get user name by euid.\n");
+    uid_t euid = geteuid();
+    struct passwd* euserwd = getpwuid(euid);
+    if (euserwd != NULL && euserwd->pw_name != NULL) {
+        return euserwd->pw_name;
+    }
+
+    // if can't find user name by both euid or ruid, return UNKNOWN.
+    return unknown_username;
+}
+
+/*
+ * Tacacs authorization.
+ */
+int on_shell_execve (char *user, int shell_level, char *cmd, char **argv)
+{
+    const char* user_namd = get_user_name(user);
+    output_debug("Authorization parameters:\n");
+    output_debug("    Shell level: %d\n", shell_level);
+    output_debug("    Current user: %s\n", user_namd);
+    output_debug("    Command full path: %s\n", cmd);
+    output_debug("    Parameters:\n");
+    char **parameter_array_pointer = argv;
+    int argc = 0;
+    while (*parameter_array_pointer != NULL) {
+        // output parameter
+        output_debug("        %s\n", *parameter_array_pointer);
+
+        // move to next parameter
+        parameter_array_pointer++;
+        argc++;
+    }
+
+    if (shell_level > 2) {
+        // when shell_level > 1, it's a recursive command in shell script.
+        output_debug("Recursive command %s ignored.\n", cmd);
+        return 0;
+    }
+
+    // reload config file when tacacs config changed
+    check_and_load_changed_tacacs_config();
+
+    // reload plugin config file when it changed
+    check_and_load_changed_plugin_config();
+
+    int check_local_user_result = is_local_user(user_namd);
+    if (check_local_user_result != IS_REMOTE_USER) {
+        /*
+            Return 0 to check with linux permission control in following 2 scenario:
+                1: ERROR_CHECK_LOCAL_USER: check if user is local user failed because can't get user information.
+                        In this case, as failback, check with linux permission control.
+                2: IS_LOCAL_USER: user login as local user.
+                        In this case, tacacs authorization disabled for local user.
+        */
+        output_debug("ignore TACACS+ authorization for current user, check with local permission.\n");
+        return 0;
+    }
+
+    if (tacacs_ctrl & AUTHORIZATION_FLAG_TACACS) {
+        output_debug("start TACACS+ authorization for command %s with given arguments\n", cmd);
+        int ret = authorization_with_host_and_tty(user_namd, cmd, argv, argc);
+        switch (ret) {
+            case 0:
+            break;
+            case -2:
+                // -2 means no servers, so not authorized
+                fprintf(stdout, "%s not authorized by TACACS+ with given arguments, not executing\n", cmd);
+            break;
+            default:
+                // when command reject by server, authorization will failed immediately
+                fprintf(stdout, "%s authorize failed by TACACS+ with given arguments, not executing\n", cmd);
+                return ret;
+        }
+
+        if ((tacacs_ctrl & AUTHORIZATION_FLAG_LOCAL) == 0) {
+            // when local authorization disabled, tacacs authorization failed will block user from run current command
+            output_debug("local authorization disabled, TACACS+ authorization result: %d\n", ret);
+            return ret;
+        }
+    }
+
+    // return 0, so bash will continue run user command and will check user permission with linux permission check.
+    output_debug("start local authorization for command %s with given arguments\n", cmd);
+    return 0;
+}